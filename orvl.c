@@ -17,12 +17,30 @@
  *
  *    C macros for program customization by the user:
  *
+ * ARENA_BLOCK_SIZE     Size (bytes) of the storage blocks obtained by
+ *                      the arena (region) allocator, which provides
+ *                      the device records and saved table messages.
+ *                      A larger request gets a block of its own.
+ *                      Default: 16384.
+ *
+ * COALESCE_WAIT        Time (milliseconds) for which a daemon gathers
+ *                      concurrent control requests, after the first
+ *                      one arrives, before it performs them.  Identical
+ *                      requests in one batch share one device exchange.
+ *                      Default: 50.
+ *
  * EARLY_RECVFROM       Defining EARLY_RECVFROM causes the program to
  * NO_EARLY_RECVFROM    attempt a recvfrom() before sending a message.
  *                      May not be useful.
  *                      Default: defined, unless NO_EARLY_RECVFROM is
  *                      defined.
  *
+ * GAP_RETRY_MAX        Number of times to retry the gap-fill Unit
+ *                      Discovery of expected devices which did not
+ *                      respond to a broadcast query.  (Only the devices
+ *                      still missing are retried.)
+ *                      Default: 2.
+ *
  * NEED_SYS_FILIO_H     Use <sys/filio.h> to get FIONBIO defined.
  *                      (FIONBIO is used with ioctl().)
  *
@@ -35,11 +53,48 @@
  *                      Define GETADDRINFO_OK to disable the
  *                      work-around, without disabling the check.
  *
+ * NO_DAEMON            Define NO_DAEMON to omit the "daemon" operation
+ *                      and the "ctl" option (Unix-domain control
+ *                      socket).  Always omitted on VMS and Windows.
+ *
+ * NO_INOTIFY           Define NO_INOTIFY to make a daemon with a DDF
+ *                      check the DDF for changes (stat()) about once a
+ *                      second, instead of being told about them by
+ *                      inotify (Linux).
+ *
  * NO_OPER_PRIVILEGE    On VMS, do not attempt to gain OPER privilege.
  *
+ * NO_RXQ_OVFL          Define NO_RXQ_OVFL to disable the use of the
+ *                      SO_RXQ_OVFL socket option (where available) to
+ *                      count datagrams which were dropped by the kernel
+ *                      because the socket receive buffer was full.
+ *
+ * NO_SENDMMSG          Define NO_SENDMMSG to send the messages of a
+ *                      concurrent (multi-device) task one at a time,
+ *                      with sendto(), instead of in a burst, with
+ *                      sendmmsg() (Linux).
+ *
+ * NO_SENDMSG           Define NO_SENDMSG to send a gather-list message
+ *                      (such as a "tm" message formed from a saved "rt"
+ *                      response) by copying it into one buffer for
+ *                      sendto(), instead of using sendmsg().  Always
+ *                      done on VMS and Windows.
+ *
  * NO_STATE_IN_EXIT_STATUS  Define to omit any device state data from
  *                          the program exit status.
  *
+ * ORVL_CACHE           Default name of the device inventory cache file.
+ *                      Default: "ORVL_CACHE".  Treated like ORVL_DDF.
+ *                      A simple "cache" command-line option enables use
+ *                      of the cache; an explicit "cache=name" option
+ *                      overrides this default file name.
+ *
+ * ORVL_CTL             Default name of the daemon control socket.
+ *                      Default: "ORVL_CTL".  Treated like ORVL_DDF.
+ *                      A simple "ctl" command-line option enables use
+ *                      of the socket; an explicit "ctl=name" option
+ *                      overrides this default file name.
+ *
  * ORVL_DDF             Default name of the device data file (DDF).
  *                      Default: "ORVL_DDF".  This name is treated as
  *                      an environment variable (VMS: logical name)
@@ -50,6 +105,22 @@
  *                      command-line option overrides this default file
  *                      name.
  *
+ * PRI_BULK_SLICE       Number of devices a daemon queries for a bulk
+ *                      ("qlist", all) request before it serves any new
+ *                      requests (switch requests first), and continues.
+ *                      Default: 1.
+ *
+ * RCVBUF_DEV_MIN       Minimum number of device responses for which
+ *                      socket receive buffer space is reserved for a
+ *                      broadcast query.  If more devices are known
+ *                      (DDF), then the larger count is used.
+ *                      Default: 256.
+ *
+ * RCVBUF_DEV_SIZE      Socket receive buffer space (bytes) reserved per
+ *                      expected device response.  A small datagram
+ *                      costs much more than its data size in the kernel.
+ *                      Default: 1024.
+ *
  * RECVFROM_6           The data type to use for arg 6 of recvfrom().
  *                      Default: "unsigned int".  Popular alternatives
  *                      include "int" and "socklen_t".  (If the actual
@@ -57,9 +128,21 @@
  *                      compiler warnings about mismatched pointer types
  *                      are probably harmless.)
  *
+ * SHM_REC_MAX          Number of device records in a daemon's shared
+ *                      state table ("shm=file_spec").  Devices beyond
+ *                      this count are not published.
+ *                      Default: 1024.
+ *
  * SOCKET_TIMEOUT       Time to wait for a device response.
  *                      Default: 0.5s (500000 microseconds).
  *
+ * SUB_QUEUE_MAX        Number of change records a daemon holds for one
+ *                      subscriber ("subscribe" request) which reads
+ *                      slowly.  When the queue is full, new records are
+ *                      dropped (counted), and a "lost" record follows
+ *                      when there is room again.
+ *                      Default: 64.
+ *
  * TASK_RETRY_MAX       Number of times to retry a task (send message to
  *                      device, receive response from device).
  *                      Default: 4.  (4 retries means 5 tries, total.)
@@ -71,6 +154,16 @@
  * USE_FCNTL            Use fcntl() to set socket to non-blocking.
  *                      Default is to use ioctl().
  *
+ * WATCH_RENEW          Interval (seconds) between the subscription
+ *                      renewals (and heartbeats) of a "watch"
+ *                      operation.  The renewals are spread evenly
+ *                      across the interval (WHEEL_TICK).
+ *                      Default: 60.
+ *
+ * WHEEL_TICK           Time (milliseconds) per slot of the "watch"
+ *                      renewal timing wheel.
+ *                      Default: 100.
+ *
  * Notes/hints:
  *
  *    On AIX, try "-DRECVFROM_6=socklen_t", and the appropriate compiler
@@ -98,6 +191,10 @@
 /*--------------------------------------------------------------------*/
 /*    Header files, and related macros. */
 
+#if defined( __linux__) && !defined( NO_SENDMMSG) && !defined( _GNU_SOURCE)
+# define _GNU_SOURCE                    /* For sendmmsg(). */
+#endif /* defined( __linux__) && !defined( NO_SENDMMSG) && ... */
+
 #ifdef VMS
 # include <prvdef.h>
 # include <ssdef.h>
@@ -120,6 +217,8 @@
 # include <netdb.h>
 # include <netinet/in.h>
 # include <sys/socket.h>
+# include <sys/time.h>
+# include <sys/uio.h>
 # ifdef USE_FCNTL
 #  include <fcntl.h>
 # else /* def USE_FCNTL */
@@ -139,6 +238,8 @@
 
 #include <ctype.h>
 #include <errno.h>
+#include <signal.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -147,35 +248,198 @@
 /*--------------------------------------------------------------------*/
 /*    User-adjustable macros. */
 
+#ifndef ARENA_BLOCK_SIZE
+# define ARENA_BLOCK_SIZE   16384       /* Arena storage block size. */
+#endif /* ndef ARENA_BLOCK_SIZE */
+
 #ifndef NO_EARLY_RECVFROM
 # define EARLY_RECVFROM                 /* Perform early recvfrom(). */
 #endif /* ndef NO_EARLY_RECVFROM */
 
+#ifndef COALESCE_WAIT
+# define COALESCE_WAIT         50       /* Daemon: Request gather (ms). */
+#endif /* ndef COALESCE_WAIT */
+
+#define ORVL_CACHE   "ORVL_CACHE"       /* ORVL inventory cache name. */
+#define ORVL_CTL       "ORVL_CTL"       /* ORVL daemon control socket. */
 #define ORVL_DDF       "ORVL_DDF"       /* ORVL device data file name. */
 
+#ifndef PRI_BULK_SLICE
+# define PRI_BULK_SLICE         1       /* Daemon: Bulk devs per batch. */
+#endif /* ndef PRI_BULK_SLICE */
+
+#ifndef RCVBUF_DEV_MIN
+# define RCVBUF_DEV_MIN       256       /* Min. devs for rcv buf sizing. */
+#endif /* ndef RCVBUF_DEV_MIN */
+
+#ifndef RCVBUF_DEV_SIZE
+# define RCVBUF_DEV_SIZE     1024       /* Rcv buf bytes per device. */
+#endif /* ndef RCVBUF_DEV_SIZE */
+
+#ifndef SHM_REC_MAX
+# define SHM_REC_MAX         1024       /* Daemon: Shared table records. */
+#endif /* ndef SHM_REC_MAX */
+
+#ifndef SUB_QUEUE_MAX
+# define SUB_QUEUE_MAX         64       /* Daemon: Subscriber queue recs. */
+#endif /* ndef SUB_QUEUE_MAX */
+
 # ifndef RECVFROM_6
 #  define RECVFROM_6 unsigned int       /* Type for arg 6 of recvfrom(). */
 # endif /* ndef RECVFROM_6 */           /* ("int", "socklen_t", ...?) */
 
+#if defined( SO_RXQ_OVFL) && !defined( NO_RXQ_OVFL)
+# define USE_RXQ_OVFL                   /* Count kernel rcv-queue drops. */
+#endif /* defined( SO_RXQ_OVFL) && !defined( NO_RXQ_OVFL) */
+
+#if !defined( _WIN32) && !defined( VMS) && !defined( NO_SENDMSG)
+# define USE_SENDMSG                    /* Send gather lists directly. */
+#endif /* !defined( _WIN32) && !defined( VMS) && !defined( NO_SENDMSG) */
+
+#if defined( __linux__) && defined( USE_SENDMSG) && !defined( NO_SENDMMSG)
+# define USE_SENDMMSG                   /* Send task bursts (sendmmsg()). */
+#endif /* defined( __linux__) && defined( USE_SENDMSG) && ... */
+
+#if !defined( _WIN32) && !defined( VMS) && !defined( NO_DAEMON)
+# define USE_DAEMON                     /* Daemon (Unix control socket). */
+# include <fcntl.h>
+# include <fnmatch.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <sys/un.h>
+# define ORVL_SHM_WRITER                /* Shared table layout only. */
+# include "orvl_shm.h"
+# if defined( __linux__) && !defined( NO_INOTIFY)
+#  define USE_INOTIFY                   /* Daemon: DDF change events. */
+#  include <sys/inotify.h>
+# endif /* defined( __linux__) && !defined( NO_INOTIFY) */
+#endif /* !defined( _WIN32) && !defined( VMS) && !defined( NO_DAEMON) */
+
 #define SOCKET_TIMEOUT     500000       /* Microseconds. */
 
 #define TASK_RETRY_MAX          4       /* Task retry count, */
 #define TASK_RETRY_WAIT       500       /* delay.  Milliseconds (< 1000ms). */
 
+#ifndef GAP_RETRY_MAX
+# define GAP_RETRY_MAX          2       /* Gap-fill (Unit disc) retry count. */
+#endif /* ndef GAP_RETRY_MAX */
+
+#ifndef WATCH_RENEW
+# define WATCH_RENEW           60       /* Watch: Subscription renewal (s). */
+#endif /* ndef WATCH_RENEW */
+
+#ifndef WHEEL_TICK
+# define WHEEL_TICK           100       /* Watch: Wheel slot time (ms). */
+#endif /* ndef WHEEL_TICK */
+
+#define WHEEL_SLOTS (WATCH_RENEW* 1000/ WHEEL_TICK)     /* One rotation. */
+
 /*--------------------------------------------------------------------*/
 /*    Fixed macros. */
 
 #define DEV_NAME_LEN           16
 #define PASSWORD_LEN           12
+#define COUNTDOWN_LEN           4       /* Countdown status, seconds. */
+#define COUNTDOWN_MAX       65535       /* Countdown seconds (16 bits). */
 #define MAC_ADDR_SIZE           6
 #define PORT_ORV            10000       /* IP port used for device comm. */
 #define TIME_OFS       0x83aa7e80       /* 70y (1970 - 1900). */
 
+/* Fixed message lengths (see the cmd_xxx[] message arrays). */
+
+#define MSG_LEN_HEARTBEAT      22       /* "hb". */
+#define MSG_LEN_READ_TABLE     29       /* "rt". */
+#define MSG_LEN_SUBS           30       /* "cl". */
+#define MSG_LEN_SWITCH         23       /* "dc". */
+#define MSG_LEN_UNIT_DISC      18       /* "qg". */
+#define MSG_LEN_WRITE_TIMING   55       /* "tm" (table 3, one record). */
+
+#define TIMER_MAX              32       /* Timer records (one device). */
+#define TIMER_REC_LEN          28       /* Timer record length. */
+
+#define ARENA_ALIGN            16       /* Arena allocation alignment. */
+#define BURST_MAX              64       /* Messages per sendmmsg(). */
+#define CTL_LINE_MAX          128       /* Daemon: Request line length. */
+#define CTL_READ_WAIT        1000       /* Daemon: Request read wait (ms). */
+#define CTL_REQ_MAX            64       /* Daemon: Requests per batch. */
+#define HTTP_CONN_MAX          16       /* Daemon: HTTP API connections. */
+#define HTTP_IN_MAX          4096       /* Daemon: HTTP request size. */
+#define LISTEN_FDS_START        3       /* Daemon: First inherited fd. */
+#define SUB_LINE_MAX          112       /* Daemon: Change record length. */
+#define SUB_MAC_MAX             8       /* Daemon: Subscriber MAC filter. */
+#define SUB_MAX                16       /* Daemon: Subscribers. */
+
+/* Daemon control request priority classes (highest first). */
+
+#define PRI_INTERACTIVE         0       /* Switch ("off", "on"). */
+#define PRI_CONTROL             1       /* One device ("[q]list dev"). */
+#define PRI_REFRESH             2       /* Inventory ("list"). */
+#define PRI_BULK                3       /* Table reads, all ("qlist"). */
+#define PRI_CNT                 4
+
+/* Daemon "set" (HTTP PATCH) fields. */
+
+#define CTL_SET_NAME            1       /* Device name. */
+#define CTL_SET_PASSWD          2       /* Remote password. */
+#define GATHER_SEG_MAX         12       /* Gather list segments. */
+#define RBUF_SIZE            1024       /* Receive buffer size. */
+
+#define OMAX( a, b) (((a) >= (b)) ? (a) : (b))
 #define OMIN( a, b) (((a) <= (b)) ? (a) : (b))
 
 /*--------------------------------------------------------------------*/
 /*    Data structures. */
 
+typedef struct orv_msg_tpl_t            /* Pre-rendered output messages. */
+{
+  unsigned char heartbeat[ MSG_LEN_HEARTBEAT];  /* "hb". */
+  unsigned char read_index[ MSG_LEN_READ_TABLE];        /* "rt" (table 1). */
+  unsigned char read_table[ MSG_LEN_READ_TABLE];        /* "rt" (table 4). */
+  unsigned char read_timing[ MSG_LEN_READ_TABLE];       /* "rt" (table 3). */
+  unsigned char subs[ MSG_LEN_SUBS];            /* "cl". */
+  unsigned char switch_off[ MSG_LEN_SWITCH];    /* "dc" (off). */
+  unsigned char switch_on[ MSG_LEN_SWITCH];     /* "dc" (on). */
+  unsigned char unit_disc[ MSG_LEN_UNIT_DISC];  /* "qg". */
+  char ok;                                      /* Templates rendered. */
+} orv_msg_tpl_t;
+
+typedef struct orv_rsp_t                        /* Decoded response. */
+{
+  int rsp;                                      /* Response type (RSP_xxx). */
+  int save;                                     /* Good data (RSP_xxx). */
+  unsigned int have;                            /* Fields found (FLD_xxx). */
+  unsigned char mac_addr[ MAC_ADDR_SIZE];       /* MAC address. */
+  unsigned char uid[ MAC_ADDR_SIZE];            /* UID (MAC, fwd). */
+  unsigned char mac_rev[ MAC_ADDR_SIZE];        /* MAC address (rev). */
+  unsigned int state_old;                       /* Device state (report). */
+  unsigned int state_new;                       /* Device state (changed). */
+  unsigned int time_dev;                        /* Device time (1900). */
+  unsigned int table_nr;                        /* Table number. */
+  unsigned int unk_nr;                          /* Unknown number. */
+  unsigned int record_len;                      /* Record length. */
+  unsigned int record_nr;                       /* Record number. */
+  unsigned int version_id;                      /* Version ID. */
+  char passwd[ PASSWORD_LEN+ 1];                /* Remote password. */
+  char name[ DEV_NAME_LEN+ 1];                  /* Device name. */
+  unsigned int type;                            /* Device type (icon code). */
+  unsigned int hw_version;                      /* Hardware version. */
+  unsigned int fw_version;                      /* Firmware version. */
+  unsigned int cc_version;                      /* CC3300 firmware version. */
+  unsigned int server_port;                     /* Server port. */
+  unsigned int server_ip;                       /* Server IP address. */
+  unsigned int remote_port;                     /* Remote port. */
+  char remote_name[ 40+ 1];                     /* Remote (server) name. */
+  unsigned int local_ip;                        /* Local IP address. */
+  unsigned int local_gw;                        /* Local gateway address. */
+  unsigned int local_nm;                        /* Local netmask. */
+  unsigned int dhcp;                            /* DHCP. */
+  unsigned int discoverable;                    /* Discoverable. */
+  unsigned int tz_set;                          /* Time zone set. */
+  unsigned int tz;                              /* Time zone. */
+  unsigned int countdown_sts;                   /* Countdown status. */
+  unsigned int countdown;                       /* Countdown (s). */
+} orv_rsp_t;
+
 typedef struct orv_data_t                       /* Orvibo device data. */
 {
   struct orv_data_t *next;                      /* Link to next. */
@@ -189,8 +453,249 @@ typedef struct orv_data_t                       /* Orvibo device data. */
   unsigned char passwd[ PASSWORD_LEN];          /* Remote password. */
   unsigned char mac_addr[ MAC_ADDR_SIZE];       /* MAC address. */
   char state;                                   /* Device state. */
+  char seen;                                    /* Responded (this round). */
+  char pend;                                    /* Response pending. */
+  char fresh;                                   /* State cached (fresh). */
+  int state_src;                                /* State source (RSP_xxx). */
+  double state_t;                               /* State seen (time, s). */
+  unsigned long t_sent;                         /* Unicast sent (ms), or 0. */
+  unsigned int rtt_ms;                          /* Last round-trip time (ms). */
+  double sub_t;                                 /* Subscribed (time, s). */
+  int ivers;                                    /* T4 index flag (+1), or 0. */
+  unsigned int shm_slot;                        /* Shared table slot (+1). */
+  char noted;                                   /* Change snapshot taken. */
+  char note_state;                              /* Snapshot: State, */
+  struct in_addr note_ip;                       /*  IP address, */
+  char note_name[ DEV_NAME_LEN+ 1];             /*  name (dev_name()). */
+  orv_msg_tpl_t tpl;                            /* Output msg templates. */
+  orv_rsp_t rt4;                                /* Table 4 data (decoded). */
+  struct orv_rbuf_t *rt3;                       /* Table 3 "rt" (held). */
+  struct orv_sched_t *sched;                    /* Schedule (timers). */
+  struct orv_want_t *want;                      /* Desired state. */
+  struct orv_data_t *wheel_next;                /* Timing wheel slot link. */
 } orv_data_t;
 
+typedef struct orv_arena_blk_t          /* Arena storage block (header). */
+{
+  struct orv_arena_blk_t *next;                 /* Link to next (older). */
+  size_t size;                                  /* Data size. */
+  size_t used;                                  /* Data used. */
+} orv_arena_blk_t;
+
+typedef struct orv_arena_t                      /* Arena (region). */
+{
+  orv_arena_blk_t *blk;                         /* Current block. */
+  size_t total;                                 /* Total block storage. */
+} orv_arena_t;
+
+typedef struct orv_rbuf_t                       /* Receive buffer (pooled). */
+{
+  struct orv_rbuf_t *next;                      /* Link to next (free). */
+  int refs;                                     /* Reference count. */
+  ssize_t len;                                  /* Message length. */
+  unsigned char data[ RBUF_SIZE];               /* Message data. */
+} orv_rbuf_t;
+
+typedef struct orv_seg_t                        /* Gather list segment. */
+{
+  const unsigned char *base;                    /* Data. */
+  size_t len;                                   /* Data length. */
+} orv_seg_t;
+
+typedef struct orv_gather_t                     /* Gather list (message). */
+{
+  int cnt;                                      /* Segment count. */
+  size_t len;                                   /* Total message length. */
+  unsigned char hdr[ 6];                        /* Prefix, length, op. */
+  orv_seg_t seg[ GATHER_SEG_MAX];               /* Segments. */
+} orv_gather_t;
+
+typedef struct orv_patch_t                      /* Gather list patch. */
+{
+  int ofs;                                      /* Offset (original msg). */
+  int len;                                      /* Data length. */
+  const unsigned char *data;                    /* Replacement data. */
+  const char *label;                            /* Field name (messages). */
+} orv_patch_t;
+
+typedef struct orv_tbl_t                        /* Table data. */
+{
+  orv_rbuf_t *rbuf;                             /* "rt" response (held). */
+  orv_gather_t wt;                              /* "tm" message. */
+} orv_tbl_t;
+
+typedef struct orv_timer_t                      /* Timer (table 3) record. */
+{
+  unsigned int rec_nr;                          /* Record number. */
+  unsigned char unk[ 16];                       /* Unknown (0x20 fill). */
+  int state;                                    /* Power state (0, 1). */
+  int year;                                     /* Date. */
+  int month;
+  int day;
+  int hour;                                     /* Time of day. */
+  int minute;
+  int second;
+  int repeat;                                   /* Repeat flag, days. */
+} orv_timer_t;
+
+typedef struct orv_sched_t                      /* Schedule (one device). */
+{
+  int sts;                                      /* Status (0: ok). */
+  int want_cnt;                                 /* Wanted timer count. */
+  int keep;                                     /* Timers kept. */
+  int add;                                      /* Timers added. */
+  int modify;                                   /* Timers modified. */
+  int del;                                      /* Timers deleted. */
+  orv_timer_t want[ TIMER_MAX];                 /* Wanted timers. */
+} orv_sched_t;
+
+typedef struct orv_want_t                       /* Desired state (one dev). */
+{
+  int sts;                                      /* Status (0: ok). */
+  int state;                                    /* Wanted state (-1: any). */
+  int state_old;                                /* State found. */
+  int sw;                                       /* Switch needed. */
+  int set;                                      /* Table 4 fields needed. */
+  int name_set;                                 /* Name wanted. */
+  int passwd_set;                               /* Password wanted. */
+  char name_str[ DEV_NAME_LEN+ 1];              /* Wanted name. */
+  char passwd_str[ PASSWORD_LEN+ 1];            /* Wanted password. */
+  unsigned char name[ DEV_NAME_LEN];            /* Wanted name (filled). */
+  unsigned char passwd[ PASSWORD_LEN];          /* Wanted pw. (filled). */
+} orv_want_t;
+
+typedef struct orv_col_t                        /* Report column. */
+{
+  char *key;                                    /* Keyword. */
+  int fld;                                      /* Field (FLD_xxx/COL_xxx). */
+  int width;                                    /* Display width. */
+  char *head;                                   /* Heading. */
+} orv_col_t;
+
+typedef struct orv_metrics_t                    /* Run-time counters. */
+{
+  unsigned int msg_snd;                         /* Messages sent. */
+  unsigned int msg_rec;                         /* Messages received. */
+  unsigned int rcv_drops;                       /* Kernel rcv-queue drops. */
+  unsigned int requery;                         /* Targeted re-queries. */
+  unsigned int rebcast;                         /* Repeated broadcasts. */
+  unsigned int rt_read;                         /* Table 4 reads. */
+  unsigned int rt_skip;                         /* Table 4 reads skipped. */
+  unsigned int tm_write;                        /* Timer record writes. */
+  unsigned int sw_cnt;                          /* Switch confirmations. */
+  unsigned long sw_first;                       /* First, last switch */
+  unsigned long sw_last;                        /*  confirmation (ms). */
+  unsigned int cache_hit;                       /* Fresh cached states. */
+  unsigned int ctl_req;                         /* Daemon requests, */
+  unsigned int ctl_done;                        /*  performed. */
+  unsigned int pri_cnt[ PRI_CNT];               /* Daemon requests served, */
+  unsigned long pri_wait[ PRI_CNT];             /*  queue delay (ms), */
+  unsigned long pri_wait_max[ PRI_CNT];         /*  max delay, by class. */
+  unsigned int sub_cnt;                         /* Daemon subscriptions, */
+  unsigned int sub_rec;                         /*  change records sent, */
+  unsigned int sub_lost;                        /*  lost (queue full). */
+  unsigned int http_conn;                       /* HTTP API connections, */
+  unsigned int http_req;                        /*  requests. */
+  unsigned int ddf_reload;                      /* DDF reloads (daemon), */
+  unsigned int ddf_add;                         /*  devices added, */
+  unsigned int ddf_del;                         /*  removed, */
+  unsigned int ddf_chg;                         /*  changed. */
+  int rcvbuf_size;                              /* Rcv buf size (broadcast). */
+} orv_metrics_t;
+
+typedef struct orv_wheel_t                      /* Timing wheel (renewal). */
+{
+  int cur;                                      /* Current slot. */
+  unsigned long t_cur;                          /* Current slot time (ms). */
+  struct orv_data_t *slot[ WHEEL_SLOTS];        /* Slot member chains. */
+  unsigned int drops;                           /* Socket drops (cum.). */
+} orv_wheel_t;
+
+typedef struct orv_pace_t                       /* Switch pacing (bucket). */
+{
+  int cnt;                                      /* Switches per interval. */
+  int ms;                                       /* Interval (ms). */
+  int tokens;                                   /* Switches available. */
+  unsigned long t_fill;                         /* Last refill time (ms). */
+} orv_pace_t;
+
+typedef struct orv_ctl_req_t            /* Daemon: Control request. */
+{
+  int fd;                                       /* Client connection. */
+  int opr;                                      /* Operation (OPR_xxx). */
+  int flags;                                    /* Report flags (FDL_xxx). */
+  int sts;                                      /* Result (CTL_xxx). */
+  const char *msg;                              /* Result message. */
+  int cls;                                      /* Priority class (PRI_xxx). */
+  int pos;                                      /* Bulk: Devices done. */
+  int queued;                                   /* Not yet started. */
+  int yielded;                                  /* Gave way (this slice). */
+  unsigned long t_arr;                          /* Arrival time (ms). */
+  struct orv_data_t *dev;                       /* Target (NULL: all). */
+  struct orv_ctl_req_t *lead;                   /* Coalesced: Performer. */
+  struct orv_http_t *http;                      /* HTTP API connection. */
+  int self;                                     /* Daemon's own (no client). */
+  int set_flg;                                  /* "set": Fields (CTL_SET_). */
+  char set_name[ DEV_NAME_LEN+ 1];              /* "set": Device name, */
+  char set_passwd[ PASSWORD_LEN+ 1];            /*  remote password. */
+} orv_ctl_req_t;
+
+typedef struct orv_buf_t                /* Growable (output) buffer. */
+{
+  char *data;                                   /* Data (malloc()). */
+  size_t len;                                   /* Data length. */
+  size_t size;                                  /* Allocated size. */
+} orv_buf_t;
+
+typedef struct orv_http_t               /* Daemon: HTTP API connection. */
+{
+  int fd;                                       /* Connection (-1: free). */
+  int busy;                                     /* Device request pending. */
+  int hangup;                                   /* No more requests. */
+  size_t in_len;                                /* Request data held. */
+  size_t out_ofs;                               /* Reply data sent. */
+  orv_buf_t out;                                /* Reply data. */
+  char in[ HTTP_IN_MAX];                        /* Request data. */
+} orv_http_t;
+
+typedef struct orv_sub_t                /* Daemon: Change subscriber. */
+{
+  int fd;                                       /* Client connection (-1). */
+  int mac_cnt;                                  /* Filter: MAC addresses, */
+  unsigned char mac[ SUB_MAC_MAX][ MAC_ADDR_SIZE];
+  char name[ DEV_NAME_LEN+ 1];                  /*  name pattern (glob), */
+  struct in_addr net;                           /*  subnet, */
+  struct in_addr mask;                          /*  subnet mask, */
+  int type;                                     /*  device type (-1: any). */
+  int q_head;                                   /* Queue: First record, */
+  int q_cnt;                                    /*  record count, */
+  int q_ofs;                                    /*  first rec bytes sent. */
+  unsigned int lost;                            /* Records lost (not told). */
+  char q[ SUB_QUEUE_MAX][ SUB_LINE_MAX];        /* Queue records. */
+} orv_sub_t;
+
+typedef struct orv_fld_t                /* Response field layout entry. */
+{
+  int fld;                                      /* Field ID (FLD_xxx). */
+  int ofs;                                      /* Offset in message. */
+  int len;                                      /* Size (bytes). */
+  int enc;                                      /* Encoding (FLE_xxx). */
+  size_t dst;                                   /* Offset in orv_rsp_t. */
+  int fmt;                                      /* Display format (FMT_xxx). */
+  char *label;                                  /* Display label. */
+} orv_fld_t;
+
+typedef struct orv_layout_t             /* Response message layout. */
+{
+  char op[ 2];                                  /* Operation code. */
+  int tbl;                                      /* "rt" table (-1: any). */
+  int rsp;                                      /* Response type (RSP_xxx). */
+  int rsp_fld;                                  /* Field req'd for rsp. */
+  int save_fld;                                 /* Field implying good data. */
+  const orv_fld_t *fld;                         /* Field layout entries. */
+  int fld_cnt;                                  /* Field count. */
+} orv_layout_t;
+
 /*--------------------------------------------------------------------*/
 /*    Symbolic constants. */
 
@@ -207,6 +712,7 @@ typedef struct orv_data_t                       /* Orvibo device data. */
 #define DBG_SIO        0x00000100       /* Socket I/O. */
 #define DBG_VMS        0x00000200       /* VMS-specific. */
 #define DBG_WIN        0x00000400       /* Windows-specific. */
+#define DBG_MET        0x00000800       /* Metrics (counters) at exit. */
 
 /* fprintf_device_list() flags. */
 
@@ -214,6 +720,14 @@ typedef struct orv_data_t                       /* Orvibo device data. */
 #define FDL_DDF        0x00000002       /* Device data file. */
 #define FDL_QUIET      0x00000004       /* Quiet. */
 #define FDL_SINGLE     0x00000008       /* Single device. */
+#define FDL_CACHE      0x00000010       /* Inventory cache (table data). */
+
+/* Daemon control request results (see ctl_sts_name[]). */
+
+#define CTL_OK                  0       /* Performed. */
+#define CTL_SUPERSEDED          1       /* Superseded by a later write. */
+#define CTL_FAILED              2       /* Failed. */
+#define CTL_BAD                 3       /* Bad request. */
 
 /* Response types (bit mask). */
 
@@ -225,8 +739,74 @@ typedef struct orv_data_t                       /* Orvibo device data. */
 #define RSP_RT         0x00000020       /* Read table. */
 #define RSP_SF         0x00000040       /* Device control. */
 #define RSP_TM         0x00000080       /* Write Table. */
+#define RSP_OVF        0x40000000       /* Receive queue overflow (drops). */
 #define RSP___         0x80000000       /* Unknown/unrecognized response. */
 
+/* Response fields (orv_rsp_t.have bit numbers). */
+
+#define FLD_NONE               -1       /* (No field.) */
+#define FLD_MAC                 0       /* MAC address. */
+#define FLD_STATE_OLD           1       /* Device state (report). */
+#define FLD_STATE_NEW           2       /* Device state (changed). */
+#define FLD_TIME_DEV            3       /* Device time. */
+#define FLD_TABLE_NR            4       /* Table number. */
+#define FLD_UNK_NR              5       /* Unknown number. */
+#define FLD_RECORD_LEN          6       /* Record length. */
+#define FLD_RECORD_NR           7       /* Record number. */
+#define FLD_VERSION_ID          8       /* Version ID. */
+#define FLD_UID                 9       /* UID (MAC, fwd). */
+#define FLD_MAC_REV            10       /* MAC address (rev). */
+#define FLD_PASSWD             11       /* Remote password. */
+#define FLD_NAME               12       /* Device name. */
+#define FLD_TYPE               13       /* Device type (icon code). */
+#define FLD_HW_VERSION         14       /* Hardware version. */
+#define FLD_FW_VERSION         15       /* Firmware version. */
+#define FLD_CC_VERSION         16       /* CC3300 firmware version. */
+#define FLD_SERVER_PORT        17       /* Server port. */
+#define FLD_SERVER_IP          18       /* Server IP address. */
+#define FLD_REMOTE_PORT        19       /* Remote port. */
+#define FLD_REMOTE_NAME        20       /* Remote (server) name. */
+#define FLD_LOCAL_IP           21       /* Local IP address. */
+#define FLD_LOCAL_GW           22       /* Local gateway address. */
+#define FLD_LOCAL_NM           23       /* Local netmask. */
+#define FLD_DHCP               24       /* DHCP. */
+#define FLD_DISCOVERABLE       25       /* Discoverable. */
+#define FLD_TZ_SET             26       /* Time zone set. */
+#define FLD_TZ                 27       /* Time zone. */
+#define FLD_COUNTDOWN_STS      28       /* Countdown status. */
+#define FLD_COUNTDOWN          29       /* Countdown (s). */
+
+/* Report columns which are not response fields. */
+
+#define COL_IP                 -2       /* IP address. */
+#define COL_MAC                -3       /* MAC address. */
+#define COL_NAME               -4       /* Device name. */
+#define COL_STATE              -5       /* Device state. */
+#define COL_TYPE               -6       /* Device type (name). */
+
+#define COL_SEL_MAX            32       /* Max selected columns. */
+
+#define RSP_HAVE( r, f) ((((r)->have)& (1U<< (f))) != 0)
+
+/* Response field encodings. */
+
+#define FLE_LE                  0       /* Unsigned int, little-endian. */
+#define FLE_BE                  1       /* Unsigned int, big-endian. */
+#define FLE_BYTES               2       /* Byte array. */
+#define FLE_STR                 3       /* Character string (add NUL). */
+
+/* Response field display formats (DBG_MSI). */
+
+#define FMT_NONE                0       /* (Not displayed individually.) */
+#define FMT_DEC                 1       /* Decimal (hex). */
+#define FMT_HEX                 2       /* Hex (8 digits). */
+#define FMT_IP                  3       /* IPv4 address. */
+#define FMT_MAC                 4       /* MAC address. */
+#define FMT_S8                  5       /* Signed byte. */
+#define FMT_STR                 6       /* String. */
+#define FMT_TIME                7       /* Device time. */
+#define FMT_TYPE                8       /* Device type. */
+
 /* Task codes. */
 
 #define TSK_MIN                 0       /* Smallest TSK_xxx value. */
@@ -241,7 +821,24 @@ typedef struct orv_data_t                       /* Orvibo device data. */
 #define TSK_RT_TIMING           8       /* Read table: timing. */
 #define TSK_WT_SOCKET           9       /* Write table: socket. */
 #define TSK_WT_TIMING          10       /* Write table: timing. */
-#define TSK_MAX                10       /* Largest TSK_xxx value. */
+#define TSK_RT_INDEX           11       /* Read table: index. */
+#define TSK_MAX                11       /* Largest TSK_xxx value. */
+
+/* Timer record repeat byte. */
+
+#define TMR_REPEAT     0x00000080       /* Repeat (on the day(s)). */
+#define TMR_DAYS       0x0000007f       /* Days (see day_bit[]). */
+
+/* Write table: timing ("tm") record modes. */
+
+#define TMA_ADD                 0       /* Add record. */
+#define TMA_MODIFY              1       /* Modify record. */
+#define TMA_DELETE              2       /* Delete record. */
+
+/* query_devices() flags. */
+
+#define QRY_CACHED     0x00000001       /* Skip devs with cached table 4. */
+#define QRY_INDEX      0x00000002       /* Read table 4 only if changed. */
 
 /*--------------------------------------------------------------------*/
 /*    Global Storage.
@@ -250,6 +847,22 @@ typedef struct orv_data_t                       /* Orvibo device data. */
 
 static int debug;                               /* Debug flag(s). */
 
+static orv_metrics_t metrics;                   /* Run-time counters. */
+
+static orv_pace_t pace;                         /* Switch pacing. */
+
+static long max_age = -1;                       /* Cache: State max age. */
+
+static FILE *watch_fp;                          /* Watch: State changes. */
+
+static volatile sig_atomic_t watch_stop;        /* Watch: Stop (signal). */
+
+static orv_arena_t arena;                       /* Run (epoch) storage. */
+
+static orv_rbuf_t *rbuf_free;                   /* Receive buffer pool. */
+
+static orv_data_t *orv_data_free;               /* Recycled LL members. */
+
 /* Basic output message content:
  *    [0],[1]: Prefix ("magic key") = "hd".
  *    [2],[3]: Message length.
@@ -258,7 +871,7 @@ static int debug;                               /* Debug flag(s). */
 
 /* Subscribe ("cl" = Claim?). */
 
-static unsigned char cmd_subs[] =
+static unsigned char cmd_subs[ MSG_LEN_SUBS] =
  { 'h', 'd', 0x00, 0x00, 'c', 'l',              /* Prefix, length, op. */
    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,          /* MAC address (fwd). */
    0x20, 0x20, 0x20, 0x20, 0x20, 0x20,          /* 0x20 fill. */
@@ -268,7 +881,7 @@ static unsigned char cmd_subs[] =
 
 /* Switch off/on ("dc" = Device Control?). */
 
-static unsigned char cmd_switch[] =
+static unsigned char cmd_switch[ MSG_LEN_SWITCH] =
  { 'h', 'd', 0x00, 0x00, 'd', 'c',              /* Prefix, length, op. */
    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,          /* MAC address. */
    0x20, 0x20, 0x20, 0x20, 0x20, 0x20,          /* 0x20 fill. */
@@ -277,7 +890,7 @@ static unsigned char cmd_switch[] =
 
 /* Heartbeat ("hb" = HeartBeat?). */
 
-static unsigned char cmd_heartbeat[] =
+static unsigned char cmd_heartbeat[ MSG_LEN_HEARTBEAT] =
  { 'h', 'd', 0x00, 0x00, 'h', 'b',
    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,          /* MAC address. */
    0x20, 0x20, 0x20, 0x20, 0x20, 0x20,          /* 0x20 fill. */
@@ -291,7 +904,7 @@ static unsigned char cmd_glob_disc[] =
 
 /* Unit discovery ("qg" = Query G?). */
 
-static unsigned char cmd_unit_disc[] =
+static unsigned char cmd_unit_disc[ MSG_LEN_UNIT_DISC] =
  { 'h', 'd', 0x00, 0x00, 'q', 'g',              /* Prefix, length, op. */
    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,          /* MAC address. */
    0x20, 0x20, 0x20, 0x20, 0x20, 0x20           /* 0x20 fill. */
@@ -299,7 +912,7 @@ static unsigned char cmd_unit_disc[] =
 
 /* Read table ("rt" = Read Table?). */
 
-static unsigned char cmd_read_table[] =
+static unsigned char cmd_read_table[ MSG_LEN_READ_TABLE] =
  { 'h', 'd', 0x00, 0x00, 'r', 't',              /* Prefix, length, op. */
    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,          /* MAC address. */
    0x20, 0x20, 0x20, 0x20, 0x20, 0x20,          /* 0x20 fill. */
@@ -311,6 +924,23 @@ static unsigned char cmd_read_table[] =
 #define READ_TABLE_TABLE 22
 #define READ_TABLE_VERSION 24
 
+/* Table 1 ("rt" response): The index of the other tables.  Each record
+ * is: record length (2), then record number (2), table number (2), and
+ * table version flag (2).  (All little-endian.)
+ */
+
+#define READ_TABLE_RECORDS 28
+
+/* Table 3 ("rt" response): Timers.  Each record is: record length (2),
+ * then record number (2), unknown (16, 0x20 fill), power state (2),
+ * year (2), month, day, hour, minute, second, and repeat (1 each).
+ */
+
+#define TIMER_REC_STATE 18
+#define TIMER_REC_YEAR 20
+#define TIMER_REC_MONTH 22
+#define TIMER_REC_REPEAT 27
+
 /* Write table ("tm" = Table Modify?). */
 
 static unsigned char cmd_write_table[] =
@@ -322,6 +952,162 @@ static unsigned char cmd_write_table[] =
 /* 0x00, 0x00                          */       /* rec-len(2). */
  };
 
+/* Write table: timing ("tm", table 3, one timer record). */
+
+static unsigned char cmd_write_timing[ MSG_LEN_WRITE_TIMING- TIMER_REC_LEN] =
+ { 'h', 'd', 0x00, 0x00, 't', 'm',              /* Prefix, length, op. */
+   0x00, 0x00, 0x00, 0x00, 0x00, 0x00,          /* MAC address. */
+   0x20, 0x20, 0x20, 0x20, 0x20, 0x20,          /* 0x20 fill. */
+   0x00, 0x00, 0x00, 0x00,                      /* Unk(4). */
+   0x03, 0x00, 0x00,                            /* Table 03, mode. */
+   TIMER_REC_LEN, 0x00                          /* rec-len(2). */
+ };
+
+#define WRITE_TIMING_MODE 24
+
+/* Response message layouts.  Each orv_fld_t entry describes one field
+ * (offset, size, encoding, destination in orv_rsp_t), which is decoded
+ * only if the message is long enough to hold it.  A layout's rsp_fld
+ * (if any) must be found to claim the response type.  Its save_fld (if
+ * any) must be found to claim good (saveable) device data.
+ */
+
+#define FLD_ENT( f, o, l, e, m, d, t) \
+ { (f), (o), (l), (e), offsetof( orv_rsp_t, m), (d), (t) }
+
+#define LAYOUT_FLDS( a) (a), (sizeof( a)/ sizeof( (a)[ 0]))
+
+static const orv_fld_t fld_cl[] =               /* Subscribe. */
+{ FLD_ENT( FLD_MAC,         6, 6, FLE_BYTES, mac_addr,  FMT_NONE, NULL),
+  FLD_ENT( FLD_STATE_OLD,  23, 1, FLE_LE,    state_old, FMT_NONE, NULL)
+};
+
+static const orv_fld_t fld_qa[] =               /* Global/unit discovery. */
+{ FLD_ENT( FLD_MAC,         7, 6, FLE_BYTES, mac_addr,  FMT_NONE, NULL),
+  FLD_ENT( FLD_TIME_DEV,   37, 4, FLE_LE,    time_dev,  FMT_TIME, "time_dev"),
+  FLD_ENT( FLD_STATE_OLD,  41, 1, FLE_LE,    state_old, FMT_NONE, NULL)
+};
+
+static const orv_fld_t fld_rt[] =               /* Read table (header). */
+{ FLD_ENT( FLD_MAC,         6, 6, FLE_BYTES, mac_addr,  FMT_NONE, NULL),
+  FLD_ENT( FLD_TABLE_NR,   23, 2, FLE_LE, table_nr,   FMT_DEC, "Table Nr"),
+  FLD_ENT( FLD_UNK_NR,     25, 2, FLE_LE, unk_nr,     FMT_DEC, "Unk Nr"),
+  FLD_ENT( FLD_RECORD_LEN, 28, 2, FLE_LE, record_len, FMT_DEC, "Record Len"),
+  FLD_ENT( FLD_RECORD_NR,  30, 2, FLE_LE, record_nr,  FMT_DEC, "Record Nr"),
+  FLD_ENT( FLD_VERSION_ID, 32, 2, FLE_LE, version_id, FMT_DEC, "Version ID")
+};
+
+static const orv_fld_t fld_rt4[] =              /* Read table 4 (socket). */
+{ FLD_ENT( FLD_UID,            34,  6, FLE_BYTES, uid,     FMT_MAC,
+   "MAC address (fwd)"),
+  FLD_ENT( FLD_MAC_REV,        46,  6, FLE_BYTES, mac_rev, FMT_MAC,
+   "MAC address (rev)"),
+  FLD_ENT( FLD_PASSWD,         58, 12, FLE_STR,   passwd,  FMT_STR,
+   "Remote password"),
+  FLD_ENT( FLD_NAME,           70, 16, FLE_STR,   name,    FMT_STR,
+   "Device name"),
+  FLD_ENT( FLD_TYPE,           86,  2, FLE_LE,    type,    FMT_TYPE,
+   "Device type"),
+  FLD_ENT( FLD_HW_VERSION,     88,  4, FLE_LE, hw_version, FMT_HEX,
+   "Hardware version"),
+  FLD_ENT( FLD_FW_VERSION,     92,  4, FLE_LE, fw_version, FMT_HEX,
+   "Firmware version"),
+  FLD_ENT( FLD_CC_VERSION,     96,  4, FLE_LE, cc_version, FMT_HEX,
+   "CC3300 Firmware version"),
+  FLD_ENT( FLD_SERVER_PORT,   100,  2, FLE_LE, server_port, FMT_DEC,
+   "Server port: code"),
+  FLD_ENT( FLD_SERVER_IP,     102,  4, FLE_BE, server_ip, FMT_IP,
+   "Server IP address"),
+  FLD_ENT( FLD_REMOTE_PORT,   106,  2, FLE_LE, remote_port, FMT_DEC,
+   "Remote port"),
+  FLD_ENT( FLD_REMOTE_NAME,   108, 40, FLE_STR, remote_name, FMT_STR,
+   "Remote name"),
+  FLD_ENT( FLD_LOCAL_IP,      148,  4, FLE_BE, local_ip, FMT_IP,
+   "Local IP address"),
+  FLD_ENT( FLD_LOCAL_GW,      152,  4, FLE_BE, local_gw, FMT_IP,
+   "Local GW address"),
+  FLD_ENT( FLD_LOCAL_NM,      156,  4, FLE_BE, local_nm, FMT_IP,
+   "Local Netmask"),
+  FLD_ENT( FLD_DHCP,          160,  1, FLE_LE, dhcp, FMT_DEC,
+   "DHCP"),
+  FLD_ENT( FLD_DISCOVERABLE,  161,  1, FLE_LE, discoverable, FMT_DEC,
+   "Discoverable"),
+  FLD_ENT( FLD_TZ_SET,        162,  1, FLE_LE, tz_set, FMT_DEC,
+   "Time zone set"),
+  FLD_ENT( FLD_TZ,            163,  1, FLE_LE, tz, FMT_S8,
+   "Time zone"),
+  FLD_ENT( FLD_COUNTDOWN_STS, 164,  2, FLE_LE, countdown_sts, FMT_DEC,
+   "Countdown status"),
+  FLD_ENT( FLD_COUNTDOWN,     166,  2, FLE_LE, countdown, FMT_DEC,
+   "Countdown")
+};
+
+static const orv_fld_t fld_sf[] =               /* Device control. */
+{ FLD_ENT( FLD_MAC,         6, 6, FLE_BYTES, mac_addr,  FMT_NONE, NULL),
+  FLD_ENT( FLD_STATE_NEW,  22, 1, FLE_LE,    state_new, FMT_NONE, NULL)
+};
+
+static const orv_fld_t fld_tm[] =               /* Write table. */
+{ FLD_ENT( FLD_MAC,         6, 6, FLE_BYTES, mac_addr,  FMT_NONE, NULL)
+};
+
+/* Note: A "qa" request (from us, if broadcast) may be seen, too, so
+ * "qa" claims a response only if it includes a MAC address.  "rt"
+ * table layouts 1 and 3 (index, timing) use only the "rt" header
+ * fields.  "dc" and "hb" offer no useful data.
+ */
+
+static const orv_layout_t rsp_layout[] =
+{ { { 'c', 'l' }, -1, RSP_CL, FLD_NONE, FLD_STATE_OLD, LAYOUT_FLDS( fld_cl) },
+  { { 'd', 'c' }, -1, RSP_DC, FLD_NONE, FLD_NONE,      NULL, 0 },
+  { { 'h', 'b' }, -1, RSP_HB, FLD_NONE, FLD_NONE,      NULL, 0 },
+  { { 'q', 'a' }, -1, RSP_QA, FLD_MAC,  FLD_STATE_OLD, LAYOUT_FLDS( fld_qa) },
+  { { 'q', 'g' }, -1, RSP_QG, FLD_NONE, FLD_STATE_OLD, LAYOUT_FLDS( fld_qa) },
+  { { 'r', 't' }, -1, RSP_RT, FLD_NONE, FLD_NONE,      LAYOUT_FLDS( fld_rt) },
+  { { 'r', 't' },  1, RSP_RT, FLD_NONE, FLD_NONE,      NULL, 0 },
+  { { 'r', 't' },  3, RSP_RT, FLD_NONE, FLD_NONE,      NULL, 0 },
+  { { 'r', 't' },  4, RSP_RT, FLD_NONE, FLD_COUNTDOWN, LAYOUT_FLDS( fld_rt4) },
+  { { 's', 'f' }, -1, RSP_SF, FLD_NONE, FLD_STATE_NEW, LAYOUT_FLDS( fld_sf) },
+  { { 't', 'm' }, -1, RSP_TM, FLD_NONE, FLD_NONE,      LAYOUT_FLDS( fld_tm) }
+};
+
+#define RSP_LAYOUT_CNT (sizeof( rsp_layout)/ sizeof( rsp_layout[ 0]))
+
+/* Report columns ("columns=").  The response-field columns (FLD_xxx)
+ * are also the "key=value" table data saved in the inventory cache.
+ */
+
+static const orv_col_t cols[] =
+{ { "ip",     COL_IP,            15, "IP address" },
+  { "mac",    COL_MAC,           17, "MAC address" },
+  { "name",   COL_NAME,          18, ">Device name<" },
+  { "state",  COL_STATE,          5, "State" },
+  { "type",   COL_TYPE,          10, "Type" },
+  { "vers",   FLD_VERSION_ID,     5, "Vers" },
+  { "hw",     FLD_HW_VERSION,    10, "HW vers" },
+  { "fw",     FLD_FW_VERSION,    10, "FW vers" },
+  { "cc",     FLD_CC_VERSION,    10, "CC vers" },
+  { "icon",   FLD_TYPE,           4, "Icon" },
+  { "sport",  FLD_SERVER_PORT,    5, "SPort" },
+  { "sip",    FLD_SERVER_IP,     15, "Server IP" },
+  { "rport",  FLD_REMOTE_PORT,    5, "RPort" },
+  { "rname",  FLD_REMOTE_NAME,   20, "Remote name" },
+  { "lip",    FLD_LOCAL_IP,      15, "Local IP" },
+  { "lgw",    FLD_LOCAL_GW,      15, "Local GW" },
+  { "lnm",    FLD_LOCAL_NM,      15, "Local netmask" },
+  { "dhcp",   FLD_DHCP,           4, "DHCP" },
+  { "disc",   FLD_DISCOVERABLE,   4, "Disc" },
+  { "tzset",  FLD_TZ_SET,         5, "TZset" },
+  { "tz",     FLD_TZ,             3, "TZ" },
+  { "cds",    FLD_COUNTDOWN_STS,  3, "CDs" },
+  { "cd",     FLD_COUNTDOWN,      5, "CD" }
+};
+
+#define COLS_CNT (sizeof( cols)/ sizeof( cols[ 0]))
+
+static int col_sel[ COL_SEL_MAX];               /* Selected columns. */
+static int col_sel_cnt;                         /* Selected column count. */
+
 
 /* Device type names. */
 
@@ -332,12 +1118,25 @@ static const char *icon_name[ ICON_MAX+ 1] =    /* Device type names. */
    "Socket-US", "Socket-AU"
  };
 
+/* Timer repeat day names, and their TMR_DAYS bits (device order:
+ * 0x01: Sat, 0x02: Fri, ..., 0x20: Mon, 0x40: Sun).
+ */
+
+static const char *day_name[ 7] =
+ { "Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun"
+ };
+
+static const unsigned char day_bit[ 7] =
+ { 0x20, 0x10, 0x08, 0x04, 0x02, 0x01, 0x40
+ };
+
 /* ORVL operation keywords. */
 
 char *oprs[] =
 {       "heartbeat",    "help",         "list",         "qlist",
         "off",          "on",           "set",          "usage",
-        "version"
+        "version",      "timers",       "reconcile",    "watch",
+        "daemon"
 };
 
 #define OPR_HEARTBEAT           0
@@ -349,13 +1148,21 @@ char *oprs[] =
 #define OPR_SET                 6
 #define OPR_USAGE               7
 #define OPR_VERSION             8
+#define OPR_TIMERS              9
+#define OPR_RECONCILE          10
+#define OPR_WATCH              11
+#define OPR_DAEMON             12
 
 /* ORVL option keywords. */
 
 char *opts[] =
  {      "brief",        "quiet",        "ddf",          "ddf=",
         "debug",        "debug=",       "name=",        "password=",
-        "sort="
+        "sort=",        "cache",        "cache=",       "expect=",
+        "columns=",     "refresh",      "timer=",       "untimer=",
+        "schedule=",    "countdown=",   "state=",       "group=",
+        "pace=",        "maxage=",      "ctl",          "ctl=",
+        "shm=",         "http=",        "snap="
  };
 
 #define OPT_BRIEF               0
@@ -367,6 +1174,75 @@ char *opts[] =
 #define OPT_NAME_EQ             6
 #define OPT_PASSWORD_EQ         7
 #define OPT_SORT_EQ             8
+#define OPT_CACHE               9
+#define OPT_CACHE_EQ           10
+#define OPT_EXPECT_EQ          11
+#define OPT_COLUMNS_EQ         12
+#define OPT_REFRESH            13
+#define OPT_TIMER_EQ           14
+#define OPT_UNTIMER_EQ         15
+#define OPT_SCHEDULE_EQ        16
+#define OPT_COUNTDOWN_EQ       17
+#define OPT_STATE_EQ           18
+#define OPT_GROUP_EQ           19
+#define OPT_PACE_EQ            20
+#define OPT_MAXAGE_EQ          21
+#define OPT_CTL                22
+#define OPT_CTL_EQ             23
+#define OPT_SHM_EQ             24
+#define OPT_HTTP_EQ            25
+#define OPT_SNAP_EQ            26
+
+/* Daemon control request priority class names (PRI_xxx). */
+
+static const char *pri_name[ PRI_CNT] =
+ {      "interactive",  "control",      "refresh",      "bulk"
+ };
+
+#ifdef USE_DAEMON
+
+/* Daemon control request result names (CTL_xxx). */
+
+static const char *ctl_sts_name[] =
+ {      "ok",           "superseded",   "failed",       "bad"
+ };
+
+/* Daemon requests performed per pass, by priority class.  Background
+ * classes are limited, so that a switch request never waits for more
+ * than one inventory operation.
+ */
+
+static const int pri_limit[ PRI_CNT] =
+ {      CTL_REQ_MAX,    CTL_REQ_MAX,    1,              1
+ };
+
+/* Daemon change subscribers ("subscribe" requests). */
+
+static orv_sub_t subs[ SUB_MAX];
+
+/* Daemon HTTP API listen socket ("http=port"), and connections. */
+
+static int sock_http = -1;
+static orv_http_t http_conn[ HTTP_CONN_MAX];
+
+/* Daemon sockets inherited (socket activation, LISTEN_FDS): control
+ * socket, and device socket (UDP port PORT_ORV).
+ */
+
+static int sock_ctl_inh = -1;
+static SOCKET sock_orv_inh = INVALID_SOCKET;
+static unsigned int sock_orv_inh_drops;         /* Its drop count (cum.). */
+
+/* Daemon DDF watch: inotify descriptor, change seen, DDF name, and
+ * (stat()) identity of the DDF last read.
+ */
+
+static int ddf_ino = -1;
+static int ddf_changed;
+static char *ddf_base;                  /* DDF name (no dir.) (NULL: no DDF). */
+static struct stat ddf_st;
+
+#endif /* def USE_DAEMON */
 
 /* "sort=" option value keywords. */
 
@@ -395,22 +1271,61 @@ char *usage_text[] =
 "Options:    debug[=value]       Set debug flags, all or selected.",
 "            ddf[=file_spec]     Use device data file.  Default: ORVL_DDF",
 "                                 (normally an env-var or logical name).",
+"            cache[=file_spec]   Use/update inventory cache (if no DDF).",
+"                                 Default: ORVL_CACHE",
+"            ctl[=file_spec]     Send [q]list, off, on, watch to daemon",
+"                                 (control socket).  Default: ORVL_CTL",
+"            maxage=ms           [q]list: Use cached dev states seen within",
+"                                 ms, probe only stale devs.  (Sets cache.)",
+"            shm=file_spec       Daemon: Publish dev states in a shared",
+"                                 (memory-mapped) table (orvl_shm.h).",
+"            http=port           Daemon: Serve an HTTP/JSON API on",
+"                                 localhost (127.0.0.1) port.",
+"            snap=file_spec      Daemon: Start from (and save at exit) an",
+"                                 inventory snapshot, revalidate it later.",
+"            expect=count        Device count expected to answer broadcast.",
+"            group=sel[,sel...]  Switch a group of devs (\"off\", \"on\"):",
+"                                 *, MAC or IP address, or device name.",
+"            pace=count[/ms]     Limit group/reconcile switching to count",
+"                                 per interval.  Default interval: 1000ms",
 "            name=device_name    New device name for \"set\" operation.",
 "            password=passwd     New remote password for \"set\" operation.",
+"            countdown=seconds   Start countdown (\"off\", \"on\", \"set\").",
+"                                 The device toggles at 0.  0: cancel.",
+"            columns=list        Select [q]list columns (ip, mac, name, state,",
+"                                 type, vers, fw, cd, ...).",
 "            brief               Simplify [q]list and off/on reports.",
 "            quiet               Suppress [q]list and off/on reports.",
+"            refresh             Re-query devices (ignore cached table data).",
+"            schedule=file_spec  Deploy timer schedule file (\"timers\" op).",
 "            sort={ip|mac}       Sort devs by IP or MAC addr.  Default: ip",
+"            state=file_spec     Desired-state file (\"reconcile\" op).",
+"            timer=spec          New timer for \"timers\" operation.  Spec:",
+"                                 {on|off},[yyyy-mm-dd,]hh:mm[:ss][,rpt]",
+"                                 rpt: once, daily, or mon+tue+...",
+"            untimer=nr          Delete timer (record number) (\"timers\").",
 "",
 "Operations: help, usage         Display this help/usage text.",
 "            list                List devices.  (Minimal device queries.)",
 "            qlist               Query and list devices.  (Query device(s)",
 "                                 to get detailed device information.)",
-"            off, on             Switch off/on.  Identifier required.",
-"            set                 Set dev data (name, password).  Ident req'd.",
+"            off, on             Switch off/on.  Identifier required",
+"                                 (unless \"group=\").",
+"            set                 Set dev data (name, password, countdown).",
+"                                 Identifier required.",
+"            timers              List (add, delete) dev timers.  Ident req'd",
+"                                 (unless \"schedule=\").",
+"            reconcile           Switch/set only devs not in desired state.",
+"            watch               Report state changes as they occur (until",
+"                                 interrupted).  With \"ctl\", ident. is a",
+"                                 filter: mac=, name=, net=, type=.",
+"            daemon              Serve \"ctl\" requests, coalescing concurrent",
+"                                 ones (until interrupted).",
 "            version             Show program version.",
 "",
 "Identifier: DNS name            DNS name, numeric IP address, or dev name.",
-"            IP address          Used with operations \"off\", \"on\", or \"set\",",
+"            IP address          Used with operations \"off\", \"on\", \"set\",",
+"                                 or \"timers\",",
 "            Device name         or to limit a [q]list report to one device."
 };
 
@@ -642,479 +1557,579 @@ int mac_cmp( unsigned char *ma1, unsigned char *ma2)
 
 /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-/* orv_data_new(): Insert new member into orv_data LL. */
+/* arena_alloc(): Allocate storage from an arena.
+ *                 Storage is carved sequentially from large blocks,
+ *                 and is never freed individually.  arena_release()
+ *                 frees everything in the arena at once.
+ */
 
-orv_data_t *orv_data_new( orv_data_t *origin_p, void *sort_p)
-{
-  orv_data_t *orv_data_p;
-  orv_data_t *orv_data_new_p;
+#define ARENA_HDR_SIZE \
+ ((sizeof( orv_arena_blk_t)+ ARENA_ALIGN- 1)& ~(ARENA_ALIGN- 1))
 
-  /* Allocate storage for the new LL member. */
-  orv_data_new_p = malloc( sizeof( orv_data_t));
-  if (orv_data_new_p != NULL)
-  {
-    /* Find insertion point in LL, sorting by IP address (in host order). */
-    orv_data_p = origin_p->next;        /* Start with first (real?) LL mmbr. */
-    while (orv_data_p != origin_p)      /* Quit when back to the origin. */
+void *arena_alloc( orv_arena_t *arena_p, size_t siz)
+{
+  orv_arena_blk_t *blk_p;
+  size_t blk_siz;
+  void *p = NULL;
+
+  siz = (siz+ ARENA_ALIGN- 1)& ~(size_t)(ARENA_ALIGN- 1);
+
+  blk_p = arena_p->blk;
+  if ((blk_p == NULL) || (blk_p->size- blk_p->used < siz))
+  { /* Need a new block (of adequate size). */
+    blk_siz = OMAX( ARENA_BLOCK_SIZE, siz);
+    blk_p = malloc( ARENA_HDR_SIZE+ blk_siz);
+    if (blk_p != NULL)
     {
-      if (origin_p->sort_key == SRT_IP)
-      { /* Sort by IP address. */
-        if (ntohl( ((struct in_addr *)sort_p)->s_addr) <
-         ntohl( orv_data_p->ip_addr.s_addr))
-        {
-          break;                /* Insert new member before this member. */
-        }
+      blk_p->size = blk_siz;
+      blk_p->used = 0;
+      if ((arena_p->blk != NULL) && (blk_siz > ARENA_BLOCK_SIZE))
+      { /* Oversize block.  Keep using the current block for later. */
+        blk_p->next = arena_p->blk->next;
+        arena_p->blk->next = blk_p;
       }
       else
-      { /* Sort by MAC address. */
-        if (mac_cmp( (unsigned char *)sort_p, orv_data_p->mac_addr) < 0)
-        {
-          break;
-        }
+      {
+        blk_p->next = arena_p->blk;
+        arena_p->blk = blk_p;
       }
-      orv_data_p = orv_data_p->next;    /* Advance to the next member. */
+      arena_p->total += blk_siz;
     }
+  }
 
-    origin_p->cnt_flg++;                        /* Count the new member. */
+  if (blk_p != NULL)
+  {
+    p = (char *)blk_p+ ARENA_HDR_SIZE+ blk_p->used;
+    blk_p->used += siz;
+  }
+  return p;
+}
 
-    /* Initialize new member data.
-     * (Note: memset(0) sets sort_key to SRT_IP.)
-     */
-    memset( orv_data_new_p, 0, sizeof( orv_data_t));    /* Zero all data. */
-    orv_data_new_p->type = -1;                  /* Set unknown device type. */
-    orv_data_new_p->state = -1;                 /* Set unknown device state. */
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* arena_release(): Release all the storage in an arena (end of run, or
+ *                  end of an epoch).  One normal-size block is kept
+ *                  (emptied) for re-use.
+ */
 
-    /* Insert the new member into the LL before the insertion-point member. */
-    orv_data_new_p->next = orv_data_p;          /* New.next = Old. */
-    orv_data_new_p->prev = orv_data_p->prev;    /* New.prev = Old.prev. */
-    orv_data_p->prev->next = orv_data_new_p;    /* Old.prev.next = New. */
-    orv_data_p->prev = orv_data_new_p;          /* Old.prev = New. */
+void arena_release( orv_arena_t *arena_p)
+{
+  orv_arena_blk_t *blk_p;
+  orv_arena_blk_t *blk_next_p;
+  orv_arena_blk_t *blk_keep_p = NULL;
+
+  blk_p = arena_p->blk;
+  while (blk_p != NULL)
+  {
+    blk_next_p = blk_p->next;
+    if ((blk_keep_p == NULL) && (blk_p->size == ARENA_BLOCK_SIZE))
+    {
+      blk_keep_p = blk_p;
+    }
+    else
+    {
+      free( blk_p);
+    }
+    blk_p = blk_next_p;
+  }
+
+  arena_p->blk = blk_keep_p;
+  arena_p->total = 0;
+  if (blk_keep_p != NULL)
+  {
+    blk_keep_p->next = NULL;
+    blk_keep_p->used = 0;
+    arena_p->total = blk_keep_p->size;
   }
-  return orv_data_new_p;                        /* Return pointer to New. */
 }
 
 /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-/* type_name(): Store a device type name into user's buffer. */
+/* rbuf_get(): Get a receive buffer from the pool (reference count 1).
+ *             The pool grows (malloc()) only when every buffer is in
+ *             use.  Pooled buffers are never freed.
+ */
 
-char *type_name( int type, char *type_buf)
+orv_rbuf_t *rbuf_get( void)
 {
-  if ((type >= 0) && (type < ICON_MAX))
+  orv_rbuf_t *rbuf_p;
+
+  rbuf_p = rbuf_free;
+  if (rbuf_p != NULL)
   {
-    strcpy( type_buf, icon_name[ type]);
+    rbuf_free = rbuf_p->next;
   }
-  else if (type == -1)
+  else
   {
-    strcpy( type_buf, "");
+    rbuf_p = malloc( sizeof( orv_rbuf_t));
   }
-  else
+
+  if (rbuf_p != NULL)
   {
-    sprintf( type_buf, "?%04x?", type);
+    rbuf_p->next = NULL;
+    rbuf_p->refs = 1;
+    rbuf_p->len = 0;
   }
-  return type_buf;
+  return rbuf_p;
 }
 
 /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-/* fprintf_device(): Display device data from LL member. */
+/* rbuf_hold(): Add a reference to a receive buffer. */
 
-int fprintf_device( FILE *fp, orv_data_t *orv_data_p)
+void rbuf_hold( orv_rbuf_t *rbuf_p)
 {
-  int bw = 0;                           /* Bytes written. */
-  int bwt = 0;                          /* Bytes written, total. */
-  int nam_len;                          /* Device name length. */
-  char type_str[ 16];                   /* Device type string. */
-  char ip_str[ 16];                     /* IP address string. */
-  char nam_buf[ DEV_NAME_LEN+ 1];       /* Device name string. */
-  unsigned int ia4;                     /* IP address (host order). */
-
-  ia4 = ntohl( orv_data_p->ip_addr.s_addr);
-
-  nam_buf[ 0] = '>';                            /* ">device name<". */
-  dev_name( orv_data_p, &nam_buf[ 1], &nam_len);
-  nam_buf[ nam_len+ 1] = '<';
-  nam_buf[ nam_len+ 2] = '\0';
+  rbuf_p->refs++;
+}
 
-  sprintf( ip_str, "%u.%u.%u.%u",               /* IP address. */
-   ((ia4/ 0x100/ 0x100/ 0x100)& 0xff),
-   ((ia4/ 0x100/ 0x100)& 0xff),
-   ((ia4/ 0x100)& 0xff),
-   (ia4& 0xff));
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-  type_name( orv_data_p->type, type_str);
-  bw = fprintf( fp,
-   "%-15s  %02x:%02x:%02x:%02x:%02x:%02x  %-18s  # %s    %s\n",
-   ip_str,                                              /* IP address. */
-   orv_data_p->mac_addr[ 0], orv_data_p->mac_addr[ 1],  /* MAC address. */
-   orv_data_p->mac_addr[ 2], orv_data_p->mac_addr[ 3],
-   orv_data_p->mac_addr[ 4], orv_data_p->mac_addr[ 5],
-   nam_buf,                                             /* ">dev name<". */
-   ((orv_data_p->state == -1) ? "???" :         /* State string (Unk). */
-   ((orv_data_p->state == 0) ? "Off" : "On ")), /* State string (0, 1). */
-   type_str);                                           /* Device type. */
+/* rbuf_release(): Drop a reference to a receive buffer.  Return it to
+ *                 the pool when the last reference is dropped.
+ */
 
-  if (bw >= 0)
+void rbuf_release( orv_rbuf_t *rbuf_p)
+{
+  if (rbuf_p != NULL)
   {
-    bwt += bw;
+    rbuf_p->refs--;
+    if (rbuf_p->refs <= 0)
+    {
+      rbuf_p->next = rbuf_free;
+      rbuf_free = rbuf_p;
+    }
   }
-  else
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* gather_add(): Append a segment to a gather list. */
+
+int gather_add( orv_gather_t *gather_p,
+                const unsigned char *base,
+                size_t len)
+{
+  int sts = 0;
+
+  if (len > 0)
   {
-    bwt = -1;
+    if (gather_p->cnt >= GATHER_SEG_MAX)
+    {
+      errno = E2BIG;
+      sts = -1;
+    }
+    else
+    {
+      gather_p->seg[ gather_p->cnt].base = base;
+      gather_p->seg[ gather_p->cnt].len = len;
+      gather_p->cnt++;
+      gather_p->len += len;
+    }
   }
-  return bwt;   /* Bytes written, total.  If error, then -1. */
+  return sts;
 }
 
 /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-/* fprintf_device_header(): Display device list header. */
+/* gather_copy(): Copy a gather list into one (user's) buffer.
+ *                Return the message length, or zero if it won't fit.
+ */
 
-int fprintf_device_header( FILE *fp, int flags, orv_data_t *origin_p)
+size_t gather_copy( orv_gather_t *gather_p, unsigned char *buf, size_t siz)
 {
-  int bw = 0;                           /* Bytes written. */
-  int bwt = 0;                          /* Bytes written, total. */
-  char dev_cnt_str[ 20];
-  time_t t1;
-  struct tm stm;
-
-  time( &t1);
-  LOCALTIME_R( &t1, &stm);
-  sprintf( dev_cnt_str, "(%s: %d)",
-   (((flags& FDL_DDF) != 0) ? "ddf" : "probe"),
-   origin_p->cnt_flg);
+  int i;
+  size_t len = 0;
 
-  bw = fprintf( fp,
-"#      %s %2d.%d  --  Devices %-18s  %04d-%02d-%02d:%02d:%02d:%02d\n",
-   PROGRAM_NAME, PROGRAM_VERSION_MAJ, PROGRAM_VERSION_MIN,
-   dev_cnt_str, (stm.tm_year+ 1900), (stm.tm_mon+ 1), stm.tm_mday,
-   stm.tm_hour, stm.tm_min, stm.tm_sec);
-  if (bw >= 0)
-  {
-    bwt += bw;
-    bw = fprintf( fp,
-"# IP address        MAC address     >Device name<       # State  Type\n");
-  }
-  if (bw >= 0)
-  {
-    bwt += bw;
-    bw = fprintf( fp,
-"#-----------------------------------------------------------------------\n");
-  }
-  if (bw >= 0)
-  {
-    bwt += bw;
-  }
-  if (bw < 0)
+  if (gather_p->len <= siz)
   {
-    bwt = -1;
+    for (i = 0; i < gather_p->cnt; i++)
+    {
+      memcpy( (buf+ len), gather_p->seg[ i].base, gather_p->seg[ i].len);
+      len += gather_p->seg[ i].len;
+    }
   }
-  return bwt;   /* Bytes written, total.  If error, then -1. */
+  return len;
 }
 
 /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-/* fprintf_device_list(): Display device list. */
+/* tm_gather(): Form a gather list for a Write Table ("tm") message
+ *              from a saved Read Table ("rt") response, without
+ *              copying or moving the "rt" data.  The "tm" message
+ *              differs from the "rt" response as follows:
+ *                 Reduced message length and "tm" op-code.
+ *                 Byte 18 is discarded (19:25 become 18:24).
+ *                 Bytes 26, 27 are discarded (28:end become 25:end-3).
+ *              Patches (offsets in the "rt" response, ascending, not
+ *              overlapping, not before byte 28) replace "rt" data.
+ */
 
-int fprintf_device_list( FILE *fp, int flags, orv_data_t *origin_p)
+int tm_gather( orv_gather_t *gather_p,          /* Gather list (output). */
+               orv_rbuf_t *rbuf_p,              /* "rt" response. */
+               orv_patch_t *patch_p,            /* Patches. */
+               int patch_cnt)                   /* Patch count. */
 {
-  orv_data_t *orv_data_p;
-  int bw = 0;                           /* Bytes written. */
-  int bwt = 0;                          /* Bytes written, total. */
-  int header_written = 0;
+  int i;
+  int sts = 0;
+  size_t msg_len;
+  size_t ofs;
+  unsigned char *rt;
 
-  orv_data_p = origin_p->next;  /* Start with the first (real?) LL member. */
-  while (orv_data_p != origin_p)        /* Quit when back to the origin. */
+  rt = rbuf_p->data;
+  msg_len = rbuf_p->len;
+  memset( gather_p, 0, sizeof( *gather_p));
+
+  if (msg_len < 28)
   {
-    bwt += bw;
-    bw = 0;
+    errno = EINVAL;
+    sts = -1;
+  }
+  else
+  {
+    /* Initial "hd", reduced message length, "tm" op-code. */
+    memcpy( gather_p->hdr, rt, 2);
+    gather_p->hdr[ 2] = (unsigned short)(msg_len- 3)/ 256;
+    gather_p->hdr[ 3] = (unsigned short)(msg_len- 3)% 256;
+    memcpy( (gather_p->hdr+ 4), (cmd_write_table+ 4), 2);
 
-    /* If reporting only this device, then save its state (at origin). */
-    if (orv_data_p->cnt_flg != 0)
-    {
-      origin_p->state = orv_data_p->state;
+    sts = gather_add( gather_p, gather_p->hdr, 6);
+    if (sts == 0)
+    { /* MAC address and 0x20 padding (12 bytes). */
+      sts = gather_add( gather_p, (rt+ 6), 12);
+    }
+    if (sts == 0)
+    { /* Bytes 19:25 (including the table and version numbers). */
+      sts = gather_add( gather_p, (rt+ 19), 7);
     }
 
-    if ((flags& FDL_QUIET) == 0)                /* Not quiet. */
+    /* Bytes 28:end, with patches. */
+    ofs = 28;
+    for (i = 0; (sts == 0) && (i < patch_cnt); i++)
     {
-      if (((flags& FDL_SINGLE) == 0) ||         /* Not specific, or: */
-       (orv_data_p->cnt_flg != 0))              /* this one device. */
+      if (((size_t)patch_p[ i].ofs < ofs) ||
+       ((size_t)(patch_p[ i].ofs+ patch_p[ i].len) > msg_len))
       {
-        if ((header_written == 0) && ((flags& FDL_BRIEF) == 0))
-        { /* Write the header once, before any device data. */
-          header_written = 1;
-          bw = fprintf_device_header( fp, flags, origin_p);
-          if (bw < 0)
-          {
-            break;
-          }
-          bwt += bw;
-        }
-        bw = fprintf_device( fp, orv_data_p);
-        if (bw < 0)
+        errno = EINVAL;
+        sts = -1;
+      }
+      else
+      {
+        sts = gather_add( gather_p, (rt+ ofs), (patch_p[ i].ofs- ofs));
+        if (sts == 0)
         {
-          break;
+          sts = gather_add( gather_p, patch_p[ i].data, patch_p[ i].len);
         }
+        ofs = patch_p[ i].ofs+ patch_p[ i].len;
       }
     }
-    orv_data_p = orv_data_p->next;      /* Advance to the next member. */
-  } /* while */
-  if (bw >= 0)
-  {
-    bwt += bw;
+    if (sts == 0)
+    {
+      sts = gather_add( gather_p, (rt+ ofs), (msg_len- ofs));
+    }
   }
-  if (bw < 0)
+
+  if (sts != 0)
   {
-    bwt = -1;
+    gather_p->cnt = 0;
+    gather_p->len = 0;
   }
-  return bwt;   /* Bytes written, total.  If error, then -1. */
+  return sts;
 }
 
 /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-/* msg_dump(): Display message data. */
+/* orv_data_link(): Insert a member into the orv_data LL, in order (by
+ *                  IP address or MAC address, as the origin sort_key
+ *                  says).
+ */
 
-void msg_dump( unsigned char *buf, ssize_t len)
+void orv_data_link( orv_data_t *origin_p, orv_data_t *orv_data_new_p)
 {
-  ssize_t i;
-  char dmp[ 17];
+  orv_data_t *orv_data_p;
 
-  for (i = 0; i < len; i++)
+  /* Find insertion point in LL, sorting by IP address (in host order). */
+  orv_data_p = origin_p->next;          /* Start with first (real?) LL mmbr. */
+  while (orv_data_p != origin_p)        /* Quit when back to the origin. */
   {
-    fprintf( stderr, " %02x", buf[ i]);
-    if ((buf[ i] >= 32) && (buf[ i] <= 127))
-    {
-      dmp[ i% 16] = buf[ i];
+    if (origin_p->sort_key == SRT_IP)
+    { /* Sort by IP address. */
+      if (ntohl( orv_data_new_p->ip_addr.s_addr) <
+       ntohl( orv_data_p->ip_addr.s_addr))
+      {
+        break;                  /* Insert new member before this member. */
+      }
     }
     else
-    {
-      dmp[ i% 16] = '.';
-    }
-    if ((i% 16) == 15)
-    {
-      dmp[ (i% 16)+ 1] = '\0';
-      fprintf( stderr, "    >%s<\n", dmp);
+    { /* Sort by MAC address. */
+      if (mac_cmp( orv_data_new_p->mac_addr, orv_data_p->mac_addr) < 0)
+      {
+        break;
+      }
     }
+    orv_data_p = orv_data_p->next;      /* Advance to the next member. */
   }
 
-  if ((i% 16) != 0)
-  {
-    dmp[ (i% 16)] = '\0';
-  }
+  origin_p->cnt_flg++;                          /* Count the new member. */
 
-  for (i = len; i < (ssize_t)((len+ 15)& 0xfffffff0); i++)
-  {
-    fprintf( stderr, "   ");
-  }
-  fprintf( stderr, "    >%s<\n", dmp);
+  /* Insert the new member into the LL before the insertion-point member. */
+  orv_data_new_p->next = orv_data_p;            /* New.next = Old. */
+  orv_data_new_p->prev = orv_data_p->prev;      /* New.prev = Old.prev. */
+  orv_data_p->prev->next = orv_data_new_p;      /* Old.prev.next = New. */
+  orv_data_p->prev = orv_data_new_p;            /* Old.prev = New. */
 }
 
 /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-/* hexchr2int(): Convert hex character to int value. */
+/* orv_data_new(): Insert new member into orv_data LL.  (Use a recycled
+ *                 member, if any.)
+ */
 
-int hexchr2int( char c)
+orv_data_t *orv_data_new( orv_data_t *origin_p, void *sort_p)
 {
-  int val = -1;
+  orv_data_t *orv_data_new_p;
 
-  if ((c >= '0') && (c <= '9'))
+  /* Allocate storage for the new LL member (from the arena). */
+  orv_data_new_p = orv_data_free;
+  if (orv_data_new_p != NULL)
   {
-    val = c- '0';
+    orv_data_free = orv_data_new_p->next;
   }
-  else if ((c >= 'A') && (c <= 'F'))
+  else
   {
-    val = c- 'A'+ 10;
+    orv_data_new_p = arena_alloc( &arena, sizeof( orv_data_t));
   }
-  else if ((c >= 'a') && (c <= 'f'))
+  if (orv_data_new_p != NULL)
   {
-    val = c- 'a'+ 10;
+    /* Initialize new member data.
+     * (Note: memset(0) sets sort_key to SRT_IP.)
+     */
+    memset( orv_data_new_p, 0, sizeof( orv_data_t));    /* Zero all data. */
+    orv_data_new_p->type = -1;                  /* Set unknown device type. */
+    orv_data_new_p->state = -1;                 /* Set unknown device state. */
+    if (origin_p->sort_key == SRT_IP)
+    { /* (Sort key, for orv_data_link().) */
+      orv_data_new_p->ip_addr.s_addr = ((struct in_addr *)sort_p)->s_addr;
+    }
+    else
+    {
+      memcpy( orv_data_new_p->mac_addr, sort_p, MAC_ADDR_SIZE);
+    }
+
+    orv_data_link( origin_p, orv_data_new_p);
   }
-  return val;
+  return orv_data_new_p;                        /* Return pointer to New. */
 }
 
 /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-/* parse_mac(): Translate "xx:xx:xx:xx:xx:xx" string to byte array. */
+/* orv_data_unlink(): Remove a member from the orv_data LL.
+ *                    (Its storage belongs to the arena.)
+ */
 
-int parse_mac( char *str, unsigned char *bytes)
+void orv_data_unlink( orv_data_t *origin_p, orv_data_t *orv_data_p)
 {
-  int i;
-  int sts = 0;                                  /* Assume success. */
+  orv_data_p->prev->next = orv_data_p->next;    /* Prev.next = Old.next. */
+  orv_data_p->next->prev = orv_data_p->prev;    /* Next.prev = Old.prev. */
+  origin_p->cnt_flg--;                          /* Un-count the member. */
+}
 
-  if (strlen( str) != (MAC_ADDR_SIZE* 3- 1))
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* orv_data_recycle(): Keep an unlinked member's storage for reuse
+ *                     (orv_data_new()).  Only for a member to which
+ *                     nothing else refers.
+ */
+
+void orv_data_recycle( orv_data_t *orv_data_p)
+{
+  orv_data_p->next = orv_data_free;
+  orv_data_free = orv_data_p;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* type_name(): Store a device type name into user's buffer. */
+
+char *type_name( int type, char *type_buf)
+{
+  if ((type >= 0) && (type < ICON_MAX))
   {
-    sts = -1;                           /* Wrong string length. */
+    strcpy( type_buf, icon_name[ type]);
+  }
+  else if (type == -1)
+  {
+    strcpy( type_buf, "");
   }
   else
-  { /* Allow ":" or "-" as MAC octet separators. */
-    for (i = 0; i < (MAC_ADDR_SIZE- 1); i++)
-    {
-      if ((str[ i* 3+ 2] != ':') && (str[ i* 3+ 2] != '-'))
-      {
-        sts = -2;                       /* Bad separator. */
-        break;
-      }
-    }
+  {
+    sprintf( type_buf, "?%04x?", type);
+  }
+  return type_buf;
+}
 
-    if (sts == 0)
-    {
-      for (i = 0; i < MAC_ADDR_SIZE; i++)
-      {
-        int c0;
-        int c1;
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-        c1 = hexchr2int( str[ 3* i]);
-        c0 = hexchr2int( str[ 3* i+ 1]);
+/* rsp_fld_find(): Find the ("rt") layout entry for a response field. */
 
-        if ((c0 < 0) || (c1 < 0))
+const orv_fld_t *rsp_fld_find( int fld)
+{
+  unsigned int i;
+  int j;
+  const orv_fld_t *fld_p = NULL;
+
+  for (i = 0; (fld_p == NULL) && (i < RSP_LAYOUT_CNT); i++)
+  {
+    if ((rsp_layout[ i].op[ 0] == 'r') && (rsp_layout[ i].op[ 1] == 't'))
+    {
+      for (j = 0; j < rsp_layout[ i].fld_cnt; j++)
+      {
+        if (rsp_layout[ i].fld[ j].fld == fld)
         {
-          sts = -3;                     /* Invalid hex digit. */
+          fld_p = &rsp_layout[ i].fld[ j];
           break;
         }
-        else
-        {
-          bytes[ i] = 16* c1+ c0;
-        }
       }
     }
   }
-  return sts;
+  return fld_p;
 }
 
 /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-/* revcpy(): Reverse memcpy(). */
+/* rsp_fld_format(): Format a decoded response field value as text.
+ *                   (Strings are trimmed.)  Return the text length, or
+ *                   -1, if the field is not available.
+ */
 
-void *revcpy( void *dst, const void *src, size_t siz)
+int rsp_fld_format( int fld, orv_rsp_t *rsp_p, char *buf, size_t siz)
 {
-  size_t i;
+  int len = -1;
+  unsigned int val = 0;
+  unsigned char *dst;
+  const orv_fld_t *fld_p;
 
-  for (i = 0; i < siz; i++)
+  fld_p = rsp_fld_find( fld);
+  if ((fld_p != NULL) && RSP_HAVE( rsp_p, fld))
   {
-    ((unsigned char *)dst)[ i] = ((unsigned char *)src)[ siz- 1- i];
+    dst = (unsigned char *)rsp_p+ fld_p->dst;
+    if ((fld_p->enc == FLE_LE) || (fld_p->enc == FLE_BE))
+    {
+      memcpy( &val, dst, sizeof( val));
+    }
+
+    if (fld_p->enc == FLE_BE)
+    {
+      len = sprintf( buf, "%u.%u.%u.%u",
+       ((val/ 0x100/ 0x100/ 0x100)& 0xff), ((val/ 0x100/ 0x100)& 0xff),
+       ((val/ 0x100)& 0xff), (val& 0xff));
+    }
+    else if (fld_p->enc == FLE_STR)
+    {
+      len = strlen( (char *)dst);
+      while ((len > 0) && (dst[ len- 1] == ' '))
+      {
+        len--;
+      }
+      len = OMIN( len, (int)siz- 1);
+      memcpy( buf, dst, len);
+      buf[ len] = '\0';
+    }
+    else if (fld_p->fmt == FMT_HEX)
+    {
+      len = sprintf( buf, "0x%08x", val);
+    }
+    else if (fld_p->fmt == FMT_S8)
+    {
+      len = sprintf( buf, "%d", (signed char)val);
+    }
+    else if (fld_p->enc == FLE_LE)
+    {
+      len = sprintf( buf, "%u", val);
+    }
   }
-  return dst;
+  return len;
 }
 
 /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-/* show_errno(): Display error code(s), message. */
+/* rsp_fld_parse(): Parse a "key=value" (cache) token into a decoded
+ *                  response record.  (A string value may be quoted,
+ *                  ">value<".)  Return 0, if recognized.
+ */
 
-int show_errno( char *prog_name)
+int rsp_fld_parse( char *tkn, orv_rsp_t *rsp_p)
 {
-  int sts;
-
-  if (prog_name == NULL)
+  int sts = -1;
+  unsigned int i;
+  char *val_str;
+  size_t key_len;
+  size_t val_len;
+  unsigned char *dst;
+  unsigned int val;
+  unsigned int b[ 4];
+  const orv_fld_t *fld_p;
+
+  val_str = strchr( tkn, '=');
+  if (val_str != NULL)
   {
-    prog_name = "";
-  }
-
-#ifdef _WIN32
-  sts = fprintf( stderr, "%s: errno = %d, WSAGLA() = %d.\n",
-   prog_name, errno, WSAGetLastError());
-#else /* def _WIN32 */
-# ifdef VMS
-  sts = fprintf( stderr, "%s: errno = %d, vaxc$errno = %08x.\n",
-   prog_name, errno, vaxc$errno);
-# else /* def VMS */
-  sts = fprintf( stderr, "%s: errno = %d.\n", prog_name, errno);
-# endif /* def VMS [else] */
-#endif /* def _WIN32 [else]*/
-
-  if (sts >= 0)
-  {
-    fprintf( stderr, "%s: %s\n", prog_name, strerror( errno));
-  }
-  return sts;
-}
-
-/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-/* dns_resolve(): Resolve DNS name to IPv4 address using getaddrinfo(). */
-
-int dns_resolve( char *name, struct in_addr *ip_addr)
-{
-  int sts;
-  struct addrinfo *ai_pp;       /* addrinfo() result (linked list). */
-  struct addrinfo ai_h;         /* addrinfo() hints. */
-
-  /* Fill getaddrinfo() hints structure. */
-  memset( &ai_h, 0, sizeof( ai_h));
-  ai_h.ai_family = AF_INET;
-  ai_h.ai_protocol = IPPROTO_UDP;
-
-  sts = getaddrinfo( name,              /* Node name. */
-                     NULL,              /* Service name. */
-                     &ai_h,             /* Hints. */
-                     &ai_pp);           /* Results (linked list). */
-
-  if (sts != 0)
-  {
-    if ((debug& DBG_DNS) != 0)
-    {
-      fprintf( stderr, " getaddrinfo() failed.\n");
-    }
-  }
-  else
-  { /* Use the first result in the ai_pp linked list. */
-    if ((debug& DBG_DNS) != 0)
+    key_len = val_str- tkn;
+    val_str++;
+    for (i = 0; i < COLS_CNT; i++)
     {
-      fprintf( stderr, " getaddrinfo():\n");
-      fprintf( stderr,
-       " ai_family = %d, ai_socktype = %d, ai_protocol = %d\n",
-       ai_pp->ai_family, ai_pp->ai_socktype, ai_pp->ai_protocol);
-
-      fprintf( stderr,
-       " ai_addrlen = %d, ai_addr->sa_family = %d.\n",
-       ai_pp->ai_addrlen, ai_pp->ai_addr->sa_family);
-
-      fprintf( stderr,
-       " ai_flags = 0x%08x.\n", ai_pp->ai_flags);
-
-      if (ai_pp->ai_addr->sa_family == AF_INET)
+      if ((cols[ i].fld >= 0) && (strlen( cols[ i].key) == key_len) &&
+       (strncmp( tkn, cols[ i].key, key_len) == 0))
       {
-        fprintf( stderr, " ai_addr->sa_data[ 2: 5] = %u.%u.%u.%u\n",
-         (unsigned char)ai_pp->ai_addr->sa_data[ 2],
-         (unsigned char)ai_pp->ai_addr->sa_data[ 3],
-         (unsigned char)ai_pp->ai_addr->sa_data[ 4],
-         (unsigned char)ai_pp->ai_addr->sa_data[ 5]);
+        break;
       }
     }
 
-#ifndef NO_AF_CHECK     /* Disable the address-family check everywhere. */
+    fld_p = NULL;
+    if (i < COLS_CNT)
     {
-# if defined( VMS) && defined( VAX) && !defined( GETADDRINFO_OK)
-      /* Work around apparent bug in getaddrinfo() in TCPIP V5.3 - ECO 4
-       * on VMS V7.3 (typical hobbyist kit?).  sa_family seems to be
-       * misplaced, misaligned, corrupted.  Spurious sa_len?
-       */
-      int sa_fam;
-#  define SA_FAMILY sa_fam
+      fld_p = rsp_fld_find( cols[ i].fld);
+    }
 
-      if (ai_pp->ai_addr->sa_family != AF_INET)
+    if (fld_p != NULL)
+    {
+      sts = 0;
+      dst = (unsigned char *)rsp_p+ fld_p->dst;
+      if (fld_p->enc == FLE_BE)
       {
-        if ((debug& DBG_DNS) != 0)
+        if (sscanf( val_str, "%u.%u.%u.%u", &b[ 0], &b[ 1], &b[ 2], &b[ 3])
+         != 4)
         {
-          fprintf( stderr,
-           " Unexpected address family (not %d, V-V work-around): %d.\n",
-           AF_INET, ai_pp->ai_addr->sa_family);
+          sts = -1;
         }
-        SA_FAMILY = ai_pp->ai_addr->sa_family/ 256;     /* Try offset. */
+        val = ((b[ 0]* 256+ b[ 1])* 256+ b[ 2])* 256+ b[ 3];
+        memcpy( dst, &val, sizeof( val));
       }
-# else /* defined( VMS) && defined( VAX) && !defined( GETADDRINFO_OK) */
-#  define SA_FAMILY ai_pp->ai_addr->sa_family
-# endif /* defined( VMS) && defined( VAX) && !defined( GETADDRINFO_OK) [else] */
-
-      if (SA_FAMILY != AF_INET)
-      { /* Complain about (original) bad value. */
-        fprintf( stderr, "%s: Unexpected address family (not %d): %d.\n",
-         PROGRAM_NAME, AF_INET, ai_pp->ai_addr->sa_family);
+      else if (fld_p->enc == FLE_STR)
+      {
+        val_len = strlen( val_str);
+        if ((val_len >= 2) && (val_str[ 0] == '>') &&
+         (val_str[ val_len- 1] == '<'))
+        { /* ">value<". */
+          val_str[ val_len- 1] = '\0';
+          val_str++;
+        }
+        memset( dst, ' ', fld_p->len);
+        memcpy( dst, val_str, OMIN( strlen( val_str), (size_t)fld_p->len));
+        dst[ fld_p->len] = '\0';
+      }
+      else if (fld_p->enc == FLE_LE)
+      {
+        val = strtol( val_str, NULL, 0);
+        memcpy( dst, &val, sizeof( val));
+      }
+      else
+      {
         sts = -1;
       }
-    }
-#endif /* ndef NO_AF_CHECK */
 
-    if ((sts == 0) && (ip_addr != NULL))
-    { /* IPv4 address (net order). */
-      memcpy( ip_addr, &ai_pp->ai_addr->sa_data[ 2], sizeof( *ip_addr));
+      if (sts == 0)
+      {
+        rsp_p->have |= (1U<< fld_p->fld);
+      }
     }
   }
   return sts;
@@ -1122,1798 +2137,8289 @@ int dns_resolve( char *name, struct in_addr *ip_addr)
 
 /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-/* set_socket_noblock(): Set socket to non-blocking. */
+/* ms_time(): Current time in milliseconds (arbitrary origin). */
 
-int set_socket_noblock( int sock)
+#ifdef _WIN32                   /* Windows: Use GetTickCount(). */
+
+unsigned long ms_time( void)
 {
-#ifdef USE_FCNTL                        /* Use fcntl(). */
+  return GetTickCount();
+}
 
-  int fc_flgs;
-  int sts = 0;                                  /* Assume success. */
+#else /* def _WIN32 */          /* Non-Windows: Use gettimeofday(). */
 
-  fc_flgs = fcntl( sock, F_GETFL, 0);           /* Get current flags. */
+unsigned long ms_time( void)
+{
+  struct timeval tv;
 
-  if ((debug& DBG_SIO) != 0)
-  {
-    fprintf( stderr, " fcntl(0).  Sock = %d, flgs = %08x .\n",
-     sock, fc_flgs);
-  }
+  gettimeofday( &tv, NULL);
+  return (unsigned long)tv.tv_sec* 1000+ tv.tv_usec/ 1000;
+}
 
-  if (fc_flgs != -1)
-  {
-    fc_flgs |= O_NONBLOCK;                      /* OR-in O_NONBLOCK. */
+#endif /* def _WIN32 [else] */
 
-    if ((debug& DBG_SIO) != 0)
-    {
-      fprintf( stderr, " fcntl(1). flgs = %08x .\n", fc_flgs);
-    }
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-    fc_flgs = fcntl( sock, F_SETFL, fc_flgs);   /* Set revised flags.*/
+/* wall_time(): Current (wall-clock) time in seconds since the Epoch,
+ *              with a fraction (milliseconds, where available).
+ */
 
-    if ((debug& DBG_SIO) != 0)
-    {
-      fprintf( stderr, " fcntl(2). flgs = %08x .\n", fc_flgs);
-    }
-  }
+#ifdef _WIN32                   /* Windows: Use time() (whole seconds). */
 
-  if (fc_flgs == -1)
-  {
-    fprintf( stderr, "%s: fcntl(noblock) failed.  sock = %d.\n",
-     PROGRAM_NAME, sock);
-    show_errno( PROGRAM_NAME);
-    sts = -1;
-  }
+double wall_time( void)
+{
+  return (double)time( NULL);
+}
 
-#else /* def USE_FCNTL */               /* Use ioctl(). */
+#else /* def _WIN32 */          /* Non-Windows: Use gettimeofday(). */
 
-  int ioctl_tmp;
-  int sts;
+double wall_time( void)
+{
+  struct timeval tv;
 
-  ioctl_tmp = 1;
-  sts = IOCTL_SOCKET( sock, FIONBIO, &ioctl_tmp);       /* Set FIONBIO. */
+  gettimeofday( &tv, NULL);
+  return (double)tv.tv_sec+ (double)tv.tv_usec/ 1000000.0;
+}
 
-  if ((debug& DBG_SIO) != 0)
-  {
-    fprintf( stderr, " ioctl() sts = %d, tmp = %08x .\n",
-     sts, ioctl_tmp);
-  }
+#endif /* def _WIN32 [else] */
 
-  if (sts < 0)
-  {
-    fprintf( stderr, "%s: ioctl() failed.  sock = %d, sts = %d.\n",
-     PROGRAM_NAME, sock, sts);
-    show_errno( PROGRAM_NAME);
-  }
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-#endif /* def USE_FCNTL [else] */
+/* rsp_src_name(): Form the operation code ("qa", "sf", ...) of a
+ *                 response type (RSP_xxx).  "--", if none.
+ */
 
-  return sts;                                   /* -1, if error. */
+char *rsp_src_name( int rsp, char *buf)
+{
+  unsigned int i;
+
+  buf[ 0] = '-';
+  buf[ 1] = '-';
+  buf[ 2] = '\0';
+  for (i = 0; i < RSP_LAYOUT_CNT; i++)
+  {
+    if (rsp_layout[ i].rsp == rsp)
+    {
+      buf[ 0] = rsp_layout[ i].op[ 0];
+      buf[ 1] = rsp_layout[ i].op[ 1];
+      break;
+    }
+  }
+  return buf;
 }
 
 /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-#ifdef VMS
-# ifndef NO_OPER_PRIVILEGE
-
-/* set_priv_oper(): Try to set OPER privilege according to oper_new.
- *                  Set *oper_old_p to old value.
+/* state_fld_parse(): Parse a cached device state token ("state=",
+ *                    "seen=", "src=", "rtt=", "sub=", "ivers=") into
+ *                    an LL member.  Return 0, if recognized.
  */
 
-int set_priv_oper( int oper_new, int *oper_old_p)
+int state_fld_parse( char *tkn, orv_data_t *orv_data_p)
 {
-  int sts;
-  union prvdef priv_mask_old = { 0 };   /*  Privilege masks. */
-  union prvdef priv_mask_new = { 0 };
-
-  oper_new = (oper_new == 0 ? 0 : 1);   /* Ensure 0/1 flag value. */
-  priv_mask_new.prv$v_oper = 1;         /* OPER privilege mask bit. */
-  sts = sys$setprv( oper_new,           /* Enable/disable privileges. */
-                    &priv_mask_new,     /* New privilege mask. */
-                    0,                  /* Not permanent. */
-                    &priv_mask_old);    /* Previous privilege mask. */
+  int i;
+  int sts = -1;
+  unsigned int j;
+  char *cp;
+  double t;
 
-  if (sts == SS$_NORMAL)
+  if (strncmp( tkn, "state=", 6) == 0)
   {
-    sts = 0;
-    if (oper_old_p != NULL)
+    if (STRNCASECMP( (tkn+ 6), "Off", 4) == 0)
     {
-      *oper_old_p = priv_mask_old.prv$v_oper;
+      sts = 0;
+      orv_data_p->state = 0;
+    }
+    else if (STRNCASECMP( (tkn+ 6), "On", 3) == 0)
+    {
+      sts = 0;
+      orv_data_p->state = 1;
     }
   }
-  else
+  else if (strncmp( tkn, "seen=", 5) == 0)
   {
-    errno = EVMSERR;
-    vaxc$errno = sts;
+    t = strtod( (tkn+ 5), &cp);
+    if ((*cp == '\0') && (t > 0.0))
+    {
+      sts = 0;
+      orv_data_p->state_t = t;
+    }
+  }
+  else if (strncmp( tkn, "rtt=", 4) == 0)
+  {
+    i = strtol( (tkn+ 4), &cp, 10);
+    if ((*cp == '\0') && (i > 0))
+    {
+      sts = 0;
+      orv_data_p->rtt_ms = i;
+    }
+  }
+  else if (strncmp( tkn, "sub=", 4) == 0)
+  {
+    t = strtod( (tkn+ 4), &cp);
+    if ((*cp == '\0') && (t > 0.0))
+    {
+      sts = 0;
+      orv_data_p->sub_t = t;
+    }
+  }
+  else if (strncmp( tkn, "ivers=", 6) == 0)
+  {
+    i = strtol( (tkn+ 6), &cp, 10);
+    if ((*cp == '\0') && (cp > tkn+ 6) && (i >= 0) && (i <= 0xffff))
+    {
+      sts = 0;
+      orv_data_p->ivers = i+ 1;
+    }
+  }
+  else if ((strncmp( tkn, "src=", 4) == 0) && (strlen( tkn+ 4) == 2))
+  {
+    for (j = 0; j < RSP_LAYOUT_CNT; j++)
+    {
+      if ((rsp_layout[ j].op[ 0] == tkn[ 4]) &&
+       (rsp_layout[ j].op[ 1] == tkn[ 5]))
+      {
+        sts = 0;
+        orv_data_p->state_src = rsp_layout[ j].rsp;
+        break;
+      }
+    }
   }
   return sts;
 }
 
-# endif /* ndef NO_OPER_PRIVILEGE */
-#endif /* def VMS */
-
 /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-/* form_msg_out(): Form an output message. */
+/* col_need_rt4(): Do the selected columns need table 4 data? */
 
-size_t form_msg_out( int task_nr,
-                     unsigned char **msg_out,
-                     unsigned char *mac_addr)
+int col_need_rt4( void)
 {
-  size_t msg_out_len = 0;
-  char *str;
+  int i;
+  int need = 0;
 
-  /* TSK_WT_SOCKET uses modified "rt" data from device, not a message
-   * created here.  TSK_WT_TIMING still not determined.
-   */
+  for (i = 0; i < col_sel_cnt; i++)
+  {
+    if (cols[ col_sel[ i]].fld >= 0)
+    {
+      need = 1;
+      break;
+    }
+  }
+  return need;
+}
 
-  if ((task_nr >= TSK_MIN) && (task_nr <= TSK_MAX))
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* col_select(): Parse a "columns=" option value (comma-separated column
+ *               keywords) into col_sel[].  Return 0, if all are valid.
+ */
+
+int col_select( char *col_list)
+{
+  int sts = 0;
+  unsigned int i;
+  char *cp;
+  size_t len;
+
+  col_sel_cnt = 0;
+  cp = col_list;
+  while ((sts == 0) && (*cp != '\0'))
   {
-    if ((task_nr == TSK_GLOB_DISC_B) || (task_nr == TSK_GLOB_DISC))
-    { /* Global discovery. */
-      str = "GLOB DISC";
-      *msg_out = malloc( sizeof( cmd_glob_disc));
-      if (*msg_out != NULL)
+    len = strcspn( cp, ",");
+    for (i = 0; i < COLS_CNT; i++)
+    {
+      if ((strlen( cols[ i].key) == len) &&
+       (STRNCASECMP( cp, cols[ i].key, len) == 0))
       {
-        msg_out_len = sizeof( cmd_glob_disc);
-        memcpy( *msg_out, cmd_glob_disc, msg_out_len);
+        break;
       }
     }
-    else if (task_nr == TSK_UNIT_DISC)
-    { /* Unit discovery. */
-      str = "UNIT DISC";
-      *msg_out = malloc( sizeof( cmd_unit_disc));
-      if (*msg_out != NULL)
-      {
-        msg_out_len = sizeof( cmd_unit_disc);
-        memcpy( *msg_out, cmd_unit_disc, msg_out_len);
-        if (mac_addr != NULL)
-        {
-          memcpy( (*msg_out+ 6), mac_addr, MAC_ADDR_SIZE);      /* MAC addr. */
-        }
-      }
+
+    if ((i >= COLS_CNT) || (col_sel_cnt >= COL_SEL_MAX))
+    {
+      fprintf( stderr, "%s: Unknown column (or too many): %.*s\n",
+       PROGRAM_NAME, (int)len, cp);
+      errno = EINVAL;
+      sts = -1;
+    }
+    else
+    {
+      col_sel[ col_sel_cnt++] = i;
+      cp += len;
+      if (*cp == ',')
+      {
+        cp++;
+      }
+    }
+  }
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* fprintf_device_cols(): Display selected columns from LL member. */
+
+int fprintf_device_cols( FILE *fp, orv_data_t *orv_data_p)
+{
+  int i;
+  int bw = 0;                           /* Bytes written. */
+  int bwt = 0;                          /* Bytes written, total. */
+  int len;
+  unsigned int ia4;                     /* IP address (host order). */
+  char val_buf[ 64];                    /* Column value string. */
+  const orv_col_t *col_p;
+
+  for (i = 0; (bw >= 0) && (i < col_sel_cnt); i++)
+  {
+    col_p = &cols[ col_sel[ i]];
+    if (col_p->fld == COL_IP)
+    {
+      ia4 = ntohl( orv_data_p->ip_addr.s_addr);
+      sprintf( val_buf, "%u.%u.%u.%u",
+       ((ia4/ 0x100/ 0x100/ 0x100)& 0xff), ((ia4/ 0x100/ 0x100)& 0xff),
+       ((ia4/ 0x100)& 0xff), (ia4& 0xff));
+    }
+    else if (col_p->fld == COL_MAC)
+    {
+      sprintf( val_buf, "%02x:%02x:%02x:%02x:%02x:%02x",
+       orv_data_p->mac_addr[ 0], orv_data_p->mac_addr[ 1],
+       orv_data_p->mac_addr[ 2], orv_data_p->mac_addr[ 3],
+       orv_data_p->mac_addr[ 4], orv_data_p->mac_addr[ 5]);
+    }
+    else if (col_p->fld == COL_NAME)
+    {
+      val_buf[ 0] = '>';
+      dev_name( orv_data_p, &val_buf[ 1], &len);
+      val_buf[ len+ 1] = '<';
+      val_buf[ len+ 2] = '\0';
+    }
+    else if (col_p->fld == COL_STATE)
+    {
+      strcpy( val_buf, ((orv_data_p->state == -1) ? "???" :
+       ((orv_data_p->state == 0) ? "Off" : "On")));
+    }
+    else if (col_p->fld == COL_TYPE)
+    {
+      type_name( orv_data_p->type, val_buf);
+    }
+    else if (rsp_fld_format( col_p->fld, &orv_data_p->rt4,
+     val_buf, sizeof( val_buf)) < 0)
+    {
+      strcpy( val_buf, "-");
+    }
+
+    bw = fprintf( fp, "%s%-*s", ((i == 0) ? "" : "  "),
+     ((i < col_sel_cnt- 1) ? col_p->width : 0), val_buf);
+    if (bw >= 0)
+    {
+      bwt += bw;
+    }
+  }
+
+  if (bw >= 0)
+  {
+    bw = fprintf( fp, "\n");
+    bwt += bw;
+  }
+  return ((bw < 0) ? -1 : bwt); /* Bytes written, total.  If error, -1. */
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* fprintf_device(): Display device data from LL member.
+ *                   With FDL_CACHE, add the table 4 data, the device
+ *                   state, the round-trip time, and the subscription
+ *                   time ("key=value").
+ */
+
+int fprintf_device( FILE *fp, int flags, orv_data_t *orv_data_p)
+{
+  int bw = 0;                           /* Bytes written. */
+  int bwt = 0;                          /* Bytes written, total. */
+  int nam_len;                          /* Device name length. */
+  char type_str[ 16];                   /* Device type string. */
+  char ip_str[ 16];                     /* IP address string. */
+  char nam_buf[ DEV_NAME_LEN+ 1];       /* Device name string. */
+  unsigned int ia4;                     /* IP address (host order). */
+
+  ia4 = ntohl( orv_data_p->ip_addr.s_addr);
+
+  nam_buf[ 0] = '>';                            /* ">device name<". */
+  dev_name( orv_data_p, &nam_buf[ 1], &nam_len);
+  nam_buf[ nam_len+ 1] = '<';
+  nam_buf[ nam_len+ 2] = '\0';
+
+  sprintf( ip_str, "%u.%u.%u.%u",               /* IP address. */
+   ((ia4/ 0x100/ 0x100/ 0x100)& 0xff),
+   ((ia4/ 0x100/ 0x100)& 0xff),
+   ((ia4/ 0x100)& 0xff),
+   (ia4& 0xff));
+
+  type_name( orv_data_p->type, type_str);
+  bw = fprintf( fp,
+   "%-15s  %02x:%02x:%02x:%02x:%02x:%02x  %-18s  ",
+   ip_str,                                              /* IP address. */
+   orv_data_p->mac_addr[ 0], orv_data_p->mac_addr[ 1],  /* MAC address. */
+   orv_data_p->mac_addr[ 2], orv_data_p->mac_addr[ 3],
+   orv_data_p->mac_addr[ 4], orv_data_p->mac_addr[ 5],
+   nam_buf);                                            /* ">dev name<". */
+
+  if ((bw >= 0) && ((flags& FDL_CACHE) != 0))
+  { /* Table 4 data, "key=value" (from the column list).  String
+     * values as ">value<" (which may contain spaces).
+     */
+    unsigned int i;
+    char val_buf[ 64];
+    const orv_fld_t *fld_p;
+
+    for (i = 0; (bw >= 0) && (i < COLS_CNT); i++)
+    {
+      if ((cols[ i].fld >= 0) &&
+       (rsp_fld_format( cols[ i].fld, &orv_data_p->rt4,
+       val_buf, sizeof( val_buf)) > 0))
+      {
+        bwt += bw;
+        fld_p = rsp_fld_find( cols[ i].fld);
+        bw = fprintf( fp, ((fld_p->enc == FLE_STR) ? "%s=>%s< " : "%s=%s "),
+         cols[ i].key, val_buf);
+      }
+    }
+
+    if ((bw >= 0) && (orv_data_p->state >= 0) && (orv_data_p->state_t > 0.0))
+    { /* Device state, when and how it was seen ("maxage="). */
+      bwt += bw;
+      bw = fprintf( fp, "state=%s seen=%.3f src=%s ",
+       ((orv_data_p->state == 0) ? "Off" : "On"), orv_data_p->state_t,
+       rsp_src_name( orv_data_p->state_src, val_buf));
+    }
+    if ((bw >= 0) && (orv_data_p->rtt_ms > 0))
+    { /* Round-trip time (daemon snapshot). */
+      bwt += bw;
+      bw = fprintf( fp, "rtt=%u ", orv_data_p->rtt_ms);
+    }
+    if ((bw >= 0) && (orv_data_p->sub_t > 0.0))
+    { /* Subscription confirmed (daemon snapshot). */
+      bwt += bw;
+      bw = fprintf( fp, "sub=%.3f ", orv_data_p->sub_t);
+    }
+    if ((bw >= 0) && (orv_data_p->ivers > 0) && (orv_data_p->rt4.have != 0))
+    { /* Table 1 index flag for the cached table 4 data. */
+      bwt += bw;
+      bw = fprintf( fp, "ivers=%d ", (orv_data_p->ivers- 1));
+    }
+  }
+
+  if (bw >= 0)
+  {
+    bwt += bw;
+    bw = fprintf( fp, "# %s    %s\n",
+     ((orv_data_p->state == -1) ? "???" :       /* State string (Unk). */
+     ((orv_data_p->state == 0) ? "Off" : "On ")),       /* (0, 1). */
+     type_str);                                         /* Device type. */
+  }
+
+  if (bw >= 0)
+  {
+    bwt += bw;
+  }
+  else
+  {
+    bwt = -1;
+  }
+  return bwt;   /* Bytes written, total.  If error, then -1. */
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* fprintf_device_header(): Display device list header. */
+
+int fprintf_device_header( FILE *fp, int flags, orv_data_t *origin_p)
+{
+  int bw = 0;                           /* Bytes written. */
+  int bwt = 0;                          /* Bytes written, total. */
+  char dev_cnt_str[ 40];
+  time_t t1;
+  struct tm stm;
+
+  time( &t1);
+  LOCALTIME_R( &t1, &stm);
+  sprintf( dev_cnt_str, "(%s: %d)",
+   (((flags& FDL_DDF) != 0) ? "ddf" : "probe"),
+   origin_p->cnt_flg);
+  if (max_age >= 0)
+  { /* Count the devices answered from the state cache. */
+    sprintf( dev_cnt_str+ strlen( dev_cnt_str)- 1, ", cached: %u)",
+     metrics.cache_hit);
+  }
+
+  bw = fprintf( fp,
+"#      %s %2d.%d  --  Devices %-18s  %04d-%02d-%02d:%02d:%02d:%02d\n",
+   PROGRAM_NAME, PROGRAM_VERSION_MAJ, PROGRAM_VERSION_MIN,
+   dev_cnt_str, (stm.tm_year+ 1900), (stm.tm_mon+ 1), stm.tm_mday,
+   stm.tm_hour, stm.tm_min, stm.tm_sec);
+  if ((bw >= 0) && (col_sel_cnt > 0) && ((flags& FDL_CACHE) == 0))
+  { /* Selected columns. */
+    int i;
+
+    bwt += bw;
+    bw = fprintf( fp, "#");
+    for (i = 0; (bw >= 0) && (i < col_sel_cnt); i++)
+    {
+      bwt += bw;
+      bw = fprintf( fp, "%s%-*s", ((i == 0) ? " " : "  "),
+       ((i == col_sel_cnt- 1) ? 0 :
+       ((i == 0) ? (cols[ col_sel[ i]].width- 2) : cols[ col_sel[ i]].width)),
+       cols[ col_sel[ i]].head);
+    }
+    if (bw >= 0)
+    {
+      bwt += bw;
+      bw = fprintf( fp, "\n");
+    }
+  }
+  else if (bw >= 0)
+  {
+    bwt += bw;
+    bw = fprintf( fp,
+"# IP address        MAC address     >Device name<       # State  Type\n");
+  }
+  if (bw >= 0)
+  {
+    bwt += bw;
+    bw = fprintf( fp,
+"#-----------------------------------------------------------------------\n");
+  }
+  if (bw >= 0)
+  {
+    bwt += bw;
+  }
+  if (bw < 0)
+  {
+    bwt = -1;
+  }
+  return bwt;   /* Bytes written, total.  If error, then -1. */
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* fprintf_device_list(): Display device list. */
+
+int fprintf_device_list( FILE *fp, int flags, orv_data_t *origin_p)
+{
+  orv_data_t *orv_data_p;
+  int bw = 0;                           /* Bytes written. */
+  int bwt = 0;                          /* Bytes written, total. */
+  int header_written = 0;
+
+  orv_data_p = origin_p->next;  /* Start with the first (real?) LL member. */
+  while (orv_data_p != origin_p)        /* Quit when back to the origin. */
+  {
+    bwt += bw;
+    bw = 0;
+
+    /* If reporting only this device, then save its state (at origin). */
+    if (orv_data_p->cnt_flg != 0)
+    {
+      origin_p->state = orv_data_p->state;
+    }
+
+    if ((flags& FDL_QUIET) == 0)                /* Not quiet. */
+    {
+      if (((flags& FDL_SINGLE) == 0) ||         /* Not specific, or: */
+       (orv_data_p->cnt_flg != 0))              /* this one device. */
+      {
+        if ((header_written == 0) && ((flags& FDL_BRIEF) == 0))
+        { /* Write the header once, before any device data. */
+          header_written = 1;
+          bw = fprintf_device_header( fp, flags, origin_p);
+          if (bw < 0)
+          {
+            break;
+          }
+          bwt += bw;
+        }
+        if ((col_sel_cnt > 0) && ((flags& FDL_CACHE) == 0))
+        {
+          bw = fprintf_device_cols( fp, orv_data_p);
+        }
+        else
+        {
+          bw = fprintf_device( fp, flags, orv_data_p);
+        }
+        if (bw < 0)
+        {
+          break;
+        }
+      }
+    }
+    orv_data_p = orv_data_p->next;      /* Advance to the next member. */
+  } /* while */
+  if (bw >= 0)
+  {
+    bwt += bw;
+  }
+  if (bw < 0)
+  {
+    bwt = -1;
+  }
+  return bwt;   /* Bytes written, total.  If error, then -1. */
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* fprintf_timers(): Display a device's timer (table 3) records. */
+
+int fprintf_timers( FILE *fp, int flags, orv_timer_t *tmr_p, int tmr_cnt)
+{
+  int i;
+  int j;
+  int bw = 0;                           /* Bytes written. */
+  int bwt = 0;                          /* Bytes written, total. */
+  char rpt_str[ 32];                    /* Repeat string. */
+
+  if ((flags& FDL_BRIEF) == 0)
+  {
+    bw = fprintf( fp,
+"#  Timers: %d\n#    Nr  State  Date        Time      Repeat\n", tmr_cnt);
+  }
+  for (i = 0; (bw >= 0) && (i < tmr_cnt); i++)
+  {
+    bwt += bw;
+    if ((tmr_p[ i].repeat& TMR_REPEAT) == 0)
+    {
+      strcpy( rpt_str, "once");
+    }
+    else if ((tmr_p[ i].repeat& TMR_DAYS) == TMR_DAYS)
+    {
+      strcpy( rpt_str, "daily");
+    }
+    else
+    {
+      rpt_str[ 0] = '\0';
+      for (j = 0; j < 7; j++)
+      {
+        if ((tmr_p[ i].repeat& day_bit[ j]) != 0)
+        {
+          if (rpt_str[ 0] != '\0')
+          {
+            strcat( rpt_str, "+");
+          }
+          strcat( rpt_str, day_name[ j]);
+        }
+      }
+    }
+    bw = fprintf( fp,
+     "%7u  %-3s    %04d-%02d-%02d  %02d:%02d:%02d  %s\n",
+     tmr_p[ i].rec_nr, ((tmr_p[ i].state == 0) ? "Off" : "On"),
+     tmr_p[ i].year, tmr_p[ i].month, tmr_p[ i].day,
+     tmr_p[ i].hour, tmr_p[ i].minute, tmr_p[ i].second, rpt_str);
+  }
+  if (bw >= 0)
+  {
+    bwt += bw;
+  }
+  else
+  {
+    bwt = -1;
+  }
+  return bwt;   /* Bytes written, total.  If error, then -1. */
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* fprintf_sched(): Display schedule deployment results. */
+
+int fprintf_sched( FILE *fp, int flags, orv_data_t *origin_p)
+{
+  int bw = 0;                           /* Bytes written. */
+  int bwt = 0;                          /* Bytes written, total. */
+  int nam_len;                          /* Device name length. */
+  char nam_buf[ DEV_NAME_LEN+ 3];       /* ">device name<". */
+  char ip_str[ 16];                     /* IP address string. */
+  unsigned int ia4;                     /* IP address (host order). */
+  orv_data_t *orv_data_p;
+  orv_sched_t *sched_p;
+
+  if ((flags& FDL_BRIEF) == 0)
+  {
+    bw = fprintf( fp,
+"#  Schedule: >Device name<      Want  Keep   Add   Mod   Del\n");
+  }
+  orv_data_p = origin_p->next;
+  while ((bw >= 0) && (orv_data_p != origin_p))
+  {
+    sched_p = orv_data_p->sched;
+    if (sched_p != NULL)
+    {
+      bwt += bw;
+      nam_buf[ 0] = '>';
+      dev_name( orv_data_p, &nam_buf[ 1], &nam_len);
+      nam_buf[ nam_len+ 1] = '<';
+      nam_buf[ nam_len+ 2] = '\0';
+      ia4 = ntohl( orv_data_p->ip_addr.s_addr);
+      sprintf( ip_str, "%u.%u.%u.%u",
+       ((ia4/ 0x100/ 0x100/ 0x100)& 0xff), ((ia4/ 0x100/ 0x100)& 0xff),
+       ((ia4/ 0x100)& 0xff), (ia4& 0xff));
+      bw = fprintf( fp, "%-15s  %-18s  %4d  %4d  %4d  %4d  %4d%s\n",
+       ip_str, nam_buf, sched_p->want_cnt,
+       sched_p->keep, sched_p->add, sched_p->modify, sched_p->del,
+       ((sched_p->sts == 0) ? "" : "  # FAILED"));
+    }
+    orv_data_p = orv_data_p->next;
+  }
+  if (bw >= 0)
+  {
+    bwt += bw;
+  }
+  else
+  {
+    bwt = -1;
+  }
+  return bwt;   /* Bytes written, total.  If error, then -1. */
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* fprintf_want(): Display desired-state reconciliation results. */
+
+int fprintf_want( FILE *fp, int flags, orv_data_t *origin_p)
+{
+  int bw = 0;                           /* Bytes written. */
+  int bwt = 0;                          /* Bytes written, total. */
+  int nam_len;                          /* Device name length. */
+  char nam_buf[ DEV_NAME_LEN+ 3];       /* ">device name<". */
+  char ip_str[ 16];                     /* IP address string. */
+  unsigned int ia4;                     /* IP address (host order). */
+  orv_data_t *orv_data_p;
+  orv_want_t *want_p;
+
+  static const char *st_name[ 3] = { "-", "Off", "On" };
+
+  if ((flags& FDL_BRIEF) == 0)
+  {
+    bw = fprintf( fp,
+"#  Reconcile: >Device name<     State  Want   Action\n");
+  }
+  orv_data_p = origin_p->next;
+  while ((bw >= 0) && (orv_data_p != origin_p))
+  {
+    want_p = orv_data_p->want;
+    if (want_p != NULL)
+    {
+      bwt += bw;
+      nam_buf[ 0] = '>';
+      dev_name( orv_data_p, &nam_buf[ 1], &nam_len);
+      nam_buf[ nam_len+ 1] = '<';
+      nam_buf[ nam_len+ 2] = '\0';
+      ia4 = ntohl( orv_data_p->ip_addr.s_addr);
+      sprintf( ip_str, "%u.%u.%u.%u",
+       ((ia4/ 0x100/ 0x100/ 0x100)& 0xff), ((ia4/ 0x100/ 0x100)& 0xff),
+       ((ia4/ 0x100)& 0xff), (ia4& 0xff));
+      bw = fprintf( fp, "%-15s  %-18s  %-5s  %-5s  %s%s%s%s\n",
+       ip_str, nam_buf,
+       st_name[ ((want_p->state_old < 0) ? 0 : (want_p->state_old+ 1))],
+       st_name[ ((want_p->state < 0) ? 0 : (want_p->state+ 1))],
+       ((want_p->sw+ want_p->set == 0) ? "none" : ""),
+       ((want_p->sw == 0) ? "" : "switch"),
+       ((want_p->set == 0) ? "" : ((want_p->sw == 0) ? "set" : "+set")),
+       ((want_p->sts == 0) ? "" : "  # FAILED"));
+    }
+    orv_data_p = orv_data_p->next;
+  }
+  if (bw >= 0)
+  {
+    bwt += bw;
+  }
+  else
+  {
+    bwt = -1;
+  }
+  return bwt;   /* Bytes written, total.  If error, then -1. */
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* fprintf_watch(): Display one device state change (watch). */
+
+int fprintf_watch( FILE *fp, orv_data_t *orv_data_p, int state_old)
+{
+  int bw;                               /* Bytes written. */
+  int nam_len;                          /* Device name length. */
+  char nam_buf[ DEV_NAME_LEN+ 3];       /* ">device name<". */
+  char ip_str[ 16];                     /* IP address string. */
+  unsigned int ia4;                     /* IP address (host order). */
+  time_t t1;
+  struct tm stm;
+
+  time( &t1);
+  LOCALTIME_R( &t1, &stm);
+
+  nam_buf[ 0] = '>';
+  dev_name( orv_data_p, &nam_buf[ 1], &nam_len);
+  nam_buf[ nam_len+ 1] = '<';
+  nam_buf[ nam_len+ 2] = '\0';
+  ia4 = ntohl( orv_data_p->ip_addr.s_addr);
+  sprintf( ip_str, "%u.%u.%u.%u",
+   ((ia4/ 0x100/ 0x100/ 0x100)& 0xff), ((ia4/ 0x100/ 0x100)& 0xff),
+   ((ia4/ 0x100)& 0xff), (ia4& 0xff));
+
+  bw = fprintf( fp,
+   "%04d-%02d-%02d:%02d:%02d:%02d  %02x:%02x:%02x:%02x:%02x:%02x  %-15s  "
+   "%s  %s -> %s\n",
+   (stm.tm_year+ 1900), (stm.tm_mon+ 1), stm.tm_mday,
+   stm.tm_hour, stm.tm_min, stm.tm_sec,
+   orv_data_p->mac_addr[ 0], orv_data_p->mac_addr[ 1],
+   orv_data_p->mac_addr[ 2], orv_data_p->mac_addr[ 3],
+   orv_data_p->mac_addr[ 4], orv_data_p->mac_addr[ 5],
+   ip_str, nam_buf,
+   ((state_old == 0) ? "Off" : "On"),
+   ((orv_data_p->state == 0) ? "Off" : "On"));
+  fflush( fp);
+  return bw;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* msg_dump(): Display message data. */
+
+void msg_dump( unsigned char *buf, ssize_t len)
+{
+  ssize_t i;
+  char dmp[ 17];
+
+  for (i = 0; i < len; i++)
+  {
+    fprintf( stderr, " %02x", buf[ i]);
+    if ((buf[ i] >= 32) && (buf[ i] <= 127))
+    {
+      dmp[ i% 16] = buf[ i];
+    }
+    else
+    {
+      dmp[ i% 16] = '.';
+    }
+    if ((i% 16) == 15)
+    {
+      dmp[ (i% 16)+ 1] = '\0';
+      fprintf( stderr, "    >%s<\n", dmp);
+    }
+  }
+
+  if ((i% 16) != 0)
+  {
+    dmp[ (i% 16)] = '\0';
+  }
+
+  for (i = len; i < (ssize_t)((len+ 15)& 0xfffffff0); i++)
+  {
+    fprintf( stderr, "   ");
+  }
+  fprintf( stderr, "    >%s<\n", dmp);
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* fprintf_metrics(): Display run-time counters. */
+
+int fprintf_metrics( FILE *fp)
+{
+  int bw;
+
+  bw = fprintf( fp,
+   " Metrics: msg snd = %u, msg rec = %u, rcv drops = %u, rcvbuf = %d.\n",
+   metrics.msg_snd, metrics.msg_rec, metrics.rcv_drops, metrics.rcvbuf_size);
+  if (bw >= 0)
+  {
+    bw = fprintf( fp,
+     " Metrics: re-queries = %u, re-broadcasts = %u.\n",
+     metrics.requery, metrics.rebcast);
+  }
+  if (bw >= 0)
+  {
+    bw = fprintf( fp,
+     " Metrics: table 4 reads = %u, skipped (index unchanged) = %u.\n",
+     metrics.rt_read, metrics.rt_skip);
+  }
+  if ((bw >= 0) && (max_age >= 0))
+  {
+    bw = fprintf( fp,
+     " Metrics: state cache hits = %u (maxage = %ld ms).\n",
+     metrics.cache_hit, max_age);
+  }
+  if ((bw >= 0) && (metrics.ctl_req > 0))
+  {
+    int i;
+
+    bw = fprintf( fp,
+     " Metrics: daemon requests = %u, performed = %u.\n",
+     metrics.ctl_req, metrics.ctl_done);
+    for (i = 0; (bw >= 0) && (i < PRI_CNT); i++)
+    {
+      if (metrics.pri_cnt[ i] > 0)
+      {
+        bw = fprintf( fp,
+ " Metrics: queue delay (%s) = %lu ms avg, %lu ms max (%u requests).\n",
+         pri_name[ i], (metrics.pri_wait[ i]/ metrics.pri_cnt[ i]),
+         metrics.pri_wait_max[ i], metrics.pri_cnt[ i]);
+      }
+    }
+  }
+  if ((bw >= 0) && (metrics.http_conn > 0))
+  {
+    bw = fprintf( fp,
+     " Metrics: HTTP connections = %u, requests = %u.\n",
+     metrics.http_conn, metrics.http_req);
+  }
+  if ((bw >= 0) && (metrics.ddf_reload > 0))
+  {
+    bw = fprintf( fp,
+     " Metrics: DDF reloads = %u (devices added = %u, removed = %u,"
+     " changed = %u).\n",
+     metrics.ddf_reload, metrics.ddf_add, metrics.ddf_del, metrics.ddf_chg);
+  }
+  if ((bw >= 0) && (metrics.sub_cnt > 0))
+  {
+    bw = fprintf( fp,
+     " Metrics: subscriptions = %u, change records = %u, lost = %u.\n",
+     metrics.sub_cnt, metrics.sub_rec, metrics.sub_lost);
+  }
+  if (bw >= 0)
+  {
+    bw = fprintf( fp, " Metrics: timer writes = %u.\n", metrics.tm_write);
+  }
+  if ((bw >= 0) && (metrics.sw_cnt > 0))
+  {
+    bw = fprintf( fp,
+     " Metrics: switch confirmations = %u, skew (first-last) = %lu ms.\n",
+     metrics.sw_cnt, (metrics.sw_last- metrics.sw_first));
+  }
+  if (bw >= 0)
+  {
+    bw = fprintf( fp, " Metrics: arena = %lu bytes.\n",
+     (unsigned long)arena.total);
+  }
+  return bw;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* hexchr2int(): Convert hex character to int value. */
+
+int hexchr2int( char c)
+{
+  int val = -1;
+
+  if ((c >= '0') && (c <= '9'))
+  {
+    val = c- '0';
+  }
+  else if ((c >= 'A') && (c <= 'F'))
+  {
+    val = c- 'A'+ 10;
+  }
+  else if ((c >= 'a') && (c <= 'f'))
+  {
+    val = c- 'a'+ 10;
+  }
+  return val;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* parse_mac(): Translate "xx:xx:xx:xx:xx:xx" string to byte array. */
+
+int parse_mac( char *str, unsigned char *bytes)
+{
+  int i;
+  int sts = 0;                                  /* Assume success. */
+
+  if (strlen( str) != (MAC_ADDR_SIZE* 3- 1))
+  {
+    sts = -1;                           /* Wrong string length. */
+  }
+  else
+  { /* Allow ":" or "-" as MAC octet separators. */
+    for (i = 0; i < (MAC_ADDR_SIZE- 1); i++)
+    {
+      if ((str[ i* 3+ 2] != ':') && (str[ i* 3+ 2] != '-'))
+      {
+        sts = -2;                       /* Bad separator. */
+        break;
+      }
+    }
+
+    if (sts == 0)
+    {
+      for (i = 0; i < MAC_ADDR_SIZE; i++)
+      {
+        int c0;
+        int c1;
+
+        c1 = hexchr2int( str[ 3* i]);
+        c0 = hexchr2int( str[ 3* i+ 1]);
+
+        if ((c0 < 0) || (c1 < 0))
+        {
+          sts = -3;                     /* Invalid hex digit. */
+          break;
+        }
+        else
+        {
+          bytes[ i] = 16* c1+ c0;
+        }
+      }
+    }
+  }
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* revcpy(): Reverse memcpy(). */
+
+void *revcpy( void *dst, const void *src, size_t siz)
+{
+  size_t i;
+
+  for (i = 0; i < siz; i++)
+  {
+    ((unsigned char *)dst)[ i] = ((unsigned char *)src)[ siz- 1- i];
+  }
+  return dst;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* show_errno(): Display error code(s), message. */
+
+int show_errno( char *prog_name)
+{
+  int sts;
+
+  if (prog_name == NULL)
+  {
+    prog_name = "";
+  }
+
+#ifdef _WIN32
+  sts = fprintf( stderr, "%s: errno = %d, WSAGLA() = %d.\n",
+   prog_name, errno, WSAGetLastError());
+#else /* def _WIN32 */
+# ifdef VMS
+  sts = fprintf( stderr, "%s: errno = %d, vaxc$errno = %08x.\n",
+   prog_name, errno, vaxc$errno);
+# else /* def VMS */
+  sts = fprintf( stderr, "%s: errno = %d.\n", prog_name, errno);
+# endif /* def VMS [else] */
+#endif /* def _WIN32 [else]*/
+
+  if (sts >= 0)
+  {
+    fprintf( stderr, "%s: %s\n", prog_name, strerror( errno));
+  }
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* dns_resolve(): Resolve DNS name to IPv4 address using getaddrinfo(). */
+
+int dns_resolve( char *name, struct in_addr *ip_addr)
+{
+  int sts;
+  struct addrinfo *ai_pp;       /* addrinfo() result (linked list). */
+  struct addrinfo ai_h;         /* addrinfo() hints. */
+
+  /* Fill getaddrinfo() hints structure. */
+  memset( &ai_h, 0, sizeof( ai_h));
+  ai_h.ai_family = AF_INET;
+  ai_h.ai_protocol = IPPROTO_UDP;
+
+  sts = getaddrinfo( name,              /* Node name. */
+                     NULL,              /* Service name. */
+                     &ai_h,             /* Hints. */
+                     &ai_pp);           /* Results (linked list). */
+
+  if (sts != 0)
+  {
+    if ((debug& DBG_DNS) != 0)
+    {
+      fprintf( stderr, " getaddrinfo() failed.\n");
+    }
+  }
+  else
+  { /* Use the first result in the ai_pp linked list. */
+    if ((debug& DBG_DNS) != 0)
+    {
+      fprintf( stderr, " getaddrinfo():\n");
+      fprintf( stderr,
+       " ai_family = %d, ai_socktype = %d, ai_protocol = %d\n",
+       ai_pp->ai_family, ai_pp->ai_socktype, ai_pp->ai_protocol);
+
+      fprintf( stderr,
+       " ai_addrlen = %d, ai_addr->sa_family = %d.\n",
+       ai_pp->ai_addrlen, ai_pp->ai_addr->sa_family);
+
+      fprintf( stderr,
+       " ai_flags = 0x%08x.\n", ai_pp->ai_flags);
+
+      if (ai_pp->ai_addr->sa_family == AF_INET)
+      {
+        fprintf( stderr, " ai_addr->sa_data[ 2: 5] = %u.%u.%u.%u\n",
+         (unsigned char)ai_pp->ai_addr->sa_data[ 2],
+         (unsigned char)ai_pp->ai_addr->sa_data[ 3],
+         (unsigned char)ai_pp->ai_addr->sa_data[ 4],
+         (unsigned char)ai_pp->ai_addr->sa_data[ 5]);
+      }
+    }
+
+#ifndef NO_AF_CHECK     /* Disable the address-family check everywhere. */
+    {
+# if defined( VMS) && defined( VAX) && !defined( GETADDRINFO_OK)
+      /* Work around apparent bug in getaddrinfo() in TCPIP V5.3 - ECO 4
+       * on VMS V7.3 (typical hobbyist kit?).  sa_family seems to be
+       * misplaced, misaligned, corrupted.  Spurious sa_len?
+       */
+      int sa_fam;
+#  define SA_FAMILY sa_fam
+
+      if (ai_pp->ai_addr->sa_family != AF_INET)
+      {
+        if ((debug& DBG_DNS) != 0)
+        {
+          fprintf( stderr,
+           " Unexpected address family (not %d, V-V work-around): %d.\n",
+           AF_INET, ai_pp->ai_addr->sa_family);
+        }
+        SA_FAMILY = ai_pp->ai_addr->sa_family/ 256;     /* Try offset. */
+      }
+# else /* defined( VMS) && defined( VAX) && !defined( GETADDRINFO_OK) */
+#  define SA_FAMILY ai_pp->ai_addr->sa_family
+# endif /* defined( VMS) && defined( VAX) && !defined( GETADDRINFO_OK) [else] */
+
+      if (SA_FAMILY != AF_INET)
+      { /* Complain about (original) bad value. */
+        fprintf( stderr, "%s: Unexpected address family (not %d): %d.\n",
+         PROGRAM_NAME, AF_INET, ai_pp->ai_addr->sa_family);
+        sts = -1;
+      }
+    }
+#endif /* ndef NO_AF_CHECK */
+
+    if ((sts == 0) && (ip_addr != NULL))
+    { /* IPv4 address (net order). */
+      memcpy( ip_addr, &ai_pp->ai_addr->sa_data[ 2], sizeof( *ip_addr));
+    }
+    freeaddrinfo( ai_pp);
+  }
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* set_socket_noblock(): Set socket to non-blocking. */
+
+int set_socket_noblock( int sock)
+{
+#ifdef USE_FCNTL                        /* Use fcntl(). */
+
+  int fc_flgs;
+  int sts = 0;                                  /* Assume success. */
+
+  fc_flgs = fcntl( sock, F_GETFL, 0);           /* Get current flags. */
+
+  if ((debug& DBG_SIO) != 0)
+  {
+    fprintf( stderr, " fcntl(0).  Sock = %d, flgs = %08x .\n",
+     sock, fc_flgs);
+  }
+
+  if (fc_flgs != -1)
+  {
+    fc_flgs |= O_NONBLOCK;                      /* OR-in O_NONBLOCK. */
+
+    if ((debug& DBG_SIO) != 0)
+    {
+      fprintf( stderr, " fcntl(1). flgs = %08x .\n", fc_flgs);
+    }
+
+    fc_flgs = fcntl( sock, F_SETFL, fc_flgs);   /* Set revised flags.*/
+
+    if ((debug& DBG_SIO) != 0)
+    {
+      fprintf( stderr, " fcntl(2). flgs = %08x .\n", fc_flgs);
+    }
+  }
+
+  if (fc_flgs == -1)
+  {
+    fprintf( stderr, "%s: fcntl(noblock) failed.  sock = %d.\n",
+     PROGRAM_NAME, sock);
+    show_errno( PROGRAM_NAME);
+    sts = -1;
+  }
+
+#else /* def USE_FCNTL */               /* Use ioctl(). */
+
+  int ioctl_tmp;
+  int sts;
+
+  ioctl_tmp = 1;
+  sts = IOCTL_SOCKET( sock, FIONBIO, &ioctl_tmp);       /* Set FIONBIO. */
+
+  if ((debug& DBG_SIO) != 0)
+  {
+    fprintf( stderr, " ioctl() sts = %d, tmp = %08x .\n",
+     sts, ioctl_tmp);
+  }
+
+  if (sts < 0)
+  {
+    fprintf( stderr, "%s: ioctl() failed.  sock = %d, sts = %d.\n",
+     PROGRAM_NAME, sock, sts);
+    show_errno( PROGRAM_NAME);
+  }
+
+#endif /* def USE_FCNTL [else] */
+
+  return sts;                                   /* -1, if error. */
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* set_socket_rcvbuf(): Size the socket receive buffer for dev_cnt
+ *                      responses (if dev_cnt > 0), and enable kernel
+ *                      drop counting (SO_RXQ_OVFL), where available.
+ *                      Failures here are not fatal.
+ */
+
+int set_socket_rcvbuf( SOCKET sock, int dev_cnt)
+{
+  int sts = 0;
+
+  if (dev_cnt > 0)
+  {
+    int rcvbuf;
+    RECVFROM_6 opt_len;
+
+    rcvbuf = dev_cnt* RCVBUF_DEV_SIZE;
+    sts = setsockopt( sock,                             /* Socket. */
+                      SOL_SOCKET,                       /* Level. */
+                      SO_RCVBUF,                        /* Option name. */
+                      (char *)&rcvbuf,                  /* Option value. */
+                      sizeof( rcvbuf));                 /* Option length. */
+    if (sts < 0)
+    {
+      fprintf( stderr, "%s: setsockopt( rcvbuf) failed.\n", PROGRAM_NAME);
+      show_errno( PROGRAM_NAME);
+    }
+
+    /* Record the size actually granted.  (The system may adjust it.) */
+    opt_len = sizeof( rcvbuf);
+    if (getsockopt( sock, SOL_SOCKET, SO_RCVBUF,
+     (char *)&rcvbuf, &opt_len) == 0)
+    {
+      metrics.rcvbuf_size = rcvbuf;
+    }
+
+    if ((debug& DBG_SIO) != 0)
+    {
+      fprintf( stderr,
+       " setsockopt( rcvbuf) sts = %d, devs = %d, siz = %d.\n",
+       sts, dev_cnt, rcvbuf);
+    }
+  }
+
+#ifdef USE_RXQ_OVFL
+  {
+    int sts2;
+    unsigned int sock_opt_ovf = 1;
+
+    sts2 = setsockopt( sock,                            /* Socket. */
+                       SOL_SOCKET,                      /* Level. */
+                       SO_RXQ_OVFL,                     /* Option name. */
+                       &sock_opt_ovf,                   /* Option value. */
+                       sizeof( sock_opt_ovf));          /* Option length. */
+
+    if ((debug& DBG_SIO) != 0)
+    {
+      fprintf( stderr, " setsockopt( rxq_ovfl) sts = %d.\n", sts2);
+    }
+  }
+#endif /* def USE_RXQ_OVFL */
+
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* recv_msg(): Receive a datagram.
+ *             Where SO_RXQ_OVFL is available, use recvmsg(), and store
+ *             the socket's (cumulative) kernel drop count in *drops_p.
+ */
+
+ssize_t recv_msg( SOCKET sock,                  /* Socket. */
+                  unsigned char *buf,           /* Receive buffer. */
+                  size_t siz,                   /* Receive buffer size. */
+                  struct sockaddr_in *addr_p,   /* Sender address. */
+                  unsigned int *drops_p)        /* Drop count (cumulative). */
+{
+  ssize_t bc;
+
+#ifdef USE_RXQ_OVFL
+
+  struct cmsghdr *cmsg_p;
+  struct iovec iov;
+  struct msghdr msg;
+  union
+  {
+    struct cmsghdr align;                       /* Force alignment. */
+    char buf[ CMSG_SPACE( sizeof( unsigned int))];
+  } cmsg_buf;
+
+  iov.iov_base = buf;
+  iov.iov_len = siz;
+  memset( &msg, 0, sizeof( msg));
+  msg.msg_name = addr_p;
+  msg.msg_namelen = sizeof( *addr_p);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = cmsg_buf.buf;
+  msg.msg_controllen = sizeof( cmsg_buf.buf);
+
+  bc = recvmsg( sock, &msg, 0);
+  if (bc >= 0)
+  {
+    for (cmsg_p = CMSG_FIRSTHDR( &msg);
+     cmsg_p != NULL;
+     cmsg_p = CMSG_NXTHDR( &msg, cmsg_p))
+    {
+      if ((cmsg_p->cmsg_level == SOL_SOCKET) &&
+       (cmsg_p->cmsg_type == SO_RXQ_OVFL))
+      {
+        memcpy( drops_p, CMSG_DATA( cmsg_p), sizeof( *drops_p));
+      }
+    }
+  }
+
+#else /* def USE_RXQ_OVFL */
+
+  RECVFROM_6 sock_addr_len;
+
+  sock_addr_len = sizeof( *addr_p);             /* Socket addr len. */
+  bc = recvfrom( sock,
+                 buf,
+                 siz,
+                 0,                             /* Flags (not OOB or PEEK). */
+                 (struct sockaddr *)addr_p,     /* Socket address. */
+                 &sock_addr_len);               /* Socket address length. */
+
+#endif /* def USE_RXQ_OVFL [else] */
+
+  if (bc >= 0)
+  {
+    metrics.msg_rec++;
+  }
+  return bc;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#ifdef VMS
+# ifndef NO_OPER_PRIVILEGE
+
+/* set_priv_oper(): Try to set OPER privilege according to oper_new.
+ *                  Set *oper_old_p to old value.
+ */
+
+int set_priv_oper( int oper_new, int *oper_old_p)
+{
+  int sts;
+  union prvdef priv_mask_old = { 0 };   /*  Privilege masks. */
+  union prvdef priv_mask_new = { 0 };
+
+  oper_new = (oper_new == 0 ? 0 : 1);   /* Ensure 0/1 flag value. */
+  priv_mask_new.prv$v_oper = 1;         /* OPER privilege mask bit. */
+  sts = sys$setprv( oper_new,           /* Enable/disable privileges. */
+                    &priv_mask_new,     /* New privilege mask. */
+                    0,                  /* Not permanent. */
+                    &priv_mask_old);    /* Previous privilege mask. */
+
+  if (sts == SS$_NORMAL)
+  {
+    sts = 0;
+    if (oper_old_p != NULL)
+    {
+      *oper_old_p = priv_mask_old.prv$v_oper;
+    }
+  }
+  else
+  {
+    errno = EVMSERR;
+    vaxc$errno = sts;
+  }
+  return sts;
+}
+
+# endif /* ndef NO_OPER_PRIVILEGE */
+#endif /* def VMS */
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* msg_len_set(): Insert message length into message. */
+
+void msg_len_set( unsigned char *msg, size_t msg_len)
+{
+  msg[ 2] = (unsigned short)msg_len/ 256;
+  msg[ 3] = (unsigned short)msg_len% 256;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* msg_tpl_render(): Render (once) all the output messages for one
+ *                   device into its template block, with its MAC
+ *                   address(es) and the message lengths in place.
+ */
+
+void msg_tpl_render( orv_data_t *orv_data_p)
+{
+  orv_msg_tpl_t *tpl_p;
+  unsigned char *mac_addr;
+
+  tpl_p = &orv_data_p->tpl;
+  mac_addr = orv_data_p->mac_addr;
+
+  memcpy( tpl_p->heartbeat, cmd_heartbeat, MSG_LEN_HEARTBEAT);
+  memcpy( (tpl_p->heartbeat+ 6), mac_addr, MAC_ADDR_SIZE);
+  msg_len_set( tpl_p->heartbeat, MSG_LEN_HEARTBEAT);
+
+  memcpy( tpl_p->read_table, cmd_read_table, MSG_LEN_READ_TABLE);
+  memcpy( (tpl_p->read_table+ 6), mac_addr, MAC_ADDR_SIZE);
+  tpl_p->read_table[ READ_TABLE_TABLE] = 0x04;  /* Table 4, */
+  tpl_p->read_table[ READ_TABLE_VERSION] = 0x00;        /* version 0. */
+  msg_len_set( tpl_p->read_table, MSG_LEN_READ_TABLE);
+
+  memcpy( tpl_p->read_index, tpl_p->read_table, MSG_LEN_READ_TABLE);
+  tpl_p->read_index[ READ_TABLE_TABLE] = 0x01;  /* Table 1. */
+
+  memcpy( tpl_p->read_timing, tpl_p->read_table, MSG_LEN_READ_TABLE);
+  tpl_p->read_timing[ READ_TABLE_TABLE] = 0x03; /* Table 3. */
+
+  memcpy( tpl_p->subs, cmd_subs, MSG_LEN_SUBS);
+  memcpy( (tpl_p->subs+ 6), mac_addr, MAC_ADDR_SIZE);   /* MAC addr. */
+  revcpy( (tpl_p->subs+ 18), mac_addr, MAC_ADDR_SIZE);  /* MAC (rv). */
+  msg_len_set( tpl_p->subs, MSG_LEN_SUBS);
+
+  memcpy( tpl_p->switch_off, cmd_switch, MSG_LEN_SWITCH);
+  memcpy( (tpl_p->switch_off+ 6), mac_addr, MAC_ADDR_SIZE);
+  tpl_p->switch_off[ 22] = 0;
+  msg_len_set( tpl_p->switch_off, MSG_LEN_SWITCH);
+
+  memcpy( tpl_p->switch_on, tpl_p->switch_off, MSG_LEN_SWITCH);
+  tpl_p->switch_on[ 22] = 1;
+
+  memcpy( tpl_p->unit_disc, cmd_unit_disc, MSG_LEN_UNIT_DISC);
+  memcpy( (tpl_p->unit_disc+ 6), mac_addr, MAC_ADDR_SIZE);
+  msg_len_set( tpl_p->unit_disc, MSG_LEN_UNIT_DISC);
+
+  tpl_p->ok = 1;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* form_msg_out(): Form an output message.
+ *                 Point *msg_out to the pre-rendered message for this
+ *                 task_nr in the target's template block (rendering
+ *                 the templates on first use).  No storage is
+ *                 allocated, and nothing need be freed.
+ */
+
+size_t form_msg_out( int task_nr,
+                     unsigned char **msg_out,
+                     orv_data_t *target_p)
+{
+  size_t msg_out_len = 0;
+  char *str = "";
+  orv_msg_tpl_t *tpl_p = NULL;
+
+  /* TSK_WT_SOCKET uses modified "rt" data from device, and
+   * TSK_WT_TIMING uses a timer record message (timer_write()), not a
+   * message created here.
+   */
+
+  if ((task_nr >= TSK_MIN) && (task_nr <= TSK_MAX))
+  {
+    if ((task_nr == TSK_GLOB_DISC_B) || (task_nr == TSK_GLOB_DISC))
+    { /* Global discovery.  (No device data.) */
+      str = "GLOB DISC";
+      msg_out_len = sizeof( cmd_glob_disc);
+      msg_len_set( cmd_glob_disc, msg_out_len);
+      *msg_out = cmd_glob_disc;
+    }
+    else if (target_p != NULL)
+    {
+      tpl_p = &target_p->tpl;
+      if (tpl_p->ok == 0)
+      {
+        msg_tpl_render( target_p);
+      }
+    }
+  }
+
+  if (tpl_p != NULL)
+  {
+    if (task_nr == TSK_UNIT_DISC)
+    { /* Unit discovery. */
+      str = "UNIT DISC";
+      *msg_out = tpl_p->unit_disc;
+      msg_out_len = MSG_LEN_UNIT_DISC;
     }
     else if (task_nr == TSK_HEARTBEAT)
     { /* Heartbeat. */
       str = "HEARTBEAT";
-      *msg_out = malloc( sizeof( cmd_heartbeat));
-      if (*msg_out != NULL)
+      *msg_out = tpl_p->heartbeat;
+      msg_out_len = MSG_LEN_HEARTBEAT;
+    }
+    else if (task_nr == TSK_SUBSCRIBE)
+    { /* Subscribe. */
+      str = "SUBSCRIBE";
+      *msg_out = tpl_p->subs;
+      msg_out_len = MSG_LEN_SUBS;
+    }
+    else if (task_nr == TSK_SW_OFF)
+    { /* Switch off. */
+      str = "SWITCH OFF";
+      *msg_out = tpl_p->switch_off;
+      msg_out_len = MSG_LEN_SWITCH;
+    }
+    else if (task_nr == TSK_SW_ON)
+    { /* Switch on. */
+      str = "SWITCH ON";
+      *msg_out = tpl_p->switch_on;
+      msg_out_len = MSG_LEN_SWITCH;
+    }
+    else if (task_nr == TSK_RT_SOCKET)
+    { /* Read socket data (table 4). */
+      str = "RT-SOCKET";
+      *msg_out = tpl_p->read_table;
+      msg_out_len = MSG_LEN_READ_TABLE;
+    }
+    else if (task_nr == TSK_RT_TIMING)
+    { /* Read timing data (table 3). */
+      str = "RT-TIMING";
+      *msg_out = tpl_p->read_timing;
+      msg_out_len = MSG_LEN_READ_TABLE;
+    }
+    else if (task_nr == TSK_RT_INDEX)
+    { /* Read table index (table 1). */
+      str = "RT-INDEX";
+      *msg_out = tpl_p->read_index;
+      msg_out_len = MSG_LEN_READ_TABLE;
+    }
+  }
+
+  if ((debug& DBG_MSO) != 0)
+  {
+    if (msg_out_len > 0)
+    {
+      fprintf( stderr, " >> %s\n", str);
+      fprintf( stderr, " msg_len = %ld.\n", msg_out_len);
+      fprintf( stderr, " [2], [3] = %02x %02x\n",
+       (*msg_out)[ 2], (*msg_out)[ 3]);
+
+      /* Display message to be sent. */
+      if (msg_out_len >= 6)
+      {
+        fprintf( stderr, "   Snd (%3ld)  %c  %c\n",
+         msg_out_len, (*msg_out)[ 4], (*msg_out)[ 5]);
+      }
+      msg_dump( *msg_out, msg_out_len);
+    }
+  }
+  return msg_out_len;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* rsp_fld_show(): Display one decoded response field (DBG_MSI). */
+
+void rsp_fld_show( const orv_fld_t *fld_p, orv_rsp_t *rsp_p)
+{
+  unsigned char *dst;
+  unsigned int val = 0;
+
+  dst = (unsigned char *)rsp_p+ fld_p->dst;
+  if ((fld_p->enc == FLE_LE) || (fld_p->enc == FLE_BE))
+  {
+    memcpy( &val, dst, sizeof( val));
+  }
+
+  if (fld_p->fmt == FMT_DEC)
+  {
+    fprintf( stderr, " %s: %u (0x%04x)\n", fld_p->label, val, val);
+  }
+  else if (fld_p->fmt == FMT_HEX)
+  {
+    fprintf( stderr, " %s: 0x%08x\n", fld_p->label, val);
+  }
+  else if (fld_p->fmt == FMT_IP)
+  {
+    fprintf( stderr, " %s: 0x%08x %u.%u.%u.%u\n", fld_p->label, val,
+     ((val/ 0x100/ 0x100/ 0x100)& 0xff), ((val/ 0x100/ 0x100)& 0xff),
+     ((val/ 0x100)& 0xff), (val& 0xff));
+  }
+  else if (fld_p->fmt == FMT_MAC)
+  {
+    fprintf( stderr, " %s: %02x:%02x:%02x:%02x:%02x:%02x\n",
+     fld_p->label, dst[ 0], dst[ 1], dst[ 2], dst[ 3], dst[ 4], dst[ 5]);
+  }
+  else if (fld_p->fmt == FMT_S8)
+  {
+    fprintf( stderr, " %s: %d (0x%02x)\n",
+     fld_p->label, (signed char)val, val);
+  }
+  else if (fld_p->fmt == FMT_STR)
+  {
+    fprintf( stderr, " %s: >%s<\n", fld_p->label, (char *)dst);
+  }
+  else if (fld_p->fmt == FMT_TIME)
+  {
+    time_t time_dev;
+
+    fprintf( stderr, " %s: %u (0x%08x)\n", fld_p->label, val, val);
+    time_dev = (time_t)val- TIME_OFS;                   /* 1970 - 1900. */
+    fprintf( stderr, " ctime(adj) = %s",                /* No '\n'. */
+     ctime( &time_dev));
+  }
+  else if (fld_p->fmt == FMT_TYPE)
+  {
+    char device_type[ 12];
+
+    type_name( (short)val, device_type);
+    fprintf( stderr, " %s: %d  (%s)\n",
+     fld_p->label, (short)val, device_type);
+  }
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* rsp_layout_decode(): Decode the fields of one layout (those which fit
+ *                      in the message) into the orv_rsp_t record.
+ */
+
+void rsp_layout_decode( unsigned char *msg_inp,         /* Message. */
+                        ssize_t bc,                     /* Message length. */
+                        const orv_layout_t *lay_p,      /* Layout. */
+                        orv_rsp_t *rsp_p)               /* Decoded data. */
+{
+  int i;
+  int j;
+  unsigned char *dst;
+  unsigned int val;
+  const orv_fld_t *fld_p;
+
+  for (i = 0; i < lay_p->fld_cnt; i++)
+  {
+    fld_p = &lay_p->fld[ i];
+    if (bc < fld_p->ofs+ fld_p->len)
+    {
+      continue;                         /* Message too short. */
+    }
+
+    dst = (unsigned char *)rsp_p+ fld_p->dst;
+    if (fld_p->enc == FLE_LE)
+    {
+      val = 0;
+      for (j = fld_p->len- 1; j >= 0; j--)
+      {
+        val = val* 256+ msg_inp[ fld_p->ofs+ j];
+      }
+      memcpy( dst, &val, sizeof( val));
+    }
+    else if (fld_p->enc == FLE_BE)
+    {
+      val = 0;
+      for (j = 0; j < fld_p->len; j++)
+      {
+        val = val* 256+ msg_inp[ fld_p->ofs+ j];
+      }
+      memcpy( dst, &val, sizeof( val));
+    }
+    else
+    { /* FLE_BYTES, FLE_STR. */
+      memcpy( dst, &msg_inp[ fld_p->ofs], fld_p->len);
+      if (fld_p->enc == FLE_STR)
+      {
+        dst[ fld_p->len] = '\0';
+      }
+    }
+    rsp_p->have |= (1U<< fld_p->fld);
+
+    if (((debug& DBG_MSI) != 0) && (fld_p->fmt != FMT_NONE))
+    {
+      rsp_fld_show( fld_p, rsp_p);
+    }
+  }
+
+  /* Claim the response type and good data, if the key fields exist. */
+  if ((lay_p->rsp_fld == FLD_NONE) || RSP_HAVE( rsp_p, lay_p->rsp_fld))
+  {
+    rsp_p->rsp = lay_p->rsp;
+  }
+  if ((lay_p->save_fld != FLD_NONE) && RSP_HAVE( rsp_p, lay_p->save_fld))
+  {
+    rsp_p->save = lay_p->rsp;
+  }
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* msg_decode(): Decode a response message, in one bounds-checked pass,
+ *               according to its layout in rsp_layout[] (and, for "rt",
+ *               the layout for its table number).
+ *               Return the response type bit (RSP_xxx), or zero.
+ */
+
+int msg_decode( unsigned char *msg_inp,         /* Message. */
+                ssize_t bc,                     /* Message length. */
+                orv_rsp_t *rsp_p)               /* Decoded data. */
+{
+  unsigned int i;
+  const orv_layout_t *lay_p = NULL;
+
+  memset( rsp_p, 0, sizeof( *rsp_p));
+
+  if (bc >= 6)
+  {
+    for (i = 0; i < RSP_LAYOUT_CNT; i++)
+    {
+      if ((rsp_layout[ i].tbl < 0) &&
+       (rsp_layout[ i].op[ 0] == msg_inp[ 4]) &&
+       (rsp_layout[ i].op[ 1] == msg_inp[ 5]))
+      {
+        lay_p = &rsp_layout[ i];
+        break;
+      }
+    }
+
+    if (lay_p == NULL)
+    { /* Unknown. */
+      rsp_p->rsp = RSP___;
+      if ((debug& DBG_MSI) != 0)
+      {
+        fprintf( stderr,
+         " Unexpected response: \"%c%c\" (%.1x%.1x).\n",
+         msg_inp[ 4], msg_inp[ 5], msg_inp[ 4], msg_inp[ 5]);
+      }
+    }
+    else
+    {
+      rsp_layout_decode( msg_inp, bc, lay_p, rsp_p);
+
+      if (RSP_HAVE( rsp_p, FLD_TABLE_NR))
+      { /* Table-specific layout ("rt"). */
+        for (i = 0; i < RSP_LAYOUT_CNT; i++)
+        {
+          if ((rsp_layout[ i].tbl == (int)rsp_p->table_nr) &&
+           (rsp_layout[ i].op[ 0] == msg_inp[ 4]) &&
+           (rsp_layout[ i].op[ 1] == msg_inp[ 5]))
+          {
+            rsp_layout_decode( msg_inp, bc, &rsp_layout[ i], rsp_p);
+            break;
+          }
+        }
+      }
+    }
+  }
+  return rsp_p->rsp;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* msg_process(): Process one received message: Identify the response
+ *                type, extract any useful data, and update (or create)
+ *                the corresponding orv_data LL member, which is stored
+ *                in *orv_data_pp (NULL, if none).
+ *                Return the response type bit (RSP_xxx), or zero.
+ */
+
+int msg_process( orv_rbuf_t *rbuf_p,           /* Message (buffer). */
+                 struct sockaddr_in *sock_addr_rec_p,   /* Sender addr. */
+                 orv_tbl_t *tbl_p,              /* Table data. */
+                 orv_data_t *origin_p,          /* orv_data origin. */
+                 orv_data_t **orv_data_pp)      /* orv_data member. */
+{
+  int rsp_msg;                  /* Response type (this message). */
+  orv_rsp_t rsp;                /* Decoded response. */
+  unsigned char *msg_inp;       /* Message. */
+  ssize_t bc;                   /* Message length. */
+
+  orv_data_t *orv_data_p = NULL;
+
+  msg_inp = rbuf_p->data;
+  bc = rbuf_p->len;
+
+  if ((debug& DBG_SIO) != 0)
+  {
+    if (sock_addr_rec_p->sin_family == AF_INET)
+    {
+      unsigned int ia4;
+
+      fprintf( stderr, " s_addr: %08x .\n",
+       sock_addr_rec_p->sin_addr.s_addr);
+
+      ia4 = ntohl( sock_addr_rec_p->sin_addr.s_addr);
+      fprintf( stderr, " recvfrom(n) addr: %u.%u.%u.%u\n",
+       ((ia4/ 0x100/ 0x100/ 0x100)& 0xff),
+       ((ia4/ 0x100/ 0x100)& 0xff),
+       ((ia4/ 0x100)& 0xff),
+       (ia4& 0xff));
+    }
+  }
+
+  if ((debug& DBG_MSI) != 0)
+  {
+    /* Display the response (hex, ASCII). */
+
+    if (bc >= 6)
+    {
+      fprintf( stderr, "   Rec (%3ld)  %c  %c\n",
+       bc, msg_inp[ 4], msg_inp[ 5]);
+    }
+
+    msg_dump( msg_inp, bc);
+  }
+
+  /* Decode the message.  (Find MAC.  Determine Off/On state, if known.) */
+  rsp_msg = msg_decode( msg_inp, bc, &rsp);
+
+  if (rsp_msg == RSP_RT)
+  {
+    /* If caller wants them, then keep (a reference to) the receive
+     * buffer, and tell caller where to find it.  (Size is stored in
+     * the data.)
+     */
+    if (tbl_p != NULL)
+    {
+      if (tbl_p->rbuf == NULL)                  /* First time. */
+      {
+        unsigned short msg_len;                 /* Embedded msg len. */
+
+        msg_len = (unsigned short)msg_inp[ 2]* 256+
+                  (unsigned short)msg_inp[ 3];
+
+        if (bc != msg_len)
+        {
+          fprintf( stderr,
+           "%s: Unexpected message length.  bc = %ld, m_l = %d.\n",
+           PROGRAM_NAME, bc, msg_len);
+        }
+        else
+        {
+          rbuf_hold( rbuf_p);
+          tbl_p->rbuf = rbuf_p;
+        }
+      }
+    }
+  }
+
+  if ((debug& DBG_MSI) != 0)
+  {
+    if (RSP_HAVE( &rsp, FLD_STATE_OLD) || RSP_HAVE( &rsp, FLD_STATE_NEW))
+    {
+      char state_new_str[ 16];
+      char state_old_str[ 16];
+
+      sprintf( state_new_str, "%2.2x", rsp.state_new);
+      sprintf( state_old_str, "%2.2x", rsp.state_old);
+
+      fprintf( stderr, "   States: old = %s, new = %s.\n",
+       (RSP_HAVE( &rsp, FLD_STATE_OLD) ? state_old_str : "??"),
+       (RSP_HAVE( &rsp, FLD_STATE_NEW) ? state_new_str : "??"));
+    }
+
+    if (RSP_HAVE( &rsp, FLD_MAC))
+    {
+      fprintf( stderr, "   MAC addr: %02x:%02x:%02x:%02x:%02x:%02x\n",
+       rsp.mac_addr[ 0], rsp.mac_addr[ 1], rsp.mac_addr[ 2],
+       rsp.mac_addr[ 3], rsp.mac_addr[ 4], rsp.mac_addr[ 5]);
+    }
+  }
+
+  if ((rsp.save > 0) && RSP_HAVE( &rsp, FLD_MAC))
+  {
+    orv_data_p = orv_data_find_mac( origin_p, rsp.mac_addr);
+
+    if ((debug& DBG_MSI) != 0)
+    {
+      fprintf( stderr, " s_o_d = %d, o_f_d_m() = %sNULL.\n",
+       rsp.save, ((orv_data_p == NULL)  ? "" : "non-"));
+    }
+
+    if (orv_data_p == NULL)
+    {
+      orv_data_p = orv_data_new( origin_p,
+       ((origin_p->sort_key == SRT_IP) ?
+       (void *)&sock_addr_rec_p->sin_addr :                /* IP address. */
+       (void *)rsp.mac_addr));                          /* MAC address. */
+
+      if (orv_data_p == NULL)
+      {
+        fprintf( stderr, "%s: malloc() failed [1].\n", PROGRAM_NAME);
+      }
+      else
+      {
+        memcpy( orv_data_p->mac_addr, rsp.mac_addr, MAC_ADDR_SIZE);
+        orv_data_p->ip_addr.s_addr = sock_addr_rec_p->sin_addr.s_addr;
+        orv_data_p->pend = origin_p->pend;      /* Origin: New pending? */
+      }
+    }
+    if ((orv_data_p != NULL) && (rsp.save == RSP_RT))
+    { /* Have Read Table (detailed) data.  Keep the whole record. */
+      memcpy( orv_data_p->passwd, rsp.passwd, PASSWORD_LEN);
+      memcpy( orv_data_p->name, rsp.name, DEV_NAME_LEN);
+      orv_data_p->type = (short)rsp.type;
+      orv_data_p->port = rsp.server_port;
+      orv_data_p->rt4 = rsp;
+    }
+    if (orv_data_p != NULL)
+    {
+      int state_old;
+
+      state_old = orv_data_p->state;
+      orv_data_p->seen = 1;             /* Responded (this round). */
+      if (orv_data_p->t_sent != 0)
+      { /* Response to a unicast message.  Record the round-trip time. */
+        orv_data_p->rtt_ms = (unsigned int)(ms_time()- orv_data_p->t_sent);
+        orv_data_p->t_sent = 0;
+      }
+      if (rsp_msg == RSP_CL)
+      { /* Subscription confirmed. */
+        orv_data_p->sub_t = wall_time();
+      }
+      if (RSP_HAVE( &rsp, FLD_STATE_NEW))
+      {
+        orv_data_p->state = rsp.state_new;
+      }
+      else if (RSP_HAVE( &rsp, FLD_STATE_OLD))
+      {
+        orv_data_p->state = rsp.state_old;
+      }
+      if (RSP_HAVE( &rsp, FLD_STATE_NEW) || RSP_HAVE( &rsp, FLD_STATE_OLD))
+      { /* Record when and how the state was seen (state cache). */
+        orv_data_p->state_src = rsp_msg;
+        orv_data_p->state_t = wall_time();
+      }
+      if ((watch_fp != NULL) && (orv_data_p->cnt_flg != 0) &&
+       (state_old >= 0) && (orv_data_p->state != state_old))
+      { /* Watched device changed state.  Report it. */
+        fprintf_watch( watch_fp, orv_data_p, state_old);
+      }
+    }
+  }
+
+  else if (RSP_HAVE( &rsp, FLD_MAC))
+  { /* No data to save, but identify the responding device. */
+    orv_data_p = orv_data_find_mac( origin_p, rsp.mac_addr);
+  }
+
+  if ((rsp_msg == RSP_RT) && (orv_data_p != NULL) &&
+   (orv_data_p->sched != NULL) && (orv_data_p->rt3 == NULL) &&
+   RSP_HAVE( &rsp, FLD_TABLE_NR) && (rsp.table_nr == 3))
+  { /* Keep a (schedule) device's timing table response. */
+    rbuf_hold( rbuf_p);
+    orv_data_p->rt3 = rbuf_p;
+  }
+
+  *orv_data_pp = orv_data_p;
+  return rsp_msg;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* task_sock_open(): Create, configure, and bind a device socket.
+ *                   (Daemon: With an inherited device socket, use a
+ *                   copy of that, already bound and configured.)
+ *                   Return INVALID_SOCKET, if error.
+ */
+
+SOCKET task_sock_open( int bcast,               /* Broadcast flag. */
+                       int rcv_devs)            /* Expected responses. */
+{
+  SOCKET sock_orv;              /* Orvibo device socket. */
+  int inh = 0;                  /* Inherited (already bound). */
+  int sts;                      /* Status. */
+  struct sockaddr_in sock_addr_rec;
+#ifdef EARLY_RECVFROM
+  ssize_t bc;                   /* Byte count (receive). */
+  unsigned char msg_inp[ 1024]; /* Receive message buffer. */
+  RECVFROM_6 sock_addr_len_rec;
+#endif /* def EARLY_RECVFROM */
+
+  /* Fill receive socket addr structure. */
+  memset( &sock_addr_rec, 0, sizeof( sock_addr_rec));
+  sock_addr_rec.sin_family      = AF_INET;
+  sock_addr_rec.sin_port        = htons( PORT_ORV);
+  sock_addr_rec.sin_addr.s_addr = htons( INADDR_ANY);
+
+#ifdef USE_DAEMON
+  if (!BAD_SOCKET( sock_orv_inh))
+  { /* Inherited device socket (socket activation). */
+    inh = 1;
+    sock_orv = dup( sock_orv_inh);
+  }
+  else
+#endif /* def USE_DAEMON */
+  sock_orv = socket( AF_INET,                   /* Address family. */
+                     SOCK_DGRAM,                /* Type. */
+                     IPPROTO_UDP);              /* Protocol. */
+
+  if ((debug& DBG_SIO) != 0)
+  {
+    fprintf( stderr, " sock_orv = %d.\n", sock_orv);
+  }
+
+  if (BAD_SOCKET( sock_orv))
+  {
+    fprintf( stderr, "%s: socket() failed.\n", PROGRAM_NAME);
+    show_errno( PROGRAM_NAME);
+    sts = -1;
+  }
+  else if (inh != 0)
+  {
+    sts = 0;                    /* (Already configured, bound.) */
+  }
+  else
+  {
+#ifdef _WIN32
+    char sock_opt_rec = 1;
+#else /* def _WIN32 */
+    unsigned int sock_opt_rec = 1;
+#endif /* def _WIN32 [else] */
+
+    sts = setsockopt( sock_orv,                         /* Socket. */
+                      SOL_SOCKET,                       /* Level. */
+                      SO_REUSEADDR,                     /* Option name. */
+                      &sock_opt_rec,                    /* Option value. */
+                      sizeof( sock_opt_rec));           /* Option length. */
+
+    if (sts < 0)
+    {
+      fprintf( stderr, "%s: setsockopt(rec) failed.\n", PROGRAM_NAME);
+      show_errno( PROGRAM_NAME);
+    }
+    else if ((debug& DBG_SIO) != 0)
+    {
+      fprintf( stderr, " setsockopt(rec) sts = %d.\n", sts);
+    }
+  }
+
+  if (sts == 0)
+  {
+    sts = set_socket_noblock( sock_orv);
+  }
+
+  if ((sts == 0) && (inh == 0))
+  { /* Make room for a storm of broadcast responses. */
+    set_socket_rcvbuf( sock_orv,
+     ((bcast == 0) ? 0 : OMAX( rcv_devs, RCVBUF_DEV_MIN)));
+  }
+
+  if ((sts == 0) && (inh == 0))
+  {
+    sts = bind( sock_orv,
+                (struct sockaddr *)
+                 &sock_addr_rec,                /* Socket address. */
+                sizeof( sock_addr_rec));        /* Socket address length. */
+
+    if (sts < 0)
+    {
+      fprintf( stderr, "%s: bind(rec) failed.\n", PROGRAM_NAME);
+      show_errno( PROGRAM_NAME);
+    }
+    else if ((debug& DBG_SIO) != 0)
+    {
+      fprintf( stderr, " bind(rec) sts = %d.\n", sts);
+    }
+
+    {
+#ifdef EARLY_RECVFROM                           /* Useful or not? */
+      if ((debug& DBG_SIO) != 0)
+      {
+        fprintf( stderr,
+         " pre-recvfrom(e).  sock_orv = %d, siz = %ld.\n",
+         sock_orv, sizeof( msg_inp));
+      }
+
+      /* Read a response.  (Should be too soon.) */
+      sock_addr_len_rec = sizeof( sock_addr_rec);       /* Socket addr len. */
+      bc = recvfrom( sock_orv,
+                     msg_inp,
+                     sizeof( msg_inp),
+                     0,                         /* Flags (not OOB or PEEK). */
+                     (struct sockaddr *)
+                      &sock_addr_rec,           /* Socket address. */
+                     &sock_addr_len_rec);       /* Socket address length. */
+
+      if (bc < 0)
+      {
+# ifdef _WIN32
+        if (WSAGetLastError() != WSAEWOULDBLOCK)
+# else /* def _WIN32 */
+        if (errno != EWOULDBLOCK)
+# endif /* def _WIN32 [else] */
+        {
+          fprintf( stderr, "%s: recvfrom(e) failed.\n", PROGRAM_NAME);
+          show_errno( PROGRAM_NAME);
+        }
+      }
+      else if ((debug& DBG_SIO) != 0)
+      {
+        fprintf( stderr, " recvfrom(e) bc = %ld.\n", bc);
+      }
+#endif /* def EARLY_RECVFROM */
+    }
+  }
+
+  if ((sts == 0) && (bcast != 0) && (inh == 0))
+  {
+    /* Set socket broadcast flag.  (Inherited: Set by listen_fds().) */
+
+#ifdef _WIN32
+    char sock_opt_snd = 1;
+#else /* def _WIN32 */
+    unsigned int sock_opt_snd = 1;
+#endif /* def _WIN32 [else] */
+
+    sts = setsockopt( sock_orv,                         /* Socket. */
+                      SOL_SOCKET,                       /* Level. */
+                      SO_BROADCAST,                     /* Option name. */
+                      &sock_opt_snd,                    /* Option value. */
+                      sizeof( sock_opt_snd));           /* Option length. */
+
+    if ((debug& DBG_SIO) != 0)
+    {
+      fprintf( stderr, " setsockopt( snd-bc0) = %d .\n", sts);
+    }
+
+    if (sts < 0)
+    {
+      fprintf( stderr, "%s: setsockopt( snd-bc1) failed.\n",
+       PROGRAM_NAME);
+      show_errno( PROGRAM_NAME);
+    }
+    else
+    {
+      /* Disable multicast loopback.  (Ineffective?) */
+      unsigned char sock_opt_snd = 0;
+
+      sts = setsockopt( sock_orv,                       /* Socket. */
+                        IPPROTO_IP,                     /* Level. */
+                        IP_MULTICAST_LOOP,              /* Option name. */
+                        &sock_opt_snd,                  /* Option value. */
+                        sizeof( sock_opt_snd));         /* Option length. */
+
+      if (sts < 0)
+      {
+        fprintf( stderr, "%s: setsockopt( snd-lb) failed.\n",
+         PROGRAM_NAME);
+        show_errno( PROGRAM_NAME);
+      }
+    }
+  }
+
+  if ((sts != 0) && (!BAD_SOCKET( sock_orv)))
+  {
+    CLOSE_SOCKET( sock_orv);
+    sock_orv = INVALID_SOCKET;
+  }
+  return sock_orv;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* task_send(): Send a message to a device (or broadcast) address. */
+
+int task_send( SOCKET sock_orv,                 /* Socket. */
+               unsigned char *msg_out,          /* Message. */
+               size_t msg_out_len,              /* Message length. */
+               struct in_addr *ip_addr_p)       /* IP address. */
+{
+  ssize_t bc;
+  int sts = 0;
+  struct sockaddr_in sock_addr_snd;
+
+  /* Fill send socket addr structure. */
+  memset( &sock_addr_snd, 0, sizeof( sock_addr_snd));
+  sock_addr_snd.sin_family = AF_INET;
+  sock_addr_snd.sin_port = htons( PORT_ORV);
+  sock_addr_snd.sin_addr.s_addr = ip_addr_p->s_addr;
+
+  /* Send the command. */
+  bc = sendto( sock_orv,                        /* Socket. */
+               msg_out,                         /* Message. */
+               msg_out_len,                     /* Message length. */
+               0,                               /* Flags (not MSG_OOB). */
+               (struct sockaddr *)
+                &sock_addr_snd,                 /* Socket address. */
+               sizeof( sock_addr_snd));         /* Socket address length. */
+
+  if (bc < 0)
+  {
+    fprintf( stderr, "%s: sendto() failed.\n", PROGRAM_NAME);
+    show_errno( PROGRAM_NAME);
+    sts = -1;
+  }
+  else
+  {
+    metrics.msg_snd++;
+    if ((debug& DBG_SIO) != 0)
+    {
+      fprintf( stderr, " sendto() = %ld.\n", bc);
+    }
+  }
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* task_send_gather(): Send a gather-list message to a device address.
+ */
+
+int task_send_gather( SOCKET sock_orv,          /* Socket. */
+                      orv_gather_t *gather_p,   /* Message (gather list). */
+                      struct in_addr *ip_addr_p)        /* IP address. */
+{
+  int sts = 0;
+
+#ifdef USE_SENDMSG
+
+  int i;
+  ssize_t bc;
+  struct msghdr msg;
+  struct iovec iov[ GATHER_SEG_MAX];
+  struct sockaddr_in sock_addr_snd;
+
+  /* Fill send socket addr structure. */
+  memset( &sock_addr_snd, 0, sizeof( sock_addr_snd));
+  sock_addr_snd.sin_family = AF_INET;
+  sock_addr_snd.sin_port = htons( PORT_ORV);
+  sock_addr_snd.sin_addr.s_addr = ip_addr_p->s_addr;
+
+  for (i = 0; i < gather_p->cnt; i++)
+  {
+    iov[ i].iov_base = (void *)gather_p->seg[ i].base;
+    iov[ i].iov_len = gather_p->seg[ i].len;
+  }
+
+  memset( &msg, 0, sizeof( msg));
+  msg.msg_name = &sock_addr_snd;
+  msg.msg_namelen = sizeof( sock_addr_snd);
+  msg.msg_iov = iov;
+  msg.msg_iovlen = gather_p->cnt;
+
+  bc = sendmsg( sock_orv, &msg, 0);
+  if (bc < 0)
+  {
+    fprintf( stderr, "%s: sendmsg() failed.\n", PROGRAM_NAME);
+    show_errno( PROGRAM_NAME);
+    sts = -1;
+  }
+  else
+  {
+    metrics.msg_snd++;
+    if ((debug& DBG_SIO) != 0)
+    {
+      fprintf( stderr, " sendmsg() = %ld.\n", bc);
+    }
+  }
+
+#else /* def USE_SENDMSG */
+
+  size_t msg_out_len;
+  unsigned char msg_out[ RBUF_SIZE];
+
+  /* Linearize the message, and send it normally. */
+  msg_out_len = gather_copy( gather_p, msg_out, sizeof( msg_out));
+  if (msg_out_len == 0)
+  {
+    errno = EMSGSIZE;
+    sts = -1;
+  }
+  else
+  {
+    sts = task_send( sock_orv, msg_out, msg_out_len, ip_addr_p);
+  }
+
+#endif /* def USE_SENDMSG [else] */
+
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* task_recv(): Receive and process responses until select() times out
+ *              (tmo_us), or, if pend_cnt_p is not NULL, until every LL
+ *              member with a pending response has sent an rsp_req
+ *              response.
+ */
+
+int task_recv( SOCKET sock_orv,                 /* Socket. */
+               int rsp_req,                     /* Response requirement. */
+               int *rsp_p,                      /* Response type bit mask. */
+               orv_tbl_t *tbl_p,                /* Table data. */
+               orv_data_t *origin_p,            /* orv_data origin. */
+               int *pend_cnt_p,                 /* Pending response count. */
+               long tmo_us,                     /* Time-out (us). */
+               unsigned int *drops_p)           /* Drop count (cumulative). */
+{
+  ssize_t bc;                   /* Byte count (receive). */
+  int rsp_msg;                  /* Response type (one message). */
+  int sts = 0;                  /* Status. */
+  unsigned int drops_beg;       /* Drop count at start. */
+  orv_rbuf_t *rbuf_p = NULL;    /* Receive message buffer. */
+  struct sockaddr_in sock_addr_rec;
+  orv_data_t *orv_data_p;
+
+  fd_set fds_rec;
+  struct timeval timeout_rec;
+
+#ifdef USE_DAEMON
+  if (!BAD_SOCKET( sock_orv_inh))
+  { /* A copy of the inherited socket.  Its drop count is the socket's
+     * lifetime count.  Start from the count seen last (by any task).
+     */
+    *drops_p = sock_orv_inh_drops;
+  }
+#endif /* def USE_DAEMON */
+  drops_beg = *drops_p;
+
+  /* Fill file-descriptor flags and time-out value for select(). */
+  memset( &fds_rec, 0, sizeof( fds_rec));
+  FD_SET( sock_orv, &fds_rec);
+  timeout_rec.tv_sec  = tmo_us/ 1000000;               /* Seconds. */
+  timeout_rec.tv_usec = tmo_us% 1000000;               /* Microseconds. */
+
+  if ((debug& DBG_SIO) != 0)
+  {
+    fprintf( stderr, " sock_orv = %d, FD_SETSIZE = %d,\n",
+     sock_orv, FD_SETSIZE);
+
+    fprintf( stderr, " FD_ISSET( sock_orv, &fds_rec) = %d.\n",
+     FD_ISSET( sock_orv, &fds_rec));
+  }
+
+  /* Read responses until recvfrom()/select() times out. */
+  while ((pend_cnt_p == NULL) || (*pend_cnt_p > 0))
+  {
+    if ((debug& DBG_SIO) != 0)
+    {
+      fprintf( stderr, " pre-select(1).  sock_orv = %d.\n", sock_orv);
+    }
+
+    sts = select( FD_SETSIZE, &fds_rec, NULL, NULL, &timeout_rec);
+
+    if (sts <= 0)
+    {
+      if ((sts < 0) && (errno != EINTR))        /* (Signal: Quiet.) */
+      {
+        fprintf( stderr, "%s: select(1) failed.\n", PROGRAM_NAME);
+        show_errno( PROGRAM_NAME);
+      }
+      else if ((debug& DBG_SIO) != 0)
+      {
+        fprintf( stderr, " select(1) sts = %d.\n", sts);
+      }
+      break;
+    }
+
+    if ((debug& DBG_SIO) != 0)
+    {
+      fprintf( stderr, " pre-recvfrom(n).  sock_orv = %d.\n",
+       sock_orv);
+    }
+
+    if (rbuf_p == NULL)
+    {
+      rbuf_p = rbuf_get();
+      if (rbuf_p == NULL)
+      {
+        fprintf( stderr, "%s: malloc() failed [r].\n", PROGRAM_NAME);
+        sts = -1;
+        break;
+      }
+    }
+
+    /* Receive a response. */
+    bc = recv_msg( sock_orv,
+                   rbuf_p->data,
+                   RBUF_SIZE,
+                   &sock_addr_rec,              /* Socket address. */
+                   drops_p);                    /* Kernel drop count. */
+
+    if (bc < 0)
+    {
+      fprintf( stderr, "%s: recvfrom(n) failed.\n", PROGRAM_NAME);
+      show_errno( PROGRAM_NAME);
+      break;
+    }
+    rbuf_p->len = bc;
+
+    rsp_msg = msg_process( rbuf_p, &sock_addr_rec, tbl_p,
+     origin_p, &orv_data_p);
+    *rsp_p |= rsp_msg;
+
+    if (rbuf_p->refs > 1)
+    { /* Buffer kept by msg_process().  Use a fresh one next time. */
+      rbuf_release( rbuf_p);
+      rbuf_p = NULL;
+    }
+
+    if ((pend_cnt_p != NULL) && (orv_data_p != NULL) &&
+     (orv_data_p->pend != 0) && ((rsp_msg& rsp_req) != 0))
+    { /* Expected response from a pending device. */
+      orv_data_p->pend = 0;
+      (*pend_cnt_p)--;
+      if ((rsp_msg& RSP_SF) != 0)
+      { /* Switch confirmed.  Note the time (skew metric). */
+        metrics.sw_last = ms_time();
+        if (metrics.sw_cnt++ == 0)
+        {
+          metrics.sw_first = metrics.sw_last;
+        }
+      }
+    }
+  }
+
+  rbuf_release( rbuf_p);
+
+#ifdef USE_DAEMON
+  if (!BAD_SOCKET( sock_orv_inh))
+  {
+    sock_orv_inh_drops = *drops_p;
+  }
+#endif /* def USE_DAEMON */
+  if (*drops_p > drops_beg)
+  { /* Kernel dropped some responses.  Tell the caller. */
+    *rsp_p |= RSP_OVF;
+    metrics.rcv_drops += *drops_p- drops_beg;
+    if ((debug& (DBG_SIO| DBG_MET)) != 0)
+    {
+      fprintf( stderr, " Receive queue overflow.  Drops = %u.\n",
+       (*drops_p- drops_beg));
+    }
+  }
+  return ((sts < 0) ? sts : 0);
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* task(): Perform a task: Send message, receive and process results.
+ *         If pend_cnt_p is not NULL, then stop receiving when that many
+ *         pending devices have sent an rsp_req response.
+ */
+
+int task( int task_nr,                  /* Task number. */
+          int rsp_req,                  /* Response requirement bit mask. */
+          int *rsp_p,                   /* Response type bit mask. */
+          orv_tbl_t *tbl_p,             /* Table data. */
+          orv_data_t *origin_p,         /* orv_data origin. */
+          orv_data_t *target_p,         /* orv_data target. */
+          int *pend_cnt_p)              /* Pending response count. */
+{
+  SOCKET sock_orv = INVALID_SOCKET;     /* Orvibo device socket. */
+
+  int sts;                      /* Status. */
+
+  int bcast = 0;                /* Broadcast message flag. */
+
+  unsigned char *msg_out;       /* Send message pointer. */
+  ssize_t msg_out_len = 0;
+  orv_gather_t *gather_p = NULL;        /* Send message gather list. */
+  unsigned int sock_drops = 0;  /* Kernel rcv-queue drops (cumulative). */
+
+#ifdef VMS
+  int oper_priv_save = -1;
+#endif /* def VMS */
+
+  sts = 0;
+
+  if ((debug& DBG_MSI) != 0)
+  {
+    fprintf( stderr,
+     " task(beg).  task_nr = %d, tbl_p = %sNULL.\n",
+     task_nr, ((tbl_p == NULL) ? "" : "non-"));
+  }
+
+  /* Form command message according to task_nr. */
+
+  if (sts == 0)
+  {
+    /* Broadcast IP, specific IP, or specific MAC address? */
+    if (task_nr == TSK_GLOB_DISC_B)
+    { /* Broadcast IP. */
+      bcast = 1;
+    }
+
+    /* Form the message for this task_nr, or point to an already
+     * existing message.
+     */
+    if ((task_nr == TSK_WT_SOCKET) || (task_nr == TSK_WT_TIMING))
+    {
+      if ((tbl_p != NULL) && (tbl_p->wt.cnt > 0))
+      { /* Use an existing (Write-Table) gather list. */
+        gather_p = &tbl_p->wt;
+        msg_out_len = gather_p->len;
+
+        if ((debug& DBG_MSO) != 0)
+        {
+          fprintf( stderr, " task(non-f_m_o).  m_o_l = %ld, segs = %d.\n",
+           msg_out_len, gather_p->cnt);
+        }
+      }
+      else
+      {
+        errno = EINVAL;
+        sts = -1;
+      }
+    }
+    else
+    { /* Use a pre-rendered message. */
+      msg_out_len = form_msg_out( task_nr, &msg_out, target_p);
+
+      if ((debug& DBG_MSO) != 0)
+      {
+        fprintf( stderr, " task(f_m_o).  m_o_l = %ld.\n",
+         msg_out_len);
+      }
+
+      if (msg_out_len <= 0)
+      {
+        errno = EINVAL;
+        sts = -1;
+      }
+    }
+  }
+
+#ifdef VMS
+# ifndef NO_OPER_PRIVILEGE
+  /* On VMS, broadcast may require BYPASS, OPER, or SYSPRV privilege,
+   * unless TCPIP SET PROTOCOL UDP /BROADCAST.  We try to enable only
+   * OPER, which may be relatively safe.
+   *
+   * As of TCPIP V5.7 - ECO 5 on Alpha, privilege must be adequate
+   * (elevated) when the socket is created.  If raised after socket(),
+   * then setsockopt( SO_BROADCAST) fails (EACCES).
+   */
+
+  if (sts == 0)
+  {
+    if (bcast != 0)
+    {
+      sts = set_priv_oper( 1, &oper_priv_save);
+
+      if (sts != 0)
+      {
+        fprintf( stderr,
+         "%s: Set privilege (OPER) failed.  sts = %%x%08x .\n",
+         PROGRAM_NAME, sts);
+        show_errno( PROGRAM_NAME);
+        sts = 0;                        /* Try to continue. */
+      }
+      else if ((debug& DBG_VMS) != 0)
+      {
+        fprintf( stderr,
+         " set_priv_oper(set).  sts = %%x%08x , oper_old = %d.\n",
+         sts, oper_priv_save);
+      }
+    }
+  }
+# endif /* ndef NO_OPER_PRIVILEGE */
+#endif /* def VMS */
+
+  if (sts == 0)
+  {
+    sock_orv = task_sock_open( bcast, origin_p->cnt_flg);
+    if (BAD_SOCKET( sock_orv))
+    {
+      sts = -1;
+    }
+  }
+
+  if (sts == 0)
+  {
+    if (gather_p != NULL)
+    {
+      sts = task_send_gather( sock_orv, gather_p, &target_p->ip_addr);
+    }
+    else
+    {
+      sts = task_send( sock_orv, msg_out, msg_out_len, &target_p->ip_addr);
+    }
+    if ((sts == 0) && (bcast == 0) && (target_p != origin_p))
+    { /* Unicast.  Note the send time (round-trip time). */
+      target_p->t_sent = ms_time();
+    }
+    else if ((sts == 0) && (bcast != 0))
+    { /* Broadcast.  Responses say nothing about any one round trip. */
+      orv_data_t *orv_data_p;
+
+      for (orv_data_p = origin_p->next; orv_data_p != origin_p;
+       orv_data_p = orv_data_p->next)
+      {
+        orv_data_p->t_sent = 0;
+      }
+    }
+  }
+
+  if (sts == 0)
+  {
+    /* Read responses until recvfrom()/select() times out. */
+    sts = task_recv( sock_orv, rsp_req, rsp_p, tbl_p, origin_p,
+     pend_cnt_p, SOCKET_TIMEOUT, &sock_drops);
+  }
+
+#ifdef VMS
+# ifndef NO_OPER_PRIVILEGE
+  /* Restore original OPER privilege state, if elevated. */
+  if (oper_priv_save == 0)      /* Was set (not -1), and initial was zero. */
+  {
+    sts = set_priv_oper( 0, &oper_priv_save);
+
+    if (sts != 0)
+    {
+      fprintf( stderr,
+       "%s: Remove privilege (OPER) failed.  sts = %%x%08x .\n",
+       PROGRAM_NAME, sts);
+      show_errno( PROGRAM_NAME);
+    }
+    else if ((debug& DBG_VMS) != 0)
+    {
+      fprintf( stderr,
+       " set_priv_oper(restore).  sts = %%x%08x , oper_old = %d.\n",
+       sts, oper_priv_save);
+    }
+  }
+# endif /* ndef NO_OPER_PRIVILEGE */
+#endif /* def VMS */
+
+  if (!BAD_SOCKET( sock_orv))
+  {
+    CLOSE_SOCKET( sock_orv);
+  }
+
+  if ((debug& DBG_MSI) != 0)
+  {
+    fprintf( stderr, " task(end).  sts = %d.\n", sts);
+  }
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* msleep(): Suspend process for <arg> milliseconds.
+ * <arg> < 1000 if using usleep().
+ */
+
+#ifdef _WIN32                   /* Windows: Use msleep(). */
+
+int msleep( int msec)
+{
+  Sleep( msec);
+  return 0;
+}
+
+#else /* def _WIN32 */          /* Non-Windows: Use usleep(). */
+
+int msleep( int msec)
+{
+  int sts;
+
+  if (msec >= 1000)
+  {
+    errno = EINVAL;
+    sts = -1;
+  }
+  else
+  {
+    sts = usleep( msec* 1000);
+  }
+  return sts;
+}
+
+#endif /* def _WIN32 [else] */
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* task_retry(): Execute task() with retries.
+ *               Retry until rsp_req condition is met, or retry limit is
+ *               reached.
+ */
+
+int task_retry( int rsp_req,            /* Response requirement bit mask. */
+                int task_nr,            /* Task number. */
+                int *rsp_p,             /* Response type bit mask. */
+                orv_tbl_t *tbl_p,       /* Table data. */
+                orv_data_t *origin_p,   /* orv_data origin. */
+                orv_data_t *target_p)   /* orv_data target. */
+{
+  int retry_count = 0;
+  int sts = 0;
+
+  while ((sts == 0) &&
+   ((*rsp_p& rsp_req) == 0) &&
+   (retry_count < TASK_RETRY_MAX))
+  {
+    if (retry_count > 0)
+    {
+      if (((debug& DBG_MSI) != 0) || ((debug& DBG_MSO) != 0))
+      {
+        fprintf( stderr,
+         " TASK RETRY (%d).  N = %d, rsp = %08x , rsp_req = %08x .\n",
+         task_nr, retry_count, *rsp_p, rsp_req);
+      }
+      msleep( TASK_RETRY_WAIT);         /* Delay (ms) between retries. */
+    }
+    sts = task( task_nr, rsp_req, rsp_p, tbl_p, origin_p, target_p, NULL);
+    retry_count++;
+  }
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* task_send_burst(): Send a task message to every LL member with a
+ *                    pending response (pend != 0).  With sendmmsg(),
+ *                    send them in as few system calls as possible, so
+ *                    that the first and last arrive close together.
+ *                    If limit > 0, then send only to (at most limit)
+ *                    members not yet sent to (pend == 1), and mark them
+ *                    sent (pend = 2).  If chain is not NULL, then send
+ *                    to every member on that (timing wheel) chain,
+ *                    instead.
+ */
+
+int task_send_burst( SOCKET sock_orv,           /* Socket. */
+                     int task_nr,               /* Task number. */
+                     orv_data_t *origin_p,      /* orv_data origin. */
+                     int limit,                 /* Message limit. */
+                     orv_data_t *chain)         /* Member chain (wheel). */
+{
+  int cnt = 0;
+  int sts = 0;
+  size_t msg_out_len;
+  unsigned char *msg_out;
+  orv_data_t *orv_data_p;
+  orv_data_t *end_p;            /* End of list (LL origin, or NULL). */
+#ifdef USE_SENDMMSG
+  int i;
+  int n = 0;
+  int sent;
+  struct mmsghdr mmsg[ BURST_MAX];
+  struct iovec iov[ BURST_MAX];
+  struct sockaddr_in sock_addr_snd[ BURST_MAX];
+#endif /* def USE_SENDMMSG */
+
+  end_p = ((chain == NULL) ? origin_p : NULL);
+
+#ifdef USE_SENDMMSG
+
+  orv_data_p = ((chain == NULL) ? origin_p->next : chain);
+  while ((sts == 0) && ((n > 0) || (orv_data_p != end_p)))
+  {
+    if ((orv_data_p != end_p) && ((chain != NULL) ||
+     ((orv_data_p->pend != 0) &&
+     ((limit <= 0) || ((orv_data_p->pend == 1) && (cnt < limit))))))
+    { /* Add this member's message to the burst. */
+      msg_out_len = form_msg_out( task_nr, &msg_out, orv_data_p);
+      if (msg_out_len <= 0)
+      {
+        errno = EINVAL;
+        sts = -1;
+        break;
+      }
+      memset( &sock_addr_snd[ n], 0, sizeof( sock_addr_snd[ n]));
+      sock_addr_snd[ n].sin_family = AF_INET;
+      sock_addr_snd[ n].sin_port = htons( PORT_ORV);
+      sock_addr_snd[ n].sin_addr.s_addr = orv_data_p->ip_addr.s_addr;
+      iov[ n].iov_base = msg_out;
+      iov[ n].iov_len = msg_out_len;
+      memset( &mmsg[ n], 0, sizeof( mmsg[ n]));
+      mmsg[ n].msg_hdr.msg_name = &sock_addr_snd[ n];
+      mmsg[ n].msg_hdr.msg_namelen = sizeof( sock_addr_snd[ n]);
+      mmsg[ n].msg_hdr.msg_iov = &iov[ n];
+      mmsg[ n].msg_hdr.msg_iovlen = 1;
+      n++;
+      orv_data_p->t_sent = ms_time();
+      if (limit > 0)
+      {
+        orv_data_p->pend = 2;                   /* Sent. */
+        cnt++;
+      }
+    }
+    if (orv_data_p != end_p)
+    {
+      orv_data_p = ((chain == NULL) ? orv_data_p->next :
+       orv_data_p->wheel_next);
+    }
+
+    if ((n > 0) && ((n == BURST_MAX) || (orv_data_p == end_p)))
+    { /* Burst full, or no more members.  Send it. */
+      for (i = 0; (sts == 0) && (i < n); i += sent)
+      {
+        sent = sendmmsg( sock_orv, &mmsg[ i], (n- i), 0);
+        if (sent <= 0)
+        {
+          fprintf( stderr, "%s: sendmmsg() failed.\n", PROGRAM_NAME);
+          show_errno( PROGRAM_NAME);
+          sts = -1;
+        }
+        else
+        {
+          metrics.msg_snd += sent;
+          if ((debug& DBG_SIO) != 0)
+          {
+            fprintf( stderr, " sendmmsg() = %d.\n", sent);
+          }
+        }
+      }
+      n = 0;
+    }
+  }
+
+#else /* def USE_SENDMMSG */
+
+  orv_data_p = ((chain == NULL) ? origin_p->next : chain);
+  while ((sts == 0) && (orv_data_p != end_p))
+  {
+    if ((chain != NULL) || ((orv_data_p->pend != 0) &&
+     ((limit <= 0) || ((orv_data_p->pend == 1) && (cnt < limit)))))
+    {
+      msg_out_len = form_msg_out( task_nr, &msg_out, orv_data_p);
+      if (msg_out_len <= 0)
+      {
+        errno = EINVAL;
+        sts = -1;
+      }
+      else
+      {
+        sts = task_send( sock_orv, msg_out, msg_out_len,
+         &orv_data_p->ip_addr);
+        orv_data_p->t_sent = ms_time();
+      }
+      if (limit > 0)
+      {
+        orv_data_p->pend = 2;                   /* Sent. */
+        cnt++;
+      }
+    }
+    orv_data_p = ((chain == NULL) ? orv_data_p->next :
+     orv_data_p->wheel_next);
+  }
+
+#endif /* def USE_SENDMMSG [else] */
+
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* pace_take(): Take up to want switch tokens from the pacing bucket
+ *              (refilled at pace.cnt per pace.ms, holding at most
+ *              pace.cnt).  Return the count taken.  If none, then
+ *              return (in *wait_ms_p) the time until the next token.
+ */
+
+int pace_take( int want, int *wait_ms_p)
+{
+  int add;
+  int n;
+  unsigned long now;
+
+  now = ms_time();
+  if (pace.t_fill == 0)
+  { /* First use.  Full bucket. */
+    pace.tokens = pace.cnt;
+    pace.t_fill = now;
+  }
+
+  add = (int)((now- pace.t_fill)* pace.cnt/ pace.ms);
+  if (add > 0)
+  { /* Refill.  (Keep the remainder time.) */
+    pace.tokens = OMIN( pace.cnt, (pace.tokens+ add));
+    pace.t_fill += (unsigned long)add* pace.ms/ pace.cnt;
+  }
+
+  n = OMIN( want, pace.tokens);
+  pace.tokens -= n;
+  if (n == 0)
+  {
+    *wait_ms_p = OMAX( 1, (int)(pace.ms/ pace.cnt- (now- pace.t_fill)));
+  }
+  return n;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* task_multi(): Perform a task for every LL member with a pending
+ *               response (pend != 0), using one socket.  Send all the
+ *               messages, then receive until every pending member has
+ *               sent an rsp_req response, or the time-out expires.
+ *               Retry only the members which are still pending.
+ *               Return (in *pend_cnt_p) the count still pending.
+ *               With switch pacing ("pace="), send the "dc" messages
+ *               as pace_take() allows, and collect the responses
+ *               while waiting.
+ */
+
+int task_multi( int rsp_req,            /* Response requirement bit mask. */
+                int task_nr,            /* Task number. */
+                int retry_max,          /* Retry limit. */
+                int *rsp_p,             /* Response type bit mask. */
+                orv_data_t *origin_p,   /* orv_data origin. */
+                int *pend_cnt_p)        /* Pending response count. */
+{
+  int n;
+  int paced;
+  int pend_cnt;
+  int retry_count = 0;
+  int sts = 0;
+  int unsent;
+  int wait_ms;
+  unsigned int sock_drops = 0;  /* Kernel rcv-queue drops (cumulative). */
+  SOCKET sock_orv;
+  orv_data_t *orv_data_p;
+
+  paced = ((pace.cnt > 0) &&
+   ((task_nr == TSK_SW_OFF) || (task_nr == TSK_SW_ON)));
+
+  /* Count the pending members. */
+  pend_cnt = 0;
+  orv_data_p = origin_p->next;
+  while (orv_data_p != origin_p)
+  {
+    if (orv_data_p->pend != 0)
+    {
+      pend_cnt++;
+    }
+    orv_data_p = orv_data_p->next;
+  }
+
+  sock_orv = INVALID_SOCKET;
+  if (pend_cnt > 0)
+  {
+    sock_orv = task_sock_open( 0, 0);
+    if (BAD_SOCKET( sock_orv))
+    {
+      sts = -1;
+    }
+  }
+
+  while ((sts == 0) && (pend_cnt > 0) && (retry_count <= retry_max))
+  {
+    if (retry_count > 0)
+    {
+      if (((debug& DBG_MSI) != 0) || ((debug& DBG_MSO) != 0))
+      {
+        fprintf( stderr,
+         " TASK MULTI RETRY (%d).  N = %d, pending = %d.\n",
+         task_nr, retry_count, pend_cnt);
+      }
+      msleep( TASK_RETRY_WAIT);         /* Delay (ms) between retries. */
+    }
+
+    if (paced == 0)
+    { /* Send the message to every pending member. */
+      sts = task_send_burst( sock_orv, task_nr, origin_p, 0, NULL);
+    }
+    else
+    { /* Paced.  Mark every pending member not sent (pend = 1). */
+      orv_data_p = origin_p->next;
+      while (orv_data_p != origin_p)
+      {
+        orv_data_p->pend = ((orv_data_p->pend != 0) ? 1 : 0);
+        orv_data_p = orv_data_p->next;
+      }
+
+      /* Send as tokens allow.  Collect responses while waiting. */
+      unsent = pend_cnt;
+      while ((sts == 0) && (unsent > 0) && (pend_cnt > 0))
+      {
+        n = pace_take( unsent, &wait_ms);
+        if (n > 0)
+        {
+          sts = task_send_burst( sock_orv, task_nr, origin_p, n, NULL);
+          unsent -= n;
+        }
+        else
+        {
+          if ((debug& DBG_MSO) != 0)
+          {
+            fprintf( stderr, " Pace: unsent = %d, wait = %d ms.\n",
+             unsent, wait_ms);
+          }
+          sts = task_recv( sock_orv, rsp_req, rsp_p, NULL, origin_p,
+           &pend_cnt, (wait_ms* 1000L), &sock_drops);
+        }
+      }
+    }
+
+    if (sts == 0)
+    { /* Collect responses until all arrive, or time-out. */
+      sts = task_recv( sock_orv, rsp_req, rsp_p, NULL, origin_p,
+       &pend_cnt, SOCKET_TIMEOUT, &sock_drops);
+    }
+    retry_count++;
+  }
+
+  if (!BAD_SOCKET( sock_orv))
+  {
+    CLOSE_SOCKET( sock_orv);
+  }
+
+  if ((debug& DBG_DEV) != 0)
+  {
+    fprintf( stderr, " task_multi(end).  sts = %d, pending = %d.\n",
+     sts, pend_cnt);
+  }
+
+  if (pend_cnt_p != NULL)
+  {
+    *pend_cnt_p = pend_cnt;
+  }
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+
+/* catalog_devices_ddf(): Use file data to populate the orv_data LL. */
+
+#define CLG_LINE_MAX 512
+
+int catalog_devices_ddf( FILE *fp,              /* File pointer. */
+                         int *clg_line_nr,      /* File line number. */
+                         char *err_tkn,         /* Bad token. */
+                         orv_data_t *origin_p)  /* LL origin. */
+{
+  int sts = 0;
+  char clg_line[ CLG_LINE_MAX+ 1];              /* fgets() buffer. */
+  char *cp;                                     /* fgets() result, ... */
+  char *ipa;                                    /* IP address string. */
+  char *mac;                                    /* MAC address string. */
+  char *nam;                                    /* Device name string. */
+  int fl;                                       /* file line length, ... */
+  struct in_addr ip_addr;                       /* IP address. */
+  unsigned char mac_b[ 6];                      /* MAC address. */
+  orv_data_t *orv_data_p;
+
+  *clg_line_nr = 0;                             /* File line number. */
+  while ((cp = fgets( clg_line, CLG_LINE_MAX, fp)) != NULL)
+  {
+    (*clg_line_nr)++;                   /* Count this line. */
+    ipa = NULL;                         /* Clear token pointers. */
+    mac = NULL;
+    nam = NULL;
+
+    clg_line[ CLG_LINE_MAX] = '\0';     /* Make buffer-end tidy. */
+    fl = strlen( clg_line);
+    if ((fl > 0) && (clg_line[ fl- 1] == '\n'))
+    {
+      clg_line[ fl- 1] = '\0';          /* Strip off a new-line. */
+    }
+
+    if ((cp = strchr( clg_line, '#')) != NULL)  /* Trim comment. */
+    {
+      *cp = '\0';
+    }
+
+    if (strlen( clg_line) > 0)          /* Trim leading white space. */
+    {
+      cp = clg_line;
+      while (isspace( *cp))
+      {
+        cp++;
+      }
+    }
+
+    if (strlen( cp) == 0)               /* No data on line. */
+    {
+      continue;
+    }
+
+    if (strlen( cp) > 0)
+    {
+      ipa = cp;                         /* IP address. */
+      while ((*cp != '\0') && !isspace( *cp))
+      {
+        cp++;
+      }
+      if (*cp != '\0')
+      {
+        *cp++ = '\0';                   /* NUL-terminate at first space. */
+      }
+    }
+
+    if (strlen( cp) > 0)                /* Skip white space. */
+    {
+      while (isspace( *cp))
+      {
+        cp++;
+      }
+
+      mac = cp;                         /* MAC address. */
+      while ((*cp != '\0') && !isspace( *cp))
+      {
+        cp++;
+      }
+      if (*cp != '\0')
+      {
+        *cp++ = '\0';                   /* NUL-terminate at first space. */
+      }
+    }
+
+    if (strlen( cp) > 0)
+    {
+      while (isspace( *cp))             /* Skip white space. */
+      {
+        cp++;
+      }
+
+      nam = cp;                         /* Device name. */
+      if (*cp == '>')                   /* Apparently, ">name<". */
+      {
+        nam++;
+        while ((*cp != '\0') && (*cp != '<'))
+        {
+          cp++;
+        }
+      }
+      else
+      {
+        while ((*cp != '\0') && !isspace( *cp))
+        {
+          cp++;
+        }
+      }
+      if (*cp != '\0')
+      {
+        *cp++ = '\0';                   /* NUL-terminate at "<" or space. */
+      }
+    }
+
+    if (ipa == NULL)
+    {
+      sts = -2;
+      break;
+    }
+
+    if (mac == NULL)
+    {
+      sts = -3;
+      break;
+    }
+    if (nam == NULL)
+    {
+      sts = -4;
+      break;
+    }
+
+    if ((debug& DBG_FIL) != 0)
+    {
+      fprintf( stderr, " ipa: >%s<, mac: >%s<, nam: >%s<\n", ipa, mac, nam);
+    }
+
+    sts = dns_resolve( ipa, &ip_addr);
+    if (sts != 0)
+    {
+      sts = -5;
+      fprintf( stderr, "%s: Bad IP address on line %d: >%s<.\n",
+       PROGRAM_NAME, *clg_line_nr, ipa);
+      break;
+    }
+
+    sts = parse_mac( mac, mac_b);
+    if (sts != 0)
+    {
+      sts = -6;
+      fprintf( stderr, "%s: Bad MAC address on line %d: >%s<.\n",
+       PROGRAM_NAME, *clg_line_nr, mac);
+      break;
+    }
+
+    fl = strlen( nam);
+    if (fl > DEV_NAME_LEN)
+    {
+      sts = -7;
+      fprintf( stderr,
+       "%s: Name too long (len = %d > %d) on line %d: >%s<.\n",
+       PROGRAM_NAME, fl, DEV_NAME_LEN, *clg_line_nr, nam);
+      break;
+    }
+    /* (Check name for invalid characters?  What's valid?) */
+
+    orv_data_p = orv_data_new( origin_p,
+     ((origin_p->sort_key == SRT_IP) ? (void *)&ip_addr : (void *)mac_b));
+
+    if (orv_data_p == NULL)
+    {
+      fprintf( stderr, "%s: malloc() failed [2].\n", PROGRAM_NAME);
+      break;
+    }
+    else
+    {
+      memcpy( orv_data_p->mac_addr, mac_b, MAC_ADDR_SIZE);      /* MAC addr. */
+      orv_data_p->ip_addr.s_addr = ip_addr.s_addr;              /* IP addr. */
+      if ((fl == strlen( UNSET_NAME)) &&
+       (memcmp( nam, UNSET_NAME, strlen( UNSET_NAME)) == 0))
+      {
+        memset( orv_data_p->name, 0xff, DEV_NAME_LEN);  /* Unset name. */
+      }
+      else
+      {
+        memcpy( orv_data_p->name, nam, fl);             /* Device name. */
+        memset( orv_data_p->name+ fl, 0x20,             /* Blank fill. */
+         (DEV_NAME_LEN- fl));
+      }
+
+      /* Any table 4 data or device state ("key=value", inventory
+       * cache).
+       */
+      while (*cp != '\0')
+      {
+        char *tkn;
+
+        while (isspace( *cp))
+        {
+          cp++;
+        }
+        tkn = cp;
+        while ((*cp != '\0') && !isspace( *cp))
+        {
+          if ((*cp == '=') && (*(cp+ 1) == '>') &&
+           (strchr( (cp+ 2), '<') != NULL))
+          { /* "key=>value<" (value may contain spaces). */
+            cp = strchr( (cp+ 2), '<');
+          }
+          cp++;
+        }
+        if (*cp != '\0')
+        {
+          *cp++ = '\0';
+        }
+        if ((*tkn != '\0') &&
+         (rsp_fld_parse( tkn, &orv_data_p->rt4) != 0) &&
+         (state_fld_parse( tkn, orv_data_p) != 0))
+        {
+          if ((debug& DBG_FIL) != 0)
+          {
+            fprintf( stderr, " Ignored token on line %d: >%s<\n",
+             *clg_line_nr, tkn);
+          }
+        }
+      }
+      if (RSP_HAVE( &orv_data_p->rt4, FLD_TYPE))
+      {
+        orv_data_p->type = (short)orv_data_p->rt4.type;
+      }
+    }
+  } /* while */
+
+  if ((debug& DBG_FIL) != 0)
+  {
+    fprintf( stderr, " catalog_devices_ddf(end).  sts = %d.\n", sts);
+    fprintf_device_list( stdout, FDL_DDF, origin_p);
+  }
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* discover_devices(): Use Unit Discovery to populate the orv_data LL.
+ *                     (All the selected devices are queried at once.)
+ */
+
+int discover_devices( int single, orv_data_t *origin_p)
+{
+  int pend_cnt;
+  int rsp;
+  int sts;
+  orv_data_t *orv_data_p;
+
+  if ((debug& DBG_DEV) != 0)
+  {
+    fprintf( stderr, " disc_devs(0).  single = %08x .\n", single);
+  }
+
+  orv_data_p = origin_p->next;      /* Start with first (real?) LL mmbr. */
+  while (orv_data_p != origin_p)    /* Quit when back to the origin. */
+  {
+    if ((debug& DBG_DEV) != 0)
+    {
+      fprintf( stderr, " disc_devs(1).  cnt_flg = %d.\n", orv_data_p->cnt_flg);
+      fprintf_device( stderr, 0, orv_data_p);
+    }
+
+    orv_data_p->pend =
+     (((single == 0) || (orv_data_p->cnt_flg != 0)) ? 1 : 0);
+    orv_data_p = orv_data_p->next;  /* Advance to the next member. */
+  } /* while */
+
+  /* Send Unit Discovery messages.  Expect some "qg" responses. */
+  rsp = 0;
+  sts = task_multi( RSP_QG, TSK_UNIT_DISC, TASK_RETRY_MAX, &rsp,
+   origin_p, &pend_cnt);
+  if (sts != 0)
+  {
+    fprintf( stderr, "%s: Unit discovery.  sts = %d.\n",
+     PROGRAM_NAME, sts);
+  }
+
+  if ((debug& DBG_DEV) != 0)
+  {
+    fprintf( stderr, " disc_devs(end).  sts = %d, pending = %d.\n",
+     sts, pend_cnt);
+  }
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* rt_index_vers(): Find one table's version flag in a table 1 (index)
+ *                  "rt" response.  Return the flag, or -1, if none.
+ */
+
+int rt_index_vers( orv_rbuf_t *rbuf_p, int table_nr)
+{
+  int vers = -1;
+  size_t ofs;
+  size_t rec_len;
+  unsigned char *msg;
+
+  msg = rbuf_p->data;
+  if ((rbuf_p->len > READ_TABLE_TABLE+ 1) &&
+   (msg[ READ_TABLE_TABLE+ 1] == 0x01))
+  {
+    ofs = READ_TABLE_RECORDS;
+    while (ofs+ 8 <= (size_t)rbuf_p->len)
+    {
+      rec_len = msg[ ofs]+ 256* msg[ ofs+ 1];
+      if ((rec_len < 6) || (ofs+ 2+ rec_len > (size_t)rbuf_p->len))
+      {
+        break;                                  /* Bad record. */
+      }
+      if (msg[ ofs+ 4]+ 256* msg[ ofs+ 5] == table_nr)
+      {
+        vers = msg[ ofs+ 6]+ 256* msg[ ofs+ 7];
+        break;
+      }
+      ofs += 2+ rec_len;
+    }
+  }
+  return vers;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* countdown_patch(): Form a table-4 countdown patch ("rt" offset 164):
+ *                    status (2 bytes, LE: 1 = active, 0 = off),
+ *                    seconds (2 bytes, LE).  Zero seconds cancels.
+ */
+
+void countdown_patch( int countdown,            /* Countdown (s). */
+                      unsigned char *buf,       /* COUNTDOWN_LEN bytes. */
+                      orv_patch_t *patch_p)     /* Patch (output). */
+{
+  buf[ 0] = (countdown > 0) ? 1 : 0;            /* Status. */
+  buf[ 1] = 0;
+  buf[ 2] = countdown% 256;                     /* Seconds. */
+  buf[ 3] = countdown/ 256;
+
+  patch_p->ofs = 164;
+  patch_p->len = COUNTDOWN_LEN;
+  patch_p->data = buf;
+  patch_p->label = "Countdown";
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* passwd_patch(): Form a table-4 remote password patch ("rt" offset
+ *                 58): the password, blank-filled.  An empty password
+ *                 resets the factory password ("888888").
+ */
+
+void passwd_patch( const char *passwd,          /* New password. */
+                   unsigned char *buf,          /* PASSWORD_LEN bytes. */
+                   orv_patch_t *patch_p)        /* Patch (output). */
+{
+  size_t len;
+
+  if (*passwd == '\0')
+  { /* No password specified.  Reset to factory: "888888". */
+    passwd = "888888";
+  }
+  len = OMIN( strlen( passwd), PASSWORD_LEN);
+  memcpy( buf, passwd, len);
+  memset( (buf+ len), 0x20, (PASSWORD_LEN- len));
+
+  patch_p->ofs = 58;
+  patch_p->len = PASSWORD_LEN;
+  patch_p->data = buf;
+  patch_p->label = "Password";
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* name_patch(): Form a table-4 device name patch ("rt" offset 70): the
+ *               name, blank-filled.  An empty name resets the factory
+ *               (unset) name (DEV_NAME_LEN* 0xff).
+ */
+
+void name_patch( const char *name,              /* New device name. */
+                 unsigned char *buf,            /* DEV_NAME_LEN bytes. */
+                 orv_patch_t *patch_p)          /* Patch (output). */
+{
+  size_t len;
+
+  len = OMIN( strlen( name), DEV_NAME_LEN);
+  if (len == 0)
+  { /* No name specified.  Reset to factory: 16* 0xff. */
+    memset( buf, 0xff, DEV_NAME_LEN);
+  }
+  else
+  { /* Normal name. */
+    memcpy( buf, name, len);
+    memset( (buf+ len), 0x20, (DEV_NAME_LEN- len));
+  }
+
+  patch_p->ofs = 70;
+  patch_p->len = DEV_NAME_LEN;
+  patch_p->data = buf;
+  patch_p->label = "Device name";
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* table4_write(): Write table 4 (socket data) fields: Read table 4,
+ *                 form a "tm" message from the saved "rt" response with
+ *                 the patches (see tm_gather()), write it, then read
+ *                 table 4 again, and check the patched fields.
+ *                 (Subscribe first.)
+ */
+
+int table4_write( orv_data_t *origin_p,         /* orv_data origin. */
+                  orv_data_t *target_p,         /* orv_data target. */
+                  orv_patch_t *patch_p,         /* Patches. */
+                  int patch_cnt)                /* Patch count. */
+{
+  int i;
+  int rsp;
+  int sts;
+  unsigned short msg_len = 0;
+  orv_tbl_t tbl1;               /* "rt"/"tm" table data. */
+  orv_tbl_t tbl2;               /* "rt" table data (check). */
+
+  memset( &tbl1, 0, sizeof( tbl1));
+  memset( &tbl2, 0, sizeof( tbl2));
+
+  /* Send Read table: socket message.  Expect some "rt" response.
+   * Save the "rt" response for use (after modification) as the
+   * "tm" message.
+   */
+  rsp = 0;
+  sts = task_retry( RSP_RT, TSK_RT_SOCKET, &rsp, &tbl1,
+   origin_p, target_p);
+  if (sts != 0)
+  {
+    fprintf( stderr, "%s: Read table: socket.  sts = %d.\n",
+     PROGRAM_NAME, sts);
+  }
+  else if (tbl1.rbuf == NULL)
+  {
+    fprintf( stderr, "%s: Read table: socket.  NULL ptr.\n",
+     PROGRAM_NAME);
+    sts = -1;
+  }
+  else
+  { /* Extract response message length. */
+    msg_len = (unsigned short)tbl1.rbuf->data[ 2]* 256+
+              (unsigned short)tbl1.rbuf->data[ 3];
+
+    if ((debug& DBG_MSI) != 0)
+    {
+      /* Display the response (hex, ASCII). */
+      fprintf( stderr, "   %c  %c  msg_len = %d\n",
+       tbl1.rbuf->data[ 4], tbl1.rbuf->data[ 5], msg_len);
+
+      msg_dump( tbl1.rbuf->data, msg_len);
+    }
+  }
+
+  if (sts == 0)
+  {
+    sts = tm_gather( &tbl1.wt, tbl1.rbuf, patch_p, patch_cnt);
+    if (sts != 0)
+    {
+      fprintf( stderr, "%s: Form Write table: socket failed.\n",
+       PROGRAM_NAME);
+    }
+    else if ((debug& DBG_MSI) != 0)
+    {
+      unsigned char msg_tm[ RBUF_SIZE];
+
+      gather_copy( &tbl1.wt, msg_tm, sizeof( msg_tm));
+      fprintf( stderr, "   %c  %c  msg_len-3 = %d\n",
+       msg_tm[ 4], msg_tm[ 5], (msg_len-3));
+
+      msg_dump( msg_tm, (msg_len-3));
+    }
+  }
+
+  if (sts == 0)
+  {
+    /* Send Write table: socket message.  Expect some "tm" response. */
+    rsp = 0;
+    sts = task_retry( RSP_TM, TSK_WT_SOCKET, &rsp, &tbl1,
+     origin_p, target_p);
+    if (sts != 0)
+    {
+      fprintf( stderr, "%s: Write table: socket.  sts = %d.\n",
+       PROGRAM_NAME, sts);
+    }
+    else if ((rsp& RSP_TM) == 0)
+    {
+      fprintf( stderr,
+       "%s: No Write table: socket response received.\n",
+       PROGRAM_NAME);
+      errno = ENOMSG;
+      sts = -1;
+    }
+    else
+    { /* Got "tm" response.  Re-query device to update data. */
+      /* Send Read table: socket message.  Expect some "rt" response.
+       * Save the "rt" response to check against requested data.
+       */
+      rsp = 0;
+      sts = task_retry( RSP_RT, TSK_RT_SOCKET, &rsp, &tbl2,
+       origin_p, target_p);
+      if (sts != 0)
+      {
+        fprintf( stderr, "%s: Read table: socket.  sts = %d.\n",
+         PROGRAM_NAME, sts);
+      }
+      else if (tbl2.rbuf == NULL)
+      {
+        fprintf( stderr, "%s: Read table: socket.  NULL ptr.\n",
+         PROGRAM_NAME);
+        sts = -1;
+      }
+      else
+      { /* Check the requested data against the new "rt" data. */
+        for (i = 0; i < patch_cnt; i++)
+        {
+          if ((patch_p[ i].ofs+ patch_p[ i].len > tbl2.rbuf->len) ||
+           (memcmp( patch_p[ i].data, (tbl2.rbuf->data+ patch_p[ i].ofs),
+           patch_p[ i].len) != 0))
+          {
+            fprintf( stderr, "%s: %s NOT set.\n",
+             PROGRAM_NAME, patch_p[ i].label);
+            errno = EINVAL;
+            sts = -1;
+          }
+          else if ((debug& DBG_ACT) != 0)
+          {
+            fprintf( stderr, " New %s:\n", patch_p[ i].label);
+            msg_dump( (tbl2.rbuf->data+ patch_p[ i].ofs), patch_p[ i].len);
+          }
+        }
+      }
+    }
+  }
+  rbuf_release( tbl1.rbuf);
+  rbuf_release( tbl2.rbuf);
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* timer_decode(): Decode the timer records in a table 3 (timing) "rt"
+ *                 response.  Return the record count (all records, of
+ *                 which only the first tmr_max are stored), or -1, if
+ *                 the response is not a table 3 response.
+ */
+
+int timer_decode( orv_rbuf_t *rbuf_p, orv_timer_t *tmr_p, int tmr_max)
+{
+  int cnt = -1;
+  size_t ofs;
+  size_t rec_len;
+  unsigned char *rec;
+
+  if ((rbuf_p->len > READ_TABLE_TABLE+ 1) &&
+   (rbuf_p->data[ READ_TABLE_TABLE+ 1] == 0x03))
+  {
+    cnt = 0;
+    ofs = READ_TABLE_RECORDS;
+    while (ofs+ 2 <= (size_t)rbuf_p->len)
+    {
+      rec = rbuf_p->data+ ofs;
+      rec_len = rec[ 0]+ 256* rec[ 1];
+      if ((rec_len < TIMER_REC_LEN) ||
+       (ofs+ 2+ rec_len > (size_t)rbuf_p->len))
+      {
+        break;                                  /* Bad record. */
+      }
+      rec += 2;                                 /* Skip the length. */
+      if (cnt >= tmr_max)
+      {
+        cnt++;                                  /* Count, not stored. */
+        ofs += 2+ rec_len;
+        continue;
+      }
+      tmr_p[ cnt].rec_nr = rec[ 0]+ 256* rec[ 1];
+      memcpy( tmr_p[ cnt].unk, (rec+ 2), sizeof( tmr_p[ cnt].unk));
+      tmr_p[ cnt].state = rec[ TIMER_REC_STATE];
+      tmr_p[ cnt].year = rec[ TIMER_REC_YEAR]+ 256* rec[ TIMER_REC_YEAR+ 1];
+      tmr_p[ cnt].month = rec[ TIMER_REC_MONTH];
+      tmr_p[ cnt].day = rec[ TIMER_REC_MONTH+ 1];
+      tmr_p[ cnt].hour = rec[ TIMER_REC_MONTH+ 2];
+      tmr_p[ cnt].minute = rec[ TIMER_REC_MONTH+ 3];
+      tmr_p[ cnt].second = rec[ TIMER_REC_MONTH+ 4];
+      tmr_p[ cnt].repeat = rec[ TIMER_REC_REPEAT];
+      cnt++;
+      ofs += 2+ rec_len;
+    }
+  }
+  return cnt;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* timer_encode(): Encode a timer record (without its length). */
+
+void timer_encode( orv_timer_t *tmr_p, unsigned char *rec)
+{
+  rec[ 0] = tmr_p->rec_nr% 256;
+  rec[ 1] = tmr_p->rec_nr/ 256;
+  memcpy( (rec+ 2), tmr_p->unk, sizeof( tmr_p->unk));
+  rec[ TIMER_REC_STATE] = tmr_p->state;
+  rec[ TIMER_REC_STATE+ 1] = 0;
+  rec[ TIMER_REC_YEAR] = tmr_p->year% 256;
+  rec[ TIMER_REC_YEAR+ 1] = tmr_p->year/ 256;
+  rec[ TIMER_REC_MONTH] = tmr_p->month;
+  rec[ TIMER_REC_MONTH+ 1] = tmr_p->day;
+  rec[ TIMER_REC_MONTH+ 2] = tmr_p->hour;
+  rec[ TIMER_REC_MONTH+ 3] = tmr_p->minute;
+  rec[ TIMER_REC_MONTH+ 4] = tmr_p->second;
+  rec[ TIMER_REC_REPEAT] = tmr_p->repeat;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* timer_parse(): Parse a timer specification:
+ *                   {on|off},[yyyy-mm-dd,]hh:mm[:ss][,repeat]
+ *                where repeat is "once" (default), "daily", or day
+ *                names joined by "+" (say, "mon+wed+fri").  The date
+ *                defaults to today.  Return 0, if valid.
+ */
+
+int timer_parse( char *spec, orv_timer_t *tmr_p)
+{
+  int i;
+  int n;
+  int sts = 0;
+  char *tkn;
+  char *nxt;
+  char buf[ 128];
+  time_t t1;
+  struct tm stm;
+
+  memset( tmr_p, 0, sizeof( *tmr_p));
+  memset( tmr_p->unk, 0x20, sizeof( tmr_p->unk));
+  time( &t1);
+  LOCALTIME_R( &t1, &stm);
+  tmr_p->year = stm.tm_year+ 1900;
+  tmr_p->month = stm.tm_mon+ 1;
+  tmr_p->day = stm.tm_mday;
+
+  strncpy( buf, spec, (sizeof( buf)- 1));
+  buf[ sizeof( buf)- 1] = '\0';
+
+  /* Power state. */
+  tkn = buf;
+  nxt = strchr( tkn, ',');
+  if (nxt != NULL)
+  {
+    *nxt++ = '\0';
+  }
+  if (STRNCASECMP( tkn, "on", 3) == 0)
+  {
+    tmr_p->state = 1;
+  }
+  else if (STRNCASECMP( tkn, "off", 4) != 0)
+  {
+    sts = -1;
+  }
+
+  /* Date (optional). */
+  tkn = nxt;
+  if ((sts == 0) && (tkn != NULL) && (strchr( tkn, '-') != NULL))
+  {
+    nxt = strchr( tkn, ',');
+    if (nxt != NULL)
+    {
+      *nxt++ = '\0';
+    }
+    if ((sscanf( tkn, "%d-%d-%d%n", &tmr_p->year, &tmr_p->month,
+     &tmr_p->day, &n) != 3) || (tkn[ n] != '\0') ||
+     (tmr_p->month < 1) || (tmr_p->month > 12) ||
+     (tmr_p->day < 1) || (tmr_p->day > 31))
+    {
+      sts = -1;
+    }
+    tkn = nxt;
+  }
+
+  /* Time (required). */
+  if ((sts == 0) && (tkn != NULL))
+  {
+    nxt = strchr( tkn, ',');
+    if (nxt != NULL)
+    {
+      *nxt++ = '\0';
+    }
+    n = sscanf( tkn, "%d:%d:%d", &tmr_p->hour, &tmr_p->minute,
+     &tmr_p->second);
+    if ((n < 2) || (tmr_p->hour < 0) || (tmr_p->hour > 23) ||
+     (tmr_p->minute < 0) || (tmr_p->minute > 59) ||
+     (tmr_p->second < 0) || (tmr_p->second > 59))
+    {
+      sts = -1;
+    }
+    tkn = nxt;
+  }
+  else
+  {
+    sts = -1;
+  }
+
+  /* Repeat (optional). */
+  if ((sts == 0) && (tkn != NULL))
+  {
+    if (STRNCASECMP( tkn, "daily", 6) == 0)
+    {
+      tmr_p->repeat = TMR_REPEAT| TMR_DAYS;
+    }
+    else if (STRNCASECMP( tkn, "once", 5) != 0)
+    {
+      while ((sts == 0) && (tkn != NULL))
+      {
+        nxt = strchr( tkn, '+');
+        if (nxt != NULL)
+        {
+          *nxt++ = '\0';
+        }
+        for (i = 0; i < 7; i++)
+        {
+          if (STRNCASECMP( tkn, day_name[ i], 4) == 0)
+          {
+            tmr_p->repeat |= TMR_REPEAT| day_bit[ i];
+            break;
+          }
+        }
+        if (i >= 7)
+        {
+          sts = -1;
+        }
+        tkn = nxt;
+      }
+    }
+  }
+
+  if (sts != 0)
+  {
+    fprintf( stderr, "%s: Invalid timer specification: %s\n",
+     PROGRAM_NAME, spec);
+    errno = EINVAL;
+  }
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* timers_read(): Read (table 3) and decode a device's timer records.
+ *                (Subscribe first.)
+ */
+
+int timers_read( orv_data_t *origin_p,          /* orv_data origin. */
+                 orv_data_t *target_p,          /* orv_data target. */
+                 orv_timer_t *tmr_p,            /* Timer records. */
+                 int *tmr_cnt_p)                /* Timer record count. */
+{
+  int rsp;
+  int sts;
+  orv_tbl_t tbl;
+
+  *tmr_cnt_p = 0;
+  memset( &tbl, 0, sizeof( tbl));
+
+  /* Send Read table: timing message.  Expect some "rt" response. */
+  rsp = 0;
+  sts = task_retry( RSP_RT, TSK_RT_TIMING, &rsp, &tbl,
+   origin_p, target_p);
+  if (sts != 0)
+  {
+    fprintf( stderr, "%s: Read table: timing.  sts = %d.\n",
+     PROGRAM_NAME, sts);
+  }
+  else if (tbl.rbuf == NULL)
+  {
+    fprintf( stderr, "%s: Read table: timing.  NULL ptr.\n",
+     PROGRAM_NAME);
+    errno = ENOMSG;
+    sts = -1;
+  }
+  else
+  {
+    *tmr_cnt_p = timer_decode( tbl.rbuf, tmr_p, TIMER_MAX);
+    if (*tmr_cnt_p < 0)
+    {
+      fprintf( stderr, "%s: Read table: timing.  Unexpected table.\n",
+       PROGRAM_NAME);
+      *tmr_cnt_p = 0;
+      errno = EINVAL;
+      sts = -1;
+    }
+    else if (*tmr_cnt_p > TIMER_MAX)
+    {
+      fprintf( stderr,
+       "%s: Too many timer records: %d.  Using the first %d.\n",
+       PROGRAM_NAME, *tmr_cnt_p, TIMER_MAX);
+      *tmr_cnt_p = TIMER_MAX;
+    }
+  }
+  rbuf_release( tbl.rbuf);
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* timer_write(): Add, modify, or delete (TMA_xxx) one timer record. */
+
+int timer_write( orv_data_t *origin_p,          /* orv_data origin. */
+                 orv_data_t *target_p,          /* orv_data target. */
+                 int mode,                      /* Mode (TMA_xxx). */
+                 orv_timer_t *tmr_p)            /* Timer record. */
+{
+  int rsp;
+  int sts;
+  orv_tbl_t tbl;
+  unsigned char msg[ MSG_LEN_WRITE_TIMING];
+
+  memcpy( msg, cmd_write_timing, sizeof( cmd_write_timing));
+  memcpy( (msg+ 6), target_p->mac_addr, MAC_ADDR_SIZE);
+  msg[ WRITE_TIMING_MODE] = mode;
+  timer_encode( tmr_p, (msg+ sizeof( cmd_write_timing)));
+  msg_len_set( msg, MSG_LEN_WRITE_TIMING);
+
+  if ((debug& DBG_MSO) != 0)
+  {
+    fprintf( stderr, " >> WT-TIMING (mode %d, rec %u)\n",
+     mode, tmr_p->rec_nr);
+    msg_dump( msg, MSG_LEN_WRITE_TIMING);
+  }
+
+  memset( &tbl, 0, sizeof( tbl));
+  sts = gather_add( &tbl.wt, msg, MSG_LEN_WRITE_TIMING);
+  if (sts == 0)
+  {
+    /* Send Write table: timing message.  Expect some "tm" response. */
+    rsp = 0;
+    metrics.tm_write++;
+    sts = task_retry( RSP_TM, TSK_WT_TIMING, &rsp, &tbl,
+     origin_p, target_p);
+    if (sts != 0)
+    {
+      fprintf( stderr, "%s: Write table: timing.  sts = %d.\n",
+       PROGRAM_NAME, sts);
+    }
+    else if ((rsp& RSP_TM) == 0)
+    {
+      fprintf( stderr,
+       "%s: No Write table: timing response received.\n",
+       PROGRAM_NAME);
+      errno = ENOMSG;
+      sts = -1;
+    }
+  }
+  rbuf_release( tbl.rbuf);
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* timer_same(): Do two timers do the same thing?  (The date of a
+ *               repeating timer does not matter.)
+ */
+
+int timer_same( orv_timer_t *tmr1_p, orv_timer_t *tmr2_p)
+{
+  return ((tmr1_p->state == tmr2_p->state) &&
+   (tmr1_p->hour == tmr2_p->hour) &&
+   (tmr1_p->minute == tmr2_p->minute) &&
+   (tmr1_p->second == tmr2_p->second) &&
+   (tmr1_p->repeat == tmr2_p->repeat) &&
+   (((tmr1_p->repeat& TMR_REPEAT) != 0) ||
+   ((tmr1_p->year == tmr2_p->year) &&
+   (tmr1_p->month == tmr2_p->month) &&
+   (tmr1_p->day == tmr2_p->day))));
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* sched_match(): Does a schedule device selector match a device?
+ *                Selector: "*" (all), MAC address, IP address, or
+ *                device name.
+ */
+
+int sched_match( orv_data_t *orv_data_p, char *sel)
+{
+  int match = 0;
+  int nam_len;
+  unsigned int ia4;
+  char ip_str[ 16];
+  char nam_buf[ DEV_NAME_LEN+ 1];
+  unsigned char mac_b[ MAC_ADDR_SIZE];
+
+  if (strcmp( sel, "*") == 0)
+  {
+    match = 1;
+  }
+  else if (parse_mac( sel, mac_b) == 0)
+  {
+    match = (memcmp( mac_b, orv_data_p->mac_addr, MAC_ADDR_SIZE) == 0);
+  }
+  else
+  {
+    ia4 = ntohl( orv_data_p->ip_addr.s_addr);
+    sprintf( ip_str, "%u.%u.%u.%u",
+     ((ia4/ 0x100/ 0x100/ 0x100)& 0xff), ((ia4/ 0x100/ 0x100)& 0xff),
+     ((ia4/ 0x100)& 0xff), (ia4& 0xff));
+    dev_name( orv_data_p, nam_buf, &nam_len);
+    match = ((strcmp( sel, ip_str) == 0) ||
+     ((nam_len > 0) && (strcmp( sel, nam_buf) == 0)));
+  }
+  return match;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* sched_read(): Read a schedule file, and attach the wanted timers to
+ *               the matching devices in the orv_data LL (only marked
+ *               devices, if single).  Each line is a device selector
+ *               (see sched_match(); ">name<" for a name with spaces),
+ *               then timer specifications (see timer_parse()).  A
+ *               device gets the timers from every line which matches
+ *               it.
+ */
+
+int sched_read( char *sched_name, orv_data_t *origin_p, int single)
+{
+  int fl;
+  int line_nr = 0;
+  int match_cnt;
+  int sts = 0;
+  char *cp;
+  char *sel;
+  char *spec;
+  char line[ CLG_LINE_MAX+ 1];
+  FILE *fp;
+  orv_timer_t tmr;
+  orv_data_t *orv_data_p;
+
+  fp = fopen( sched_name, "r");
+  if (fp == NULL)
+  {
+    fprintf( stderr, "%s: Open (read) failed: %s\n",
+     PROGRAM_NAME, sched_name);
+    show_errno( PROGRAM_NAME);
+    sts = -1;
+  }
+
+  while ((sts == 0) && (fgets( line, CLG_LINE_MAX, fp) != NULL))
+  {
+    line_nr++;
+    line[ CLG_LINE_MAX] = '\0';
+    fl = strlen( line);
+    if ((fl > 0) && (line[ fl- 1] == '\n'))
+    {
+      line[ fl- 1] = '\0';                      /* Strip off a new-line. */
+    }
+    if ((cp = strchr( line, '#')) != NULL)      /* Trim comment. */
+    {
+      *cp = '\0';
+    }
+    cp = line;
+    while (isspace( *cp))                       /* Skip white space. */
+    {
+      cp++;
+    }
+    if (*cp == '\0')                            /* No data on line. */
+    {
+      continue;
+    }
+
+    /* Device selector. */
+    sel = cp;
+    if (*cp == '>')                             /* ">name<". */
+    {
+      sel++;
+      while ((*cp != '\0') && (*cp != '<'))
+      {
+        cp++;
+      }
+    }
+    else
+    {
+      while ((*cp != '\0') && !isspace( *cp))
+      {
+        cp++;
+      }
+    }
+    if (*cp != '\0')
+    {
+      *cp++ = '\0';
+    }
+
+    /* Timer specifications (to every matching device). */
+    match_cnt = 0;
+    while ((sts == 0) && (*cp != '\0'))
+    {
+      while (isspace( *cp))
+      {
+        cp++;
+      }
+      spec = cp;
+      while ((*cp != '\0') && !isspace( *cp))
+      {
+        cp++;
+      }
+      if (*cp != '\0')
+      {
+        *cp++ = '\0';
+      }
+      if (*spec == '\0')
+      {
+        break;
+      }
+
+      sts = timer_parse( spec, &tmr);
+      orv_data_p = origin_p->next;
+      while ((sts == 0) && (orv_data_p != origin_p))
+      {
+        if (((single == 0) || (orv_data_p->cnt_flg != 0)) &&
+         (sched_match( orv_data_p, sel) != 0))
+        {
+          match_cnt++;
+          if (orv_data_p->sched == NULL)
+          {
+            orv_data_p->sched = arena_alloc( &arena, sizeof( orv_sched_t));
+            if (orv_data_p->sched == NULL)
+            {
+              fprintf( stderr, "%s: malloc() failed [s].\n", PROGRAM_NAME);
+              sts = -1;
+              break;
+            }
+            memset( orv_data_p->sched, 0, sizeof( orv_sched_t));
+          }
+          if (orv_data_p->sched->want_cnt >= TIMER_MAX)
+          {
+            fprintf( stderr, "%s: Too many timers (max %d) for: %s\n",
+             PROGRAM_NAME, TIMER_MAX, sel);
+            errno = E2BIG;
+            sts = -1;
+          }
+          else
+          {
+            orv_data_p->sched->want[ orv_data_p->sched->want_cnt++] = tmr;
+          }
+        }
+        orv_data_p = orv_data_p->next;
+      }
+    }
+
+    if (sts != 0)
+    {
+      fprintf( stderr, "%s: Bad schedule file line %d: %s\n",
+       PROGRAM_NAME, line_nr, sched_name);
+    }
+    else if ((match_cnt == 0) && (single == 0))
+    {
+      fprintf( stderr, "%s: No device matched (line %d): >%s<.\n",
+       PROGRAM_NAME, line_nr, sel);
+    }
+  }
+
+  if (fp != NULL)
+  {
+    fclose( fp);
+  }
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* sched_sync(): Compare a device's timers with its wanted timers.
+ *               Keep those which match.  If write, then modify the
+ *               other existing timers into the missing wanted ones,
+ *               add the rest of those, and delete any extras.  Return
+ *               the number of changes (made or needed), or -1.
+ */
+
+int sched_sync( orv_data_t *origin_p,           /* orv_data origin. */
+                orv_data_t *orv_data_p,         /* orv_data member. */
+                orv_timer_t *tmr_p,             /* Current timers. */
+                int tmr_cnt,                    /* Current timer count. */
+                int write)                      /* Write changes. */
+{
+  int i;
+  int j;
+  int sts = 0;
+  unsigned int rec_nr = 1;
+  char used[ TIMER_MAX];                        /* Current timer used. */
+  char have[ TIMER_MAX];                        /* Wanted timer found. */
+  orv_timer_t tmr;
+  orv_sched_t *sched_p;
+
+  sched_p = orv_data_p->sched;
+  memset( used, 0, sizeof( used));
+  memset( have, 0, sizeof( have));
+  sched_p->keep = 0;
+  sched_p->add = 0;
+  sched_p->modify = 0;
+  sched_p->del = 0;
+
+  for (i = 0; i < tmr_cnt; i++)
+  {
+    rec_nr = OMAX( rec_nr, (tmr_p[ i].rec_nr+ 1));
+  }
+
+  /* Unchanged timers. */
+  for (i = 0; i < sched_p->want_cnt; i++)
+  {
+    for (j = 0; j < tmr_cnt; j++)
+    {
+      if ((used[ j] == 0) && timer_same( &sched_p->want[ i], &tmr_p[ j]))
+      {
+        used[ j] = 1;
+        have[ i] = 1;
+        sched_p->keep++;
+        break;
+      }
+    }
+  }
+
+  /* Missing timers: Modify an unused one, or add a new one. */
+  j = 0;
+  for (i = 0; (sts == 0) && (i < sched_p->want_cnt); i++)
+  {
+    if (have[ i] == 0)
+    {
+      while ((j < tmr_cnt) && (used[ j] != 0))
+      {
+        j++;
+      }
+      if (j < tmr_cnt)
+      { /* Keep the record (number, unknown data).  New time, action. */
+        used[ j] = 1;
+        tmr = tmr_p[ j];
+        tmr.state = sched_p->want[ i].state;
+        tmr.year = sched_p->want[ i].year;
+        tmr.month = sched_p->want[ i].month;
+        tmr.day = sched_p->want[ i].day;
+        tmr.hour = sched_p->want[ i].hour;
+        tmr.minute = sched_p->want[ i].minute;
+        tmr.second = sched_p->want[ i].second;
+        tmr.repeat = sched_p->want[ i].repeat;
+        sched_p->modify++;
+        if (write != 0)
+        {
+          sts = timer_write( origin_p, orv_data_p, TMA_MODIFY, &tmr);
+        }
+      }
+      else
+      {
+        tmr = sched_p->want[ i];
+        tmr.rec_nr = rec_nr++;
+        sched_p->add++;
+        if (write != 0)
+        {
+          sts = timer_write( origin_p, orv_data_p, TMA_ADD, &tmr);
+        }
+      }
+    }
+  }
+
+  /* Extra timers: Delete. */
+  for (j = 0; (sts == 0) && (j < tmr_cnt); j++)
+  {
+    if (used[ j] == 0)
+    {
+      sched_p->del++;
+      if (write != 0)
+      {
+        sts = timer_write( origin_p, orv_data_p, TMA_DELETE, &tmr_p[ j]);
+      }
+    }
+  }
+
+  if ((debug& DBG_ACT) != 0)
+  {
+    fprintf( stderr,
+     " sched_sync().  keep = %d, add = %d, mod = %d, del = %d, sts = %d.\n",
+     sched_p->keep, sched_p->add, sched_p->modify, sched_p->del, sts);
+  }
+  return ((sts != 0) ? -1 : (sched_p->add+ sched_p->modify+ sched_p->del));
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* sched_apply(): Deploy the wanted timers to every device which has a
+ *                schedule: Read all their timer tables concurrently,
+ *                write only the changes, then read back (concurrently)
+ *                the changed ones to verify.  Set each device's
+ *                sched->sts, and return the count of failed devices.
+ */
+
+int sched_apply( orv_data_t *origin_p)
+{
+  int chg;
+  int fail_cnt = 0;
+  int pass;
+  int pend_cnt;
+  int rsp;
+  int tmr_cnt;
+  orv_data_t *orv_data_p;
+  orv_timer_t tmr[ TIMER_MAX];
+
+  /* Send Subscribe messages.  Expect some "cl" responses. */
+  orv_data_p = origin_p->next;
+  while (orv_data_p != origin_p)
+  {
+    orv_data_p->pend = ((orv_data_p->sched != NULL) ? 1 : 0);
+    orv_data_p = orv_data_p->next;
+  }
+  rsp = 0;
+  task_multi( RSP_CL, TSK_SUBSCRIBE, TASK_RETRY_MAX, &rsp, origin_p,
+   &pend_cnt);
+
+  /* Pass 0: Read and write.  Pass 1: Read back (changed devices). */
+  for (pass = 0; pass <= 1; pass++)
+  {
+    orv_data_p = origin_p->next;
+    while (orv_data_p != origin_p)
+    {
+      if (orv_data_p->sched != NULL)
+      {
+        if ((pass == 0) && (orv_data_p->pend != 0))
+        { /* No "cl" response. */
+          orv_data_p->sched->sts = -1;
+        }
+        orv_data_p->pend = (((orv_data_p->sched->sts == 0) && ((pass == 0) ||
+         (orv_data_p->sched->add+ orv_data_p->sched->modify+
+         orv_data_p->sched->del > 0))) ? 1 : 0);
+        rbuf_release( orv_data_p->rt3);
+        orv_data_p->rt3 = NULL;
+      }
+      orv_data_p = orv_data_p->next;
+    }
+
+    /* Send Read table: timing messages.  Expect some "rt" responses. */
+    rsp = 0;
+    task_multi( RSP_RT, TSK_RT_TIMING, TASK_RETRY_MAX, &rsp, origin_p,
+     &pend_cnt);
+
+    orv_data_p = origin_p->next;
+    while (orv_data_p != origin_p)
+    {
+      if ((orv_data_p->sched != NULL) && (orv_data_p->sched->sts == 0) &&
+       ((pass == 0) || (orv_data_p->sched->add+ orv_data_p->sched->modify+
+       orv_data_p->sched->del > 0)))
+      {
+        tmr_cnt = -1;
+        if (orv_data_p->rt3 != NULL)
+        {
+          tmr_cnt = timer_decode( orv_data_p->rt3, tmr, TIMER_MAX);
+          rbuf_release( orv_data_p->rt3);
+          orv_data_p->rt3 = NULL;
+        }
+
+        if (tmr_cnt < 0)
+        {
+          fprintf( stderr, "%s: Read table: timing.  No response.\n",
+           PROGRAM_NAME);
+          orv_data_p->sched->sts = -1;
+        }
+        else if (tmr_cnt > TIMER_MAX)
+        { /* Some records not decoded.  Can not tell what matches. */
+          fprintf( stderr,
+           "%s: Too many timer records: %d (max %d).  Schedule NOT set.\n",
+           PROGRAM_NAME, tmr_cnt, TIMER_MAX);
+          orv_data_p->sched->sts = -1;
+        }
+        else if (pass == 0)
+        { /* Write the changes. */
+          chg = sched_sync( origin_p, orv_data_p, tmr, tmr_cnt, 1);
+          if (chg < 0)
+          {
+            orv_data_p->sched->sts = -1;
+          }
+        }
+        else
+        { /* Verify.  (Keep the counts of the changes made.) */
+          orv_sched_t sched;
+
+          sched = *orv_data_p->sched;
+          chg = sched_sync( origin_p, orv_data_p, tmr, tmr_cnt, 0);
+          *orv_data_p->sched = sched;
+          if (chg != 0)
+          {
+            fprintf( stderr, "%s: Schedule NOT set.\n", PROGRAM_NAME);
+            orv_data_p->sched->sts = -1;
+          }
+        }
+      }
+      orv_data_p = orv_data_p->next;
+    }
+  }
+
+  orv_data_p = origin_p->next;
+  while (orv_data_p != origin_p)
+  {
+    if ((orv_data_p->sched != NULL) && (orv_data_p->sched->sts != 0))
+    {
+      fail_cnt++;
+    }
+    orv_data_p = orv_data_p->next;
+  }
+  return fail_cnt;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* want_read(): Read a desired-state file, and attach the wanted states
+ *              to the matching devices in the orv_data LL (only marked
+ *              devices, if single).  Each line is a device selector
+ *              (see sched_match()), then any of: "on", "off",
+ *              "name=device_name" (">name<" for a name with spaces),
+ *              "password=passwd".  A later line overrides an earlier
+ *              one.
+ */
+
+int want_read( char *want_name, orv_data_t *origin_p, int single)
+{
+  int fl;
+  int line_nr = 0;
+  int match_cnt;
+  int sts = 0;
+  char *cp;
+  char *sel;
+  char *spec;
+  char line[ CLG_LINE_MAX+ 1];
+  FILE *fp;
+  orv_want_t want;
+  orv_data_t *orv_data_p;
+  orv_patch_t patch;                            /* (Unused.) */
+
+  fp = fopen( want_name, "r");
+  if (fp == NULL)
+  {
+    fprintf( stderr, "%s: Open (read) failed: %s\n",
+     PROGRAM_NAME, want_name);
+    show_errno( PROGRAM_NAME);
+    sts = -1;
+  }
+
+  while ((sts == 0) && (fgets( line, CLG_LINE_MAX, fp) != NULL))
+  {
+    line_nr++;
+    line[ CLG_LINE_MAX] = '\0';
+    fl = strlen( line);
+    if ((fl > 0) && (line[ fl- 1] == '\n'))
+    {
+      line[ fl- 1] = '\0';                      /* Strip off a new-line. */
+    }
+    if ((cp = strchr( line, '#')) != NULL)      /* Trim comment. */
+    {
+      *cp = '\0';
+    }
+    cp = line;
+    while (isspace( *cp))                       /* Skip white space. */
+    {
+      cp++;
+    }
+    if (*cp == '\0')                            /* No data on line. */
+    {
+      continue;
+    }
+
+    /* Device selector. */
+    sel = cp;
+    if (*cp == '>')                             /* ">name<". */
+    {
+      sel++;
+      while ((*cp != '\0') && (*cp != '<'))
+      {
+        cp++;
+      }
+    }
+    else
+    {
+      while ((*cp != '\0') && !isspace( *cp))
+      {
+        cp++;
+      }
+    }
+    if (*cp != '\0')
+    {
+      *cp++ = '\0';
+    }
+
+    /* Wanted state, name, password. */
+    memset( &want, 0, sizeof( want));
+    want.state = -1;
+    while ((sts == 0) && (*cp != '\0'))
+    {
+      while (isspace( *cp))
+      {
+        cp++;
+      }
+      spec = cp;
+      if (STRNCASECMP( spec, "name=>", 6) == 0)
+      {                                         /* "name=>name<". */
+        while ((*cp != '\0') && (*cp != '<'))
+        {
+          cp++;
+        }
+        if (*cp != '\0')
+        {
+          *cp++ = '\0';
+        }
+      }
+      else
+      {
+        while ((*cp != '\0') && !isspace( *cp))
+        {
+          cp++;
+        }
+        if (*cp != '\0')
+        {
+          *cp++ = '\0';
+        }
+      }
+      if (*spec == '\0')
+      {
+        break;
+      }
+
+      if (STRNCASECMP( spec, "on", 3) == 0)
+      {
+        want.state = 1;
+      }
+      else if (STRNCASECMP( spec, "off", 4) == 0)
+      {
+        want.state = 0;
+      }
+      else if ((STRNCASECMP( spec, "name=", 5) == 0) &&
+       (strlen( spec+ 5) <= DEV_NAME_LEN+ ((spec[ 5] == '>') ? 1 : 0)))
+      { /* Empty: Factory (16* 0xff). */
+        spec += ((spec[ 5] == '>') ? 6 : 5);
+        want.name_set = 1;
+        strcpy( want.name_str, spec);
+        name_patch( want.name_str, want.name, &patch);
+      }
+      else if ((STRNCASECMP( spec, "password=", 9) == 0) &&
+       (strlen( spec+ 9) <= PASSWORD_LEN))
+      { /* Empty: Factory ("888888"). */
+        want.passwd_set = 1;
+        strcpy( want.passwd_str, (spec+ 9));
+        passwd_patch( want.passwd_str, want.passwd, &patch);
+      }
+      else
+      {
+        fprintf( stderr, "%s: Invalid desired state: >%s<.\n",
+         PROGRAM_NAME, spec);
+        errno = EINVAL;
+        sts = -1;
+      }
+    }
+
+    /* Attach (merge) to every matching device. */
+    match_cnt = 0;
+    orv_data_p = origin_p->next;
+    while ((sts == 0) && (orv_data_p != origin_p))
+    {
+      if (((single == 0) || (orv_data_p->cnt_flg != 0)) &&
+       (sched_match( orv_data_p, sel) != 0))
+      {
+        match_cnt++;
+        if (orv_data_p->want == NULL)
+        {
+          orv_data_p->want = arena_alloc( &arena, sizeof( orv_want_t));
+          if (orv_data_p->want == NULL)
+          {
+            fprintf( stderr, "%s: malloc() failed [w].\n", PROGRAM_NAME);
+            sts = -1;
+            break;
+          }
+          memset( orv_data_p->want, 0, sizeof( orv_want_t));
+          orv_data_p->want->state = -1;
+        }
+        if (want.state >= 0)
+        {
+          orv_data_p->want->state = want.state;
+        }
+        if (want.name_set != 0)
+        {
+          orv_data_p->want->name_set = 1;
+          strcpy( orv_data_p->want->name_str, want.name_str);
+          memcpy( orv_data_p->want->name, want.name, DEV_NAME_LEN);
+        }
+        if (want.passwd_set != 0)
+        {
+          orv_data_p->want->passwd_set = 1;
+          strcpy( orv_data_p->want->passwd_str, want.passwd_str);
+          memcpy( orv_data_p->want->passwd, want.passwd, PASSWORD_LEN);
+        }
+      }
+      orv_data_p = orv_data_p->next;
+    }
+
+    if (sts != 0)
+    {
+      fprintf( stderr, "%s: Bad desired-state file line %d: %s\n",
+       PROGRAM_NAME, line_nr, want_name);
+    }
+    else if ((match_cnt == 0) && (single == 0))
+    {
+      fprintf( stderr, "%s: No device matched (line %d): >%s<.\n",
+       PROGRAM_NAME, line_nr, sel);
+    }
+  }
+
+  if (fp != NULL)
+  {
+    fclose( fp);
+  }
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* want_apply(): Bring every device which has a desired state into that
+ *               state: Compare the wanted state, name, and password
+ *               with the (discovered) current data, then subscribe to
+ *               and switch (concurrently) only the devices whose state
+ *               differs, and write table 4 only for those whose name
+ *               or password differs.  (A wanted password which is not
+ *               known costs a (concurrent) table 4 read.)  Set each
+ *               device's want->sts, and return the count of failed
+ *               devices.
+ */
+
+int want_apply( orv_data_t *origin_p)
+{
+  int fail_cnt = 0;
+  int patch_cnt;
+  int pend_cnt;
+  int rsp;
+  int sw_st;
+  orv_data_t *orv_data_p;
+  orv_want_t *want_p;
+  orv_patch_t patch[ 2];
+
+  /* Send Read table: socket messages, where a wanted password is not
+   * known.  Expect some "rt" responses.
+   */
+  orv_data_p = origin_p->next;
+  while (orv_data_p != origin_p)
+  {
+    want_p = orv_data_p->want;
+    orv_data_p->pend = (((want_p != NULL) && (want_p->passwd_set != 0) &&
+     !RSP_HAVE( &orv_data_p->rt4, FLD_PASSWD)) ? 1 : 0);
+    orv_data_p = orv_data_p->next;
+  }
+  rsp = 0;
+  task_multi( RSP_RT, TSK_RT_SOCKET, TASK_RETRY_MAX, &rsp, origin_p,
+   &pend_cnt);
+
+  /* Compare.  Mark (pend) the devices which need any change. */
+  orv_data_p = origin_p->next;
+  while (orv_data_p != origin_p)
+  {
+    want_p = orv_data_p->want;
+    if (want_p != NULL)
+    {
+      if (orv_data_p->pend != 0)
+      { /* No "rt" response. */
+        want_p->sts = -1;
+      }
+      want_p->state_old = orv_data_p->state;
+      want_p->sw = (((want_p->state >= 0) &&
+       (want_p->state != orv_data_p->state)) ? 1 : 0);
+      want_p->set = 0;
+      if ((want_p->name_set != 0) &&
+       (memcmp( want_p->name, orv_data_p->name, DEV_NAME_LEN) != 0))
+      {
+        want_p->set++;
+      }
+      if ((want_p->passwd_set != 0) &&
+       (memcmp( want_p->passwd, orv_data_p->passwd, PASSWORD_LEN) != 0))
+      {
+        want_p->set++;
+      }
+    }
+    orv_data_p->pend = (((want_p != NULL) && (want_p->sts == 0) &&
+     (want_p->sw+ want_p->set > 0)) ? 1 : 0);
+    orv_data_p = orv_data_p->next;
+  }
+
+  /* Send Subscribe messages.  Expect some "cl" responses. */
+  rsp = 0;
+  task_multi( RSP_CL, TSK_SUBSCRIBE, TASK_RETRY_MAX, &rsp, origin_p,
+   &pend_cnt);
+
+  /* Send Device control messages, off, then on.  Expect some "dc" (or
+   * "sf") responses.
+   */
+  for (sw_st = 0; sw_st <= 1; sw_st++)
+  {
+    orv_data_p = origin_p->next;
+    while (orv_data_p != origin_p)
+    {
+      want_p = orv_data_p->want;
+      if ((want_p != NULL) && (want_p->sts == 0) &&
+       (want_p->sw+ want_p->set > 0) && (sw_st == 0) &&
+       (orv_data_p->pend != 0))
+      { /* No "cl" response. */
+        want_p->sts = -1;
+      }
+      orv_data_p->pend = (((want_p != NULL) && (want_p->sts == 0) &&
+       (want_p->sw != 0) && (want_p->state == sw_st)) ? 1 : 0);
+      orv_data_p = orv_data_p->next;
+    }
+    rsp = 0;
+    task_multi( (RSP_DC| RSP_SF), ((sw_st == 0) ? TSK_SW_OFF : TSK_SW_ON),
+     TASK_RETRY_MAX, &rsp, origin_p, &pend_cnt);
+
+    orv_data_p = origin_p->next;
+    while (orv_data_p != origin_p)
+    {
+      if (orv_data_p->pend != 0)
+      { /* No "dc" response. */
+        orv_data_p->want->sts = -1;
+        orv_data_p->pend = 0;
+      }
+      orv_data_p = orv_data_p->next;
+    }
+  }
+
+  /* Write table 4 (name, password), one device at a time. */
+  orv_data_p = origin_p->next;
+  while (orv_data_p != origin_p)
+  {
+    want_p = orv_data_p->want;
+    if ((want_p != NULL) && (want_p->sts == 0) && (want_p->set != 0))
+    {
+      patch_cnt = 0;
+      if (want_p->passwd_set != 0)
+      {
+        passwd_patch( want_p->passwd_str, want_p->passwd,
+         &patch[ patch_cnt++]);
+      }
+      if (want_p->name_set != 0)
+      {
+        name_patch( want_p->name_str, want_p->name, &patch[ patch_cnt++]);
+      }
+      if (table4_write( origin_p, orv_data_p, patch, patch_cnt) != 0)
+      {
+        want_p->sts = -1;
+      }
+    }
+    if ((want_p != NULL) && (want_p->sts != 0))
+    {
+      fail_cnt++;
+    }
+    orv_data_p = orv_data_p->next;
+  }
+
+  if ((debug& DBG_ACT) != 0)
+  {
+    fprintf( stderr, " want_apply(end).  fail_cnt = %d.\n", fail_cnt);
+  }
+  return fail_cnt;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* group_mark(): Mark (cnt_flg) the LL members which match any of a
+ *               comma-separated list of device selectors (see
+ *               sched_match()).  Return the count of marked members.
+ */
+
+int group_mark( orv_data_t *origin_p, char *sel_list)
+{
+  int len;
+  int mark_cnt = 0;
+  char *cp;
+  char *cp2;
+  char sel[ CLG_LINE_MAX+ 1];
+  orv_data_t *orv_data_p;
+
+  orv_data_p = origin_p->next;
+  while (orv_data_p != origin_p)
+  {
+    orv_data_p->cnt_flg = 0;
+    cp = sel_list;
+    while ((orv_data_p->cnt_flg == 0) && (*cp != '\0'))
+    {
+      cp2 = strchr( cp, ',');
+      len = ((cp2 == NULL) ? (int)strlen( cp) : (int)(cp2- cp));
+      len = OMIN( len, CLG_LINE_MAX);
+      memcpy( sel, cp, len);
+      sel[ len] = '\0';
+      if ((len > 0) && (sched_match( orv_data_p, sel) != 0))
+      {
+        orv_data_p->cnt_flg = 1;        /* Mark this member for reportng. */
+        mark_cnt++;
+      }
+      cp += len;
+      if (*cp == ',')
+      {
+        cp++;
+      }
+    }
+    orv_data_p = orv_data_p->next;
+  }
+  return mark_cnt;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* sw_group(): Switch a group of devices (the marked LL members) with
+ *             little skew: First, subscribe to all of them at once, and
+ *             confirm each subscription.  Then send all the "dc"
+ *             messages in one burst (task_send_burst()), collect the
+ *             "sf" confirmations, and retry only the devices which did
+ *             not confirm.  Return the count of failed devices.
+ */
+
+int sw_group( orv_data_t *origin_p, int task_nr)
+{
+  int fail_cnt = 0;
+  int nam_len;
+  int pass;
+  int pend_cnt;
+  int rsp;
+  char nam_buf[ DEV_NAME_LEN+ 1];
+  orv_data_t *orv_data_p;
+
+  /* Send Subscribe messages.  Expect some "cl" responses. */
+  orv_data_p = origin_p->next;
+  while (orv_data_p != origin_p)
+  {
+    orv_data_p->pend = ((orv_data_p->cnt_flg != 0) ? 1 : 0);
+    orv_data_p = orv_data_p->next;
+  }
+  rsp = 0;
+  task_multi( RSP_CL, TSK_SUBSCRIBE, TASK_RETRY_MAX, &rsp, origin_p,
+   &pend_cnt);
+
+  /* Pass 0: Subscribed?  Pass 1: Switched? */
+  for (pass = 0; pass <= 1; pass++)
+  {
+    orv_data_p = origin_p->next;
+    while (orv_data_p != origin_p)
+    {
+      if (orv_data_p->cnt_flg != 0)
+      {
+        if (orv_data_p->pend != 0)
+        {
+          dev_name( orv_data_p, nam_buf, &nam_len);
+          nam_buf[ nam_len] = '\0';
+          fprintf( stderr, "%s: %s not confirmed: >%s<.\n", PROGRAM_NAME,
+           ((pass == 0) ? "Subscribe" : "Switch"), nam_buf);
+          fail_cnt++;
+          orv_data_p->pend = 0;
+        }
+        else if (pass == 0)
+        {
+          orv_data_p->pend = 1;
+        }
+      }
+      orv_data_p = orv_data_p->next;
+    }
+
+    if (pass == 0)
+    { /* Send Device control messages (burst).  Expect "sf" responses. */
+      rsp = 0;
+      task_multi( RSP_SF, task_nr, TASK_RETRY_MAX, &rsp, origin_p,
+       &pend_cnt);
+    }
+  }
+
+  if ((debug& DBG_ACT) != 0)
+  {
+    fprintf( stderr, " sw_group(end).  fail_cnt = %d.\n", fail_cnt);
+  }
+  return fail_cnt;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* watch_sig(): Signal handler (watch): Stop watching. */
+
+void watch_sig( int sig)
+{
+  (void)sig;                                    /* (Unused.) */
+  watch_stop = 1;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* wheel_init(): Place the marked LL members (cnt_flg) on a timing
+ *               wheel, spread evenly over the slots (one rotation =
+ *               WATCH_RENEW), starting one rotation from now.
+ */
+
+void wheel_init( orv_wheel_t *wheel_p, orv_data_t *origin_p)
+{
+  int i = 0;
+  int n;
+  orv_data_t *orv_data_p;
+
+  memset( wheel_p, 0, sizeof( *wheel_p));
+  wheel_p->t_cur = ms_time();
+
+  n = 0;
+  orv_data_p = origin_p->next;
+  while (orv_data_p != origin_p)
+  {
+    n += ((orv_data_p->cnt_flg != 0) ? 1 : 0);
+    orv_data_p = orv_data_p->next;
+  }
+
+  orv_data_p = origin_p->next;
+  while (orv_data_p != origin_p)
+  {
+    if (orv_data_p->cnt_flg != 0)
+    { /* Slot: (i/n) of the way around.  (Link at the chain head.) */
+      int slot;
+
+      slot = (int)((long)i* WHEEL_SLOTS/ n);
+      orv_data_p->wheel_next = wheel_p->slot[ slot];
+      wheel_p->slot[ slot] = orv_data_p;
+      i++;
+    }
+    orv_data_p = orv_data_p->next;
+  }
+}
+
+#ifdef USE_DAEMON
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* wheel_add(): Place one (just subscribed) LL member on a timing wheel,
+ *              on the current slot (so, renewed one rotation from now).
+ */
+
+void wheel_add( orv_wheel_t *wheel_p, orv_data_t *orv_data_p)
+{
+  orv_data_p->wheel_next = wheel_p->slot[ wheel_p->cur];
+  wheel_p->slot[ wheel_p->cur] = orv_data_p;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* wheel_prune(): Remove from a timing wheel the members which are no
+ *                longer on the LL (found by MAC address).  Return the
+ *                count removed.
+ */
+
+int wheel_prune( orv_wheel_t *wheel_p, orv_data_t *origin_p)
+{
+  int cnt = 0;
+  int slot;
+  orv_data_t **link_pp;
+
+  for (slot = 0; slot < WHEEL_SLOTS; slot++)
+  {
+    link_pp = &wheel_p->slot[ slot];
+    while (*link_pp != NULL)
+    {
+      if (orv_data_find_mac( origin_p, (*link_pp)->mac_addr) != *link_pp)
+      { /* Gone.  Unlink it. */
+        *link_pp = (*link_pp)->wheel_next;
+        cnt++;
+      }
+      else
+      {
+        link_pp = &(*link_pp)->wheel_next;
+      }
+    }
+  }
+  return cnt;
+}
+
+#endif /* def USE_DAEMON */
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* wheel_advance(): Advance a timing wheel to the present, and send the
+ *                  renewals ("cl", "hb") to the members on each slot
+ *                  passed (in one burst per slot).  (The members stay
+ *                  on their slots for the next rotation.)  Return (in
+ *                  *wait_ms_p) the time until the next slot.
+ */
+
+int wheel_advance( SOCKET sock_orv, orv_wheel_t *wheel_p,
+ orv_data_t *origin_p, int *wait_ms_p)
+{
+  int sts = 0;
+  unsigned long now;
+
+  now = ms_time();
+  while ((sts == 0) && (now- wheel_p->t_cur >= WHEEL_TICK))
+  {
+    wheel_p->t_cur += WHEEL_TICK;
+    wheel_p->cur = (wheel_p->cur+ 1)% WHEEL_SLOTS;
+    if (wheel_p->slot[ wheel_p->cur] != NULL)
+    {
+      sts = task_send_burst( sock_orv, TSK_SUBSCRIBE, origin_p, 0,
+       wheel_p->slot[ wheel_p->cur]);
+      if (sts == 0)
+      {
+        sts = task_send_burst( sock_orv, TSK_HEARTBEAT, origin_p, 0,
+         wheel_p->slot[ wheel_p->cur]);
+      }
+    }
+  }
+  *wait_ms_p = (int)(WHEEL_TICK- (now- wheel_p->t_cur));
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* watch_devices(): Watch the marked LL members (cnt_flg): Keep one
+ *                  socket open, subscribe to the devices, and report
+ *                  each state change (unsolicited "sf", or a renewal
+ *                  "cl" response) as it arrives (see msg_process()),
+ *                  until interrupted.  A timing wheel spreads the
+ *                  renewals (subscription and heartbeat, every
+ *                  WATCH_RENEW seconds) evenly over time.
+ */
+
+int watch_devices( orv_data_t *origin_p)
+{
+  int rsp;
+  int sts = 0;
+  int wait_ms = WHEEL_TICK;
+  unsigned int sock_drops = 0;  /* Kernel rcv-queue drops (cumulative). */
+  SOCKET sock_orv;
+  orv_data_t *orv_data_p;
+  static orv_wheel_t wheel;     /* Renewal timing wheel. */
+
+  sock_orv = task_sock_open( 0, origin_p->cnt_flg);
+  if (BAD_SOCKET( sock_orv))
+  {
+    sts = -1;
+  }
+  else
+  {
+    watch_stop = 0;
+    signal( SIGINT, watch_sig);
+    signal( SIGTERM, watch_sig);
+    watch_fp = stdout;
+
+    /* Send Subscribe messages (all, now).  ("cl" responses arrive
+     * below.)  Then schedule the renewals.
+     */
+    orv_data_p = origin_p->next;
+    while (orv_data_p != origin_p)
+    {
+      orv_data_p->pend = ((orv_data_p->cnt_flg != 0) ? 1 : 0);
+      orv_data_p = orv_data_p->next;
+    }
+    sts = task_send_burst( sock_orv, TSK_SUBSCRIBE, origin_p, 0, NULL);
+    wheel_init( &wheel, origin_p);
+  }
+
+  while ((sts == 0) && (watch_stop == 0))
+  {
+    /* Process whatever arrives until the next wheel slot. */
+    rsp = 0;
+    sts = task_recv( sock_orv, 0, &rsp, NULL, origin_p, NULL,
+     (OMAX( 1, wait_ms)* 1000L), &sock_drops);
+    if ((sts < 0) && (errno == EINTR))
+    {
+      sts = 0;                                  /* Interrupted (signal). */
+    }
+
+    if ((sts == 0) && (watch_stop == 0))
+    { /* Send any renewals due. */
+      sts = wheel_advance( sock_orv, &wheel, origin_p, &wait_ms);
+    }
+  }
+
+  watch_fp = NULL;
+  if (!BAD_SOCKET( sock_orv))
+  {
+    signal( SIGINT, SIG_DFL);
+    signal( SIGTERM, SIG_DFL);
+    CLOSE_SOCKET( sock_orv);
+  }
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* query_devices(): Query devices to populate the orv_data LL.
+ *                  QRY_CACHED: Skip devices which already have
+ *                  (cached) table 4 data.
+ *                  QRY_INDEX: Read the (short) table 1 index first,
+ *                  and, for a device with (cached) table 4 data, read
+ *                  table 4 only if the index version flag for table 4
+ *                  differs from the one seen (ivers) when the cached
+ *                  table 4 data were read.
+ *                  A device with a fresh cached state ("maxage=") and
+ *                  (cached) table 4 data is always skipped.
+ */
+
+int query_devices( int single, orv_data_t *origin_p, int qry_flg)
+{
+  int rsp;
+  int sts = 0;
+  int vers;
+  orv_data_t *orv_data_p;
+  orv_tbl_t tbl;
+
+  if ((debug& DBG_DEV) != 0)
+  {
+    fprintf( stderr, " query_devs(0).  single = %08x .\n", single);
+  }
+
+  orv_data_p = origin_p->next;      /* Start with first (real?) LL mmbr. */
+  while (orv_data_p != origin_p)    /* Quit when back to the origin. */
+  {
+    if ((debug& DBG_DEV) != 0)
+    {
+      fprintf( stderr, " query_devs(1).  cnt_flg = %d.\n", orv_data_p->cnt_flg);
+      fprintf_device( stderr, 0, orv_data_p);
+    }
+
+    if (((single == 0) || (orv_data_p->cnt_flg != 0)) &&
+     (((qry_flg& QRY_CACHED) == 0) || (orv_data_p->rt4.have == 0)) &&
+     ((orv_data_p->fresh == 0) || (orv_data_p->rt4.have == 0)))
+    {
+      /* Send Subscribe message.  Expect some "cl" response. */
+      rsp = 0;
+      sts = task_retry( RSP_CL, TSK_SUBSCRIBE, &rsp, NULL,
+       origin_p, orv_data_p);
+      if (sts != 0)
+      {
+        fprintf( stderr, "%s: Read table: socket.  sts = %d.\n",
+         PROGRAM_NAME, sts);
+        break;
+      }
+
+      vers = -1;
+      if ((qry_flg& QRY_INDEX) != 0)
+      {
+        /* Send Read table: index message.  Expect some "rt" response. */
+        memset( &tbl, 0, sizeof( tbl));
+        rsp = 0;
+        sts = task_retry( RSP_RT, TSK_RT_INDEX, &rsp, &tbl,
+         origin_p, orv_data_p);
+        if (tbl.rbuf != NULL)
+        {
+          vers = rt_index_vers( tbl.rbuf, 4);
+          rbuf_release( tbl.rbuf);
+        }
+        if (sts != 0)
+        {
+          fprintf( stderr, "%s: Read table: index.  sts = %d.\n",
+           PROGRAM_NAME, sts);
+          break;
+        }
+
+        if ((debug& DBG_DEV) != 0)
+        {
+          fprintf( stderr, " query_devs(2).  ivers = %d, index = %d.\n",
+           (orv_data_p->ivers- 1), vers);
+        }
+      }
+
+      if ((vers >= 0) && (orv_data_p->rt4.have != 0) &&
+       (orv_data_p->ivers == vers+ 1))
+      { /* Table 4 unchanged.  Keep the cached data. */
+        metrics.rt_skip++;
+      }
+      else
+      {
+        /* Send Read table: socket message.  Expect some "rt" response. */
+        rsp = 0;
+        metrics.rt_read++;
+        sts = task_retry( RSP_RT, TSK_RT_SOCKET, &rsp, NULL,
+         origin_p, orv_data_p);
+        if (sts != 0)
+        {
+          fprintf( stderr, "%s: Read table: socket.  sts = %d.\n",
+           PROGRAM_NAME, sts);
+          break;
+        }
+        orv_data_p->ivers = vers+ 1;    /* (0 (unknown), if no index.) */
+      }
+    }
+    orv_data_p = orv_data_p->next;  /* Advance to the next member. */
+  } /* while */
+
+  if ((debug& DBG_DEV) != 0)
+  {
+    fprintf( stderr, " query_devs(end).  sts = %d.\n", sts);
+  }
+  return sts;
+}
+
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* requery_missing(): Gap-fill: Use (parallel, unicast) Unit Discovery
+ *                    on the LL members which did not respond to the
+ *                    latest broadcast query.  Return the count of
+ *                    members queried, and (in *miss_cnt_p) the count
+ *                    which still did not respond.
+ */
+
+int requery_missing( orv_data_t *origin_p, int *miss_cnt_p)
+{
+  int cnt = 0;
+  int rsp;
+  orv_data_t *orv_data_p;
+
+  orv_data_p = origin_p->next;      /* Start with first (real?) LL mmbr. */
+  while (orv_data_p != origin_p)    /* Quit when back to the origin. */
+  {
+    orv_data_p->pend = ((orv_data_p->seen == 0) ? 1 : 0);
+    if (orv_data_p->pend != 0)
+    {
+      cnt++;
+      if ((debug& DBG_DEV) != 0)
+      {
+        fprintf( stderr, " requery_missing().\n");
+        fprintf_device( stderr, 0, orv_data_p);
+      }
+    }
+    orv_data_p = orv_data_p->next;  /* Advance to the next member. */
+  } /* while */
+
+  *miss_cnt_p = 0;
+  if (cnt > 0)
+  {
+    /* Send Unit Discovery messages.  Expect some "qg" responses. */
+    metrics.requery += cnt;
+    rsp = 0;
+    task_multi( RSP_QG, TSK_UNIT_DISC, GAP_RETRY_MAX, &rsp,
+     origin_p, miss_cnt_p);
+  }
+  return cnt;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* cache_fresh(): Mark (fresh) the LL members whose cached state was
+ *                seen within max_age (ms).  Return the count.
+ */
+
+int cache_fresh( orv_data_t *origin_p)
+{
+  int cnt = 0;
+  double now;
+  orv_data_t *orv_data_p;
+
+  now = wall_time();
+  orv_data_p = origin_p->next;      /* Start with first (real?) LL mmbr. */
+  while (orv_data_p != origin_p)    /* Quit when back to the origin. */
+  {
+    orv_data_p->fresh = (((max_age >= 0) && (orv_data_p->state >= 0) &&
+     (orv_data_p->state_t > 0.0) &&
+     ((now- orv_data_p->state_t)* 1000.0 <= (double)max_age)) ? 1 : 0);
+    cnt += orv_data_p->fresh;
+    orv_data_p = orv_data_p->next;  /* Advance to the next member. */
+  } /* while */
+
+  if ((debug& DBG_DEV) != 0)
+  {
+    fprintf( stderr, " cache_fresh().  fresh = %d.\n", cnt);
+  }
+  return cnt;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* catalog_devices_disc(): Use Global Discovery (broadcast) to populate
+ *                         the orv_data LL.  If an inventory cache is
+ *                         specified, then its devices form the expected
+ *                         set: any which do not respond to the broadcast
+ *                         are queried directly (gap-fill), and any which
+ *                         still do not respond are discarded.
+ *                         The broadcast receive loop ends when the
+ *                         expected device count (the larger of the cache
+ *                         count and expect_n) have responded.
+ *                         With "maxage=", if any cached device states are
+ *                         fresh, then the broadcast is skipped, and only
+ *                         the stale devices are queried (gap-fill).
+ */
+
+int catalog_devices_disc( orv_data_t *origin_p, char *cache_name,
+ int expect_n)
+{
+  int expect_cnt;
+  int hit_cnt;
+  int miss_cnt;
+  int pend_cnt;
+  int rsp;
+  int sts = 0;
+  FILE *fp;
+  orv_data_t *orv_data_p;
+  orv_data_t *orv_data_next_p;
+
+  /* Load the expected set from the inventory cache, if any. */
+  if ((cache_name != NULL) && ((fp = fopen( cache_name, "r")) != NULL))
+  {
+    int line_nr;
+    char err_tkn[ CLG_LINE_MAX];
+
+    sts = catalog_devices_ddf( fp, &line_nr, err_tkn, origin_p);
+    fclose( fp);
+    if (sts != 0)
+    {
+      fprintf( stderr,
+       "%s: Bad inventory cache (%d) at line %d (ignored): %s\n",
+       PROGRAM_NAME, sts, line_nr, cache_name);
+      sts = 0;
+    }
+  }
+  expect_cnt = OMAX( (int)origin_p->cnt_flg, expect_n);
+  hit_cnt = cache_fresh( origin_p);
+  metrics.cache_hit = hit_cnt;
+
+  /* Clear the responded flags of any already known LL members, and
+   * mark them (and any new devices) as pending.  A fresh cached device
+   * counts as responded.
+   */
+  orv_data_p = origin_p->next;
+  while (orv_data_p != origin_p)
+  {
+    orv_data_p->seen = orv_data_p->fresh;
+    orv_data_p->pend = 1;
+    orv_data_p = orv_data_p->next;
+  }
+  origin_p->pend = 1;
+  pend_cnt = expect_cnt;
+
+  /* Broadcast query (Global discovery).  Expect some "qa" response.
+   * With an expected set, broadcast only once, and leave any missing
+   * devices to the gap-fill queries.  With fresh cached devices, leave
+   * all the (stale) devices to the gap-fill queries.
+   */
+  rsp = 0;
+  if (hit_cnt > 0)
+  {
+    pend_cnt = 0;
+  }
+  else if (expect_cnt > 0)
+  {
+    sts = task( TSK_GLOB_DISC_B, RSP_QA, &rsp, NULL, origin_p, origin_p,
+     &pend_cnt);
+  }
+  else
+  {
+    sts = task_retry( RSP_QA, TSK_GLOB_DISC_B, &rsp, NULL,
+     origin_p, origin_p);
+  }
+
+  if (sts == 0)
+  { /* Re-query only the expected devices which are missing.  If some
+     * responses were dropped, or fewer than expect_n devices responded,
+     * but no expected device is missing, then the missing responses
+     * came from unknown devices, which only another broadcast query can
+     * find.
+     */
+    if ((requery_missing( origin_p, &miss_cnt) == 0) &&
+     (((rsp& RSP_OVF) != 0) || (pend_cnt > 0)))
+    {
+      metrics.rebcast++;
+      rsp = 0;
+      sts = task( TSK_GLOB_DISC_B, RSP_QA, &rsp, NULL, origin_p, origin_p,
+       ((pend_cnt > 0) ? &pend_cnt : NULL));
+    }
+
+    if ((debug& DBG_DEV) != 0)
+    {
+      fprintf( stderr, " Devices expected: %d, missing: %d.\n",
+       expect_cnt, miss_cnt);
+    }
+
+    if (miss_cnt > 0)
+    { /* Discard expected (cached) devices which did not respond. */
+      orv_data_p = origin_p->next;
+      while (orv_data_p != origin_p)
+      {
+        orv_data_next_p = orv_data_p->next;
+        if (orv_data_p->seen == 0)
+        {
+          orv_data_unlink( origin_p, orv_data_p);
+        }
+        orv_data_p = orv_data_next_p;
+      }
+    }
+    origin_p->seen = 1;                 /* Origin: Live inventory taken. */
+  }
+  origin_p->pend = 0;
+
+  if ((debug& DBG_DEV) != 0)
+  {
+    fprintf( stderr, " catalog_devices_disc(end).  sts = %d.\n", sts);
+  }
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* cache_write(): Write the orv_data LL to the inventory cache file. */
+
+int cache_write( char *cache_name, orv_data_t *origin_p)
+{
+  int sts = 0;
+  FILE *fp;
+
+  fp = fopen( cache_name, "w");
+  if (fp == NULL)
+  {
+    fprintf( stderr, "%s: Open (write) failed: %s\n",
+     PROGRAM_NAME, cache_name);
+    show_errno( PROGRAM_NAME);
+    sts = -1;
+  }
+  else
+  {
+    if (fprintf_device_list( fp, FDL_CACHE, origin_p) < 0)
+    {
+      sts = -1;
+    }
+    if (fclose( fp) != 0)
+    {
+      sts = -1;
+    }
+    if (sts != 0)
+    {
+      fprintf( stderr, "%s: Write failed: %s\n", PROGRAM_NAME, cache_name);
+    }
+  }
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* catalog_devices_live(): Use Global Discovery to populate the orv_data LL,
+ *                         then query all the devices.  (See
+ *                         query_devices() for qry_flg.)
+ */
+
+int catalog_devices_live( orv_data_t *origin_p, char *cache_name,
+ int expect_n, int qry_flg)
+{
+  int sts;
+
+  sts = catalog_devices_disc( origin_p, cache_name, expect_n);
+
+  if (sts == 0)
+  {
+    if (origin_p->cnt_flg == 0)
+    {
+      fprintf( stderr, "%s: No devices found (loc=cdl).\n", PROGRAM_NAME);
+      errno = ENXIO;
+      sts = -1;
+    }
+    else
+    {
+      if ((debug& DBG_DEV) != 0)
+      {
+        fprintf( stderr, " Devices found: %d.\n", origin_p->cnt_flg);
+      }
+
+      sts = query_devices( 0, origin_p, qry_flg);     /* Query devs. */
+    }
+  }
+
+  if ((debug& DBG_DEV) != 0)
+  {
+    fprintf( stderr, " catalog_devices_live(end).  sts = %d.\n", sts);
+  }
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* keyword_match(): Match abbreviated keyword against keyword array. */
+
+int keyword_match( char *arg, int kw_cnt, char **kw_array)
+{
+  int cmp_len;
+  int kw_ndx;
+  int match = -1;
+
+  cmp_len = strlen( arg);
+  for (kw_ndx = 0; kw_ndx < kw_cnt; kw_ndx++)
+  {
+    if (STRNCASECMP( arg, kw_array[ kw_ndx], cmp_len) == 0)
+    {
+      if (match < 0)
+      {
+        match = kw_ndx;         /* Record first match. */
+      }
+      else
+      {
+        match = -2;             /* Record multiple match, */
+        break;                  /* and quit early. */
+      }
+    }
+  }
+  return match;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#ifdef USE_DAEMON
+
+/* ctl_wait(): Wait (up to tmo_ms) for a (control) socket to become
+ *             readable.  Return the select() result.
+ */
+
+int ctl_wait( int fd, long tmo_ms)
+{
+  fd_set fds;
+  struct timeval tv;
+
+  FD_ZERO( &fds);
+  FD_SET( fd, &fds);
+  tv.tv_sec = tmo_ms/ 1000;
+  tv.tv_usec = (tmo_ms% 1000)* 1000;
+  return select( (fd+ 1), &fds, NULL, NULL, &tv);
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* listen_fds(): Adopt the sockets passed by a service manager (socket
+ *               activation: LISTEN_PID, LISTEN_FDS, from fd
+ *               LISTEN_FDS_START): a Unix-domain stream socket is the
+ *               control socket, an IP stream socket is the HTTP API
+ *               socket, and a UDP socket (port PORT_ORV) is the device
+ *               socket.  Any other socket is closed.  The variables are
+ *               removed, so that no child process sees them.
+ *               Return the count of sockets adopted.
+ */
+
+int listen_fds( void)
+{
+  int cnt = 0;
+  int fd;
+  int fd_cnt;
+  int type;
+  char *cp;
+  RECVFROM_6 len;
+  struct sockaddr_storage addr;
+
+  cp = getenv( "LISTEN_PID");
+  if ((cp == NULL) || (strtol( cp, NULL, 10) != (long)getpid()))
+  {
+    return 0;                   /* Not for us. */
+  }
+  cp = getenv( "LISTEN_FDS");
+  fd_cnt = ((cp == NULL) ? 0 : atoi( cp));
+
+  for (fd = LISTEN_FDS_START; fd < LISTEN_FDS_START+ fd_cnt; fd++)
+  {
+    fcntl( fd, F_SETFD, FD_CLOEXEC);
+    len = sizeof( type);
+    if (getsockopt( fd, SOL_SOCKET, SO_TYPE, (void *)&type, &len) != 0)
+    {
+      type = -1;
+    }
+    len = sizeof( addr);
+    if (getsockname( fd, (struct sockaddr *)&addr, &len) != 0)
+    {
+      addr.ss_family = AF_UNSPEC;
+    }
+
+    if ((addr.ss_family == AF_UNIX) && (type == SOCK_STREAM) &&
+     (sock_ctl_inh < 0))
+    {
+      sock_ctl_inh = fd;
+    }
+    else if ((addr.ss_family == AF_INET) && (type == SOCK_STREAM) &&
+     (sock_http < 0))
+    {
+      set_socket_noblock( fd);
+      sock_http = fd;
+    }
+    else if ((addr.ss_family == AF_INET) && (type == SOCK_DGRAM) &&
+     (ntohs( ((struct sockaddr_in *)&addr)->sin_port) == PORT_ORV) &&
+     BAD_SOCKET( sock_orv_inh))
+    { /* Shared by every task (dup()).  Configure it once, here. */
+      int sock_opt_snd = 1;
+
+      set_socket_rcvbuf( fd, RCVBUF_DEV_MIN);
+      if (setsockopt( fd, SOL_SOCKET, SO_BROADCAST, &sock_opt_snd,
+       sizeof( sock_opt_snd)) < 0)
+      {
+        fprintf( stderr, "%s: setsockopt( snd-bc1) failed.\n",
+         PROGRAM_NAME);
+        show_errno( PROGRAM_NAME);
+      }
+      sock_orv_inh = fd;
+    }
+    else
+    {
+      fprintf( stderr, "%s: Inherited socket (fd %d) not usable (closed).\n",
+       PROGRAM_NAME, fd);
+      close( fd);
+      continue;
+    }
+    cnt++;
+  }
+
+  if ((debug& DBG_ACT) != 0)
+  {
+    fprintf( stderr,
+     " listen_fds().  fds = %d, ctl = %d, http = %d, orv = %d.\n",
+     fd_cnt, sock_ctl_inh, sock_http, (int)sock_orv_inh);
+  }
+
+  unsetenv( "LISTEN_PID");
+  unsetenv( "LISTEN_FDS");
+  unsetenv( "LISTEN_FDNAMES");
+  return cnt;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* ctl_open(): Create, bind, and listen on the daemon control socket
+ *             (Unix domain).  Return -1, if error.
+ */
+
+int ctl_open( char *ctl_name)
+{
+  int sock_ctl = -1;
+  struct stat st;
+  struct sockaddr_un addr;
+
+  if (strlen( ctl_name) >= sizeof( addr.sun_path))
+  {
+    fprintf( stderr, "%s: Control socket name too long: %s\n",
+     PROGRAM_NAME, ctl_name);
+    errno = ENAMETOOLONG;
+  }
+  else if ((stat( ctl_name, &st) == 0) && !S_ISSOCK( st.st_mode))
+  {
+    fprintf( stderr, "%s: Control socket name exists (not a socket): %s\n",
+     PROGRAM_NAME, ctl_name);
+    errno = EEXIST;
+  }
+  else
+  {
+    memset( &addr, 0, sizeof( addr));
+    addr.sun_family = AF_UNIX;
+    strcpy( addr.sun_path, ctl_name);
+    unlink( ctl_name);                  /* Remove any stale socket. */
+
+    sock_ctl = socket( AF_UNIX, SOCK_STREAM, 0);
+    if (sock_ctl < 0)
+    {
+      fprintf( stderr, "%s: socket() (ctl) failed.\n", PROGRAM_NAME);
+      show_errno( PROGRAM_NAME);
+    }
+    else if ((bind( sock_ctl, (struct sockaddr *)&addr, sizeof( addr)) != 0) ||
+     (listen( sock_ctl, CTL_REQ_MAX) != 0))
+    {
+      fprintf( stderr, "%s: bind()/listen() (ctl) failed: %s\n",
+       PROGRAM_NAME, ctl_name);
+      show_errno( PROGRAM_NAME);
+      close( sock_ctl);
+      sock_ctl = -1;
+    }
+  }
+  return sock_ctl;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* sub_open(): Make a control connection a change subscriber.  Its
+ *             filter is the rest of the "subscribe" request line
+ *             (strtok() continues): "mac=addr[,addr...]", "name=glob"
+ *             (or a plain glob), "net=addr[/bits]", "type=name|code".
+ *             Every filter given must match.  Return NULL, if
+ *             subscribed, else a message.
+ */
+
+const char *sub_open( int fd)
+{
+  int bits;
+  int i;
+  char *nxt;
+  char *tkn;
+  char *val;
+  const char *msg = NULL;
+  orv_sub_t *sub_p = NULL;
+
+  for (i = 0; (i < SUB_MAX) && (sub_p == NULL); i++)
+  {
+    if (subs[ i].fd < 0)
+    {
+      sub_p = &subs[ i];
+    }
+  }
+  if (sub_p == NULL)
+  {
+    return "Too many subscribers.";
+  }
+
+  sub_p->mac_cnt = 0;
+  sub_p->name[ 0] = '\0';
+  sub_p->net.s_addr = 0;
+  sub_p->mask.s_addr = 0;
+  sub_p->type = -1;
+  sub_p->q_head = 0;
+  sub_p->q_cnt = 0;
+  sub_p->q_ofs = 0;
+  sub_p->lost = 0;
+
+  while ((msg == NULL) && ((tkn = strtok( NULL, " \t\r\n")) != NULL))
+  {
+    val = strchr( tkn, '=');
+    if (val == NULL)
+    { /* Plain name pattern. */
+      val = tkn;
+      tkn = "name";
+    }
+    else
+    {
+      *(val++) = '\0';
+    }
+
+    if (strcmp( tkn, "mac") == 0)
+    {
+      while ((msg == NULL) && (val != NULL))
+      {
+        nxt = strchr( val, ',');
+        if (nxt != NULL)
+        {
+          *(nxt++) = '\0';
+        }
+        if (sub_p->mac_cnt >= SUB_MAC_MAX)
+        {
+          msg = "Too many MAC addresses.";
+        }
+        else if (parse_mac( val, sub_p->mac[ sub_p->mac_cnt]) != 0)
+        {
+          msg = "Bad MAC address.";
+        }
+        else
+        {
+          sub_p->mac_cnt++;
+        }
+        val = nxt;
+      }
+    }
+    else if (strcmp( tkn, "name") == 0)
+    {
+      if (strlen( val) > DEV_NAME_LEN)
+      {
+        msg = "Name pattern too long.";
+      }
+      else
+      {
+        strcpy( sub_p->name, val);
+      }
+    }
+    else if (strcmp( tkn, "net") == 0)
+    {
+      bits = 32;
+      nxt = strchr( val, '/');
+      if (nxt != NULL)
+      {
+        *(nxt++) = '\0';
+        bits = atoi( nxt);
+      }
+      if ((bits < 0) || (bits > 32) || (dns_resolve( val, &sub_p->net) != 0))
+      {
+        msg = "Bad subnet.";
+      }
+      else
+      {
+        sub_p->mask.s_addr = htonl( ((bits == 0) ? 0 :
+         (unsigned int)(0xffffffffU<< (32- bits))));
+        sub_p->net.s_addr &= sub_p->mask.s_addr;
+      }
+    }
+    else if (strcmp( tkn, "type") == 0)
+    {
+      sub_p->type = -1;
+      if (isdigit( (unsigned char)*val))
+      {
+        sub_p->type = atoi( val);
+      }
+      for (i = 0; (i <= ICON_MAX) && (sub_p->type < 0); i++)
       {
-        msg_out_len = sizeof( cmd_heartbeat);
-        memcpy( *msg_out, cmd_heartbeat, msg_out_len);
-        if (mac_addr != NULL)
+        if (STRNCASECMP( val, icon_name[ i], (strlen( icon_name[ i])+ 1))
+         == 0)
         {
-          memcpy( (*msg_out+ 6), mac_addr, MAC_ADDR_SIZE);      /* MAC addr. */
+          sub_p->type = i;
         }
       }
+      if (sub_p->type < 0)
+      {
+        msg = "Bad device type.";
+      }
+    }
+    else
+    {
+      msg = "Unknown subscribe filter.";
+    }
+  }
+
+  if (msg == NULL)
+  { /* Subscribed.  (Records are sent without blocking.) */
+    set_socket_noblock( fd);
+    sub_p->fd = fd;
+    metrics.sub_cnt++;
+  }
+  return msg;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* sub_close(): Close a subscriber's connection (fd = -1: free). */
+
+void sub_close( orv_sub_t *sub_p)
+{
+  if ((debug& DBG_ACT) != 0)
+  {
+    fprintf( stderr, " sub_close().  fd = %d, queued = %d, lost = %u.\n",
+     sub_p->fd, sub_p->q_cnt, sub_p->lost);
+  }
+  close( sub_p->fd);
+  sub_p->fd = -1;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* sub_flush(): Send a subscriber's queued change records, as far as its
+ *              connection takes them now (non-blocking).  Close the
+ *              connection, if it fails.
+ */
+
+void sub_flush( orv_sub_t *sub_p)
+{
+  int len;
+  ssize_t bc;
+  char *rec;
+
+  while (sub_p->q_cnt > 0)
+  {
+    rec = sub_p->q[ sub_p->q_head];
+    len = strlen( rec);
+    bc = write( sub_p->fd, (rec+ sub_p->q_ofs), (len- sub_p->q_ofs));
+    if (bc < 0)
+    {
+      if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))
+      {
+        sub_close( sub_p);
+      }
+      break;
     }
-    else if (task_nr == TSK_SUBSCRIBE)
-    { /* Subscribe. */
-      str = "SUBSCRIBE";
-      *msg_out = malloc( sizeof( cmd_subs));
-      if (*msg_out != NULL)
+    sub_p->q_ofs += bc;
+    if (sub_p->q_ofs >= len)
+    { /* Record sent. */
+      sub_p->q_ofs = 0;
+      sub_p->q_head = (sub_p->q_head+ 1)% SUB_QUEUE_MAX;
+      sub_p->q_cnt--;
+      metrics.sub_rec++;
+    }
+  }
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* sub_queue(): Queue a change record for a subscriber.  If the queue
+ *              is full, then the record is dropped (counted), and,
+ *              when there is room again, a "lost" record (with the
+ *              count) is queued ahead of the next one.  (The receive
+ *              path never waits for a slow subscriber.)
+ */
+
+void sub_queue( orv_sub_t *sub_p, const char *rec)
+{
+  if ((sub_p->lost > 0) && (sub_p->q_cnt <= SUB_QUEUE_MAX- 2))
+  {
+    sprintf( sub_p->q[ (sub_p->q_head+ sub_p->q_cnt)% SUB_QUEUE_MAX],
+     "%.3f - - lost %u\n", wall_time(), sub_p->lost);
+    sub_p->q_cnt++;
+    sub_p->lost = 0;
+  }
+
+  if ((sub_p->lost > 0) || (sub_p->q_cnt >= SUB_QUEUE_MAX))
+  {
+    sub_p->lost++;
+    metrics.sub_lost++;
+  }
+  else
+  {
+    strcpy( sub_p->q[ (sub_p->q_head+ sub_p->q_cnt)% SUB_QUEUE_MAX], rec);
+    sub_p->q_cnt++;
+  }
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* sub_match(): Does a device match a subscriber's filter? */
+
+int sub_match( orv_sub_t *sub_p, orv_data_t *orv_data_p)
+{
+  int i;
+  int match = 1;
+  char nam_buf[ DEV_NAME_LEN+ 1];
+
+  if (sub_p->mac_cnt > 0)
+  {
+    match = 0;
+    for (i = 0; (i < sub_p->mac_cnt) && (match == 0); i++)
+    {
+      match = (memcmp( sub_p->mac[ i], orv_data_p->mac_addr,
+       MAC_ADDR_SIZE) == 0);
+    }
+  }
+  if ((match != 0) && (sub_p->name[ 0] != '\0'))
+  {
+    dev_name( orv_data_p, nam_buf, NULL);
+    match = (fnmatch( sub_p->name, nam_buf, 0) == 0);
+  }
+  if ((match != 0) &&
+   ((orv_data_p->ip_addr.s_addr& sub_p->mask.s_addr) != sub_p->net.s_addr))
+  {
+    match = 0;
+  }
+  if ((match != 0) && (sub_p->type >= 0) && (orv_data_p->type != sub_p->type))
+  {
+    match = 0;
+  }
+  return match;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* sub_event(): Form a change record, "time mac ip kind old new", and
+ *              queue it for every subscriber whose filter matches the
+ *              device.
+ */
+
+void sub_event( orv_data_t *orv_data_p, const char *kind,
+ const char *old, const char *new)
+{
+  int i;
+  unsigned int ia4;                     /* IP address (host order). */
+  char rec[ SUB_LINE_MAX];
+
+  ia4 = ntohl( orv_data_p->ip_addr.s_addr);
+  sprintf( rec,
+   "%.3f %02x:%02x:%02x:%02x:%02x:%02x %u.%u.%u.%u %s %s %s\n",
+   wall_time(),
+   orv_data_p->mac_addr[ 0], orv_data_p->mac_addr[ 1],
+   orv_data_p->mac_addr[ 2], orv_data_p->mac_addr[ 3],
+   orv_data_p->mac_addr[ 4], orv_data_p->mac_addr[ 5],
+   ((ia4/ 0x100/ 0x100/ 0x100)& 0xff), ((ia4/ 0x100/ 0x100)& 0xff),
+   ((ia4/ 0x100)& 0xff), (ia4& 0xff), kind, old, new);
+
+  for (i = 0; i < SUB_MAX; i++)
+  {
+    if ((subs[ i].fd >= 0) && (sub_match( &subs[ i], orv_data_p) != 0))
+    {
+      sub_queue( &subs[ i], rec);
+    }
+  }
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* sub_notify(): Compare the LL members with their change snapshots,
+ *               queue change records (state, name, IP address) for the
+ *               subscribers, take new snapshots, and send what the
+ *               subscriber connections will take.  A new member is only
+ *               noted, unless it is a known device (MAC address) at a
+ *               new IP address.  ("sort=ip" makes a new member for it.)
+ */
+
+void sub_notify( orv_data_t *origin_p)
+{
+  int i;
+  unsigned int ia4;                     /* IP address (host order). */
+  char nam_buf[ DEV_NAME_LEN+ 1];
+  char old_buf[ DEV_NAME_LEN+ 3];
+  char new_buf[ DEV_NAME_LEN+ 3];
+  orv_data_t *orv_data_p;
+  orv_data_t *twin_p;
+
+  for (orv_data_p = origin_p->next; orv_data_p != origin_p;
+   orv_data_p = orv_data_p->next)
+  {
+    dev_name( orv_data_p, nam_buf, NULL);
+    if (orv_data_p->noted == 0)
+    { /* New member.  Known MAC address (at another IP address)? */
+      for (twin_p = origin_p->next; twin_p != origin_p;
+       twin_p = twin_p->next)
       {
-        msg_out_len = sizeof( cmd_subs);
-        memcpy( *msg_out, cmd_subs, msg_out_len);
-        if (mac_addr != NULL)
-        {
-          memcpy( (*msg_out+ 6), mac_addr, MAC_ADDR_SIZE);      /* MAC addr. */
-          revcpy( (*msg_out+ 18), mac_addr, MAC_ADDR_SIZE);     /* MAC (rv). */
+        if ((twin_p->noted != 0) &&
+         (twin_p->note_ip.s_addr != orv_data_p->ip_addr.s_addr) &&
+         (mac_cmp( twin_p->mac_addr, orv_data_p->mac_addr) == 0))
+        { /* Moved.  (Same device: Keep its name and type.) */
+          if (nam_buf[ 0] == '\0')
+          {
+            memcpy( orv_data_p->name, twin_p->name, DEV_NAME_LEN);
+            orv_data_p->type = twin_p->type;
+            dev_name( orv_data_p, nam_buf, NULL);
+          }
+          ia4 = ntohl( twin_p->note_ip.s_addr);
+          sprintf( old_buf, "%u.%u.%u.%u",
+           ((ia4/ 0x100/ 0x100/ 0x100)& 0xff), ((ia4/ 0x100/ 0x100)& 0xff),
+           ((ia4/ 0x100)& 0xff), (ia4& 0xff));
+          ia4 = ntohl( orv_data_p->ip_addr.s_addr);
+          sprintf( new_buf, "%u.%u.%u.%u",
+           ((ia4/ 0x100/ 0x100/ 0x100)& 0xff), ((ia4/ 0x100/ 0x100)& 0xff),
+           ((ia4/ 0x100)& 0xff), (ia4& 0xff));
+          sub_event( orv_data_p, "ip", old_buf, new_buf);
+          break;                /* (The twin keeps its own snapshot.) */
         }
       }
     }
-    else if ((task_nr == TSK_SW_OFF) || (task_nr == TSK_SW_ON))
-    { /* Switch off/on. */
-      int val;
-
-      if (task_nr == TSK_SW_OFF)
+    else
+    { /* Known member.  What changed? */
+      if ((orv_data_p->note_state >= 0) && (orv_data_p->state >= 0) &&
+       (orv_data_p->state != orv_data_p->note_state))
+      {
+        sub_event( orv_data_p, "state",
+         ((orv_data_p->note_state == 0) ? "Off" : "On"),
+         ((orv_data_p->state == 0) ? "Off" : "On"));
+      }
+      if ((orv_data_p->note_name[ 0] != '\0') &&
+       (strcmp( orv_data_p->note_name, nam_buf) != 0))
       {
-        str = "SWITCH OFF";
-        val = 0;
+        sprintf( old_buf, ">%s<", orv_data_p->note_name);
+        sprintf( new_buf, ">%s<", nam_buf);
+        sub_event( orv_data_p, "name", old_buf, new_buf);
       }
-      else /* (task_nr == TSK_SW_ON) */
+      if (orv_data_p->note_ip.s_addr != orv_data_p->ip_addr.s_addr)
       {
-        str = "SWITCH ON";
-        val = 1;
+        ia4 = ntohl( orv_data_p->note_ip.s_addr);
+        sprintf( old_buf, "%u.%u.%u.%u",
+         ((ia4/ 0x100/ 0x100/ 0x100)& 0xff), ((ia4/ 0x100/ 0x100)& 0xff),
+         ((ia4/ 0x100)& 0xff), (ia4& 0xff));
+        ia4 = ntohl( orv_data_p->ip_addr.s_addr);
+        sprintf( new_buf, "%u.%u.%u.%u",
+         ((ia4/ 0x100/ 0x100/ 0x100)& 0xff), ((ia4/ 0x100/ 0x100)& 0xff),
+         ((ia4/ 0x100)& 0xff), (ia4& 0xff));
+        sub_event( orv_data_p, "ip", old_buf, new_buf);
       }
+    }
+
+    /* New snapshot. */
+    orv_data_p->noted = 1;
+    orv_data_p->note_state = orv_data_p->state;
+    orv_data_p->note_ip.s_addr = orv_data_p->ip_addr.s_addr;
+    strcpy( orv_data_p->note_name, nam_buf);
+  }
+
+  for (i = 0; i < SUB_MAX; i++)
+  {
+    if ((subs[ i].fd >= 0) && (subs[ i].q_cnt > 0))
+    {
+      sub_flush( &subs[ i]);
+    }
+  }
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* buf_add(): Append data to a growable buffer.  Return -1, if no
+ *            memory.
+ */
+
+int buf_add( orv_buf_t *buf_p, const char *data, size_t len)
+{
+  size_t size;
+  char *new_p;
+
+  if (buf_p->len+ len > buf_p->size)
+  {
+    size = OMAX( 1024, 2* buf_p->size);
+    while (size < buf_p->len+ len)
+    {
+      size *= 2;
+    }
+    new_p = realloc( buf_p->data, size);
+    if (new_p == NULL)
+    {
+      fprintf( stderr, "%s: realloc() failed [h].\n", PROGRAM_NAME);
+      return -1;
+    }
+    buf_p->data = new_p;
+    buf_p->size = size;
+  }
+  memcpy( (buf_p->data+ buf_p->len), data, len);
+  buf_p->len += len;
+  return 0;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* buf_str(): Append a string to a growable buffer. */
+
+int buf_str( orv_buf_t *buf_p, const char *str)
+{
+  return buf_add( buf_p, str, strlen( str));
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* json_str(): Append a string to a growable buffer as a JSON string
+ *             (quoted, escaped).
+ */
+
+int json_str( orv_buf_t *buf_p, const char *str)
+{
+  int sts;
+  char esc[ 8];
+
+  sts = buf_str( buf_p, "\"");
+  for (; (sts == 0) && (*str != '\0'); str++)
+  {
+    if ((*str == '"') || (*str == '\\'))
+    {
+      esc[ 0] = '\\';
+      esc[ 1] = *str;
+      sts = buf_add( buf_p, esc, 2);
+    }
+    else if ((unsigned char)*str < 0x20)
+    {
+      sprintf( esc, "\\u%04x", (unsigned char)*str);
+      sts = buf_str( buf_p, esc);
+    }
+    else
+    {
+      sts = buf_add( buf_p, str, 1);
+    }
+  }
+  if (sts == 0)
+  {
+    sts = buf_str( buf_p, "\"");
+  }
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* json_device(): Append a device (LL member) as a JSON object. */
+
+int json_device( orv_buf_t *buf_p, orv_data_t *orv_data_p)
+{
+  int sts;
+  unsigned int ia4;                     /* IP address (host order). */
+  char nam_buf[ DEV_NAME_LEN+ 1];
+  char tmp[ 64];
+
+  ia4 = ntohl( orv_data_p->ip_addr.s_addr);
+  sprintf( tmp,
+   "{\"mac\":\"%02x:%02x:%02x:%02x:%02x:%02x\",\"ip\":\"%u.%u.%u.%u\",",
+   orv_data_p->mac_addr[ 0], orv_data_p->mac_addr[ 1],
+   orv_data_p->mac_addr[ 2], orv_data_p->mac_addr[ 3],
+   orv_data_p->mac_addr[ 4], orv_data_p->mac_addr[ 5],
+   ((ia4/ 0x100/ 0x100/ 0x100)& 0xff), ((ia4/ 0x100/ 0x100)& 0xff),
+   ((ia4/ 0x100)& 0xff), (ia4& 0xff));
+  sts = buf_str( buf_p, tmp);
+
+  if (sts == 0)
+  {
+    sts = buf_str( buf_p, "\"name\":");
+  }
+  if (sts == 0)
+  {
+    dev_name( orv_data_p, nam_buf, NULL);
+    sts = json_str( buf_p, nam_buf);
+  }
+  if (sts == 0)
+  {
+    sts = buf_str( buf_p, ",\"type\":");
+  }
+  if (sts == 0)
+  {
+    if ((orv_data_p->type >= 0) && (orv_data_p->type <= ICON_MAX))
+    {
+      sts = json_str( buf_p, icon_name[ orv_data_p->type]);
+    }
+    else
+    {
+      sts = buf_str( buf_p, "null");
+    }
+  }
+  if (sts == 0)
+  {
+    sprintf( tmp, ",\"state\":%s,\"seen\":",
+     ((orv_data_p->state < 0) ? "null" :
+     ((orv_data_p->state == 0) ? "\"off\"" : "\"on\"")));
+    sts = buf_str( buf_p, tmp);
+  }
+  if (sts == 0)
+  {
+    if (orv_data_p->state_t > 0.0)
+    {
+      sprintf( tmp, "%.3f", orv_data_p->state_t);
+    }
+    else
+    {
+      strcpy( tmp, "null");
+    }
+    sts = buf_str( buf_p, tmp);
+  }
+  if (sts == 0)
+  {
+    sprintf( tmp, ",\"rtt_ms\":%u}", orv_data_p->rtt_ms);
+    sts = buf_str( buf_p, tmp);
+  }
+  return sts;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-      *msg_out = malloc( sizeof( cmd_switch));
-      if (*msg_out != NULL)
+/* json_str_scan(): Scan a JSON string (cp at its opening quote, simple
+ *                  escapes only), copying as much as fits (val_size)
+ *                  to val.  Set *len_p to its full length.  Return a
+ *                  pointer past its closing quote, or NULL, if bad.
+ */
+
+const char *json_str_scan( const char *cp, char *val, size_t val_size,
+ size_t *len_p)
+{
+  size_t len = 0;
+
+  for (cp++; (*cp != '"') && (*cp != '\0'); cp++)
+  {
+    if (*cp == '\\')
+    { /* Escape.  Only \" \\ \/. */
+      cp++;
+      if ((*cp != '"') && (*cp != '\\') && (*cp != '/'))
       {
-        msg_out_len = sizeof( cmd_switch);
-        memcpy( *msg_out, cmd_switch, msg_out_len);
-        if (mac_addr != NULL)
-        {
-          memcpy( (*msg_out+ 6), mac_addr, MAC_ADDR_SIZE);      /* MAC addr. */
-          (*msg_out)[ 22] = val;
-        }
+        return NULL;
       }
     }
-    else if ((task_nr == TSK_RT_SOCKET) || (task_nr == TSK_RT_TIMING))
-    { /* Read socket/timing data. */
-      unsigned short tbl;
-      unsigned short vers;
+    if (len+ 1 < val_size)
+    {
+      val[ len] = *cp;
+    }
+    len++;
+  }
+  val[ ((len < val_size) ? len : (val_size- 1))] = '\0';
+  *len_p = len;
+  return ((*cp == '"') ? (cp+ 1) : NULL);
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* json_get_str(): Find a string member ("key": "value") in a (flat)
+ *                 JSON object, member by member, and copy its value
+ *                 (simple escapes only).  Return 1, if found, 0, if
+ *                 not, -1, if bad or too long (val_size).
+ */
+
+int json_get_str( const char *json, const char *key, char *val,
+ size_t val_size)
+{
+  int found;
+  size_t len;
+  const char *cp;
+  char name[ 32];
+
+  cp = json+ strspn( json, " \t\r\n");
+  if (*cp != '{')
+  {
+    return -1;
+  }
+  cp++;
+  cp += strspn( cp, " \t\r\n");
+  if (*cp == '}')
+  {
+    return 0;                   /* Empty object. */
+  }
+
+  while (1)
+  {
+    /* Member name. */
+    if (*cp != '"')
+    {
+      return -1;
+    }
+    cp = json_str_scan( cp, name, sizeof( name), &len);
+    if (cp == NULL)
+    {
+      return -1;
+    }
+    found = (((len < sizeof( name)) && (strcmp( name, key) == 0)) ? 1 : 0);
+    cp += strspn( cp, " \t\r\n");
+    if (*cp != ':')
+    {
+      return -1;
+    }
+    cp++;
+    cp += strspn( cp, " \t\r\n");
 
-      if (task_nr == TSK_RT_SOCKET)
+    /* Value: a string, or a (flat) scalar. */
+    if (*cp == '"')
+    {
+      if (found != 0)
+      {
+        cp = json_str_scan( cp, val, val_size, &len);
+        return (((cp == NULL) || (len >= val_size)) ? -1 : 1);
+      }
+      cp = json_str_scan( cp, name, sizeof( name), &len);
+      if (cp == NULL)
       {
-        str = "RT-SOCKET";
-        /* tbl = 0x0004; */
-        /* vers = 0x0003; */
-        tbl = 0x0004;
-        vers = 0x0000;
+        return -1;
       }
-      else /* (task_nr == TSK_RT_TIMING) */
+    }
+    else if (found != 0)
+    {
+      return -1;                /* Not a string. */
+    }
+    else
+    {
+      cp += strcspn( cp, ",}{[\"");
+      if ((*cp != ',') && (*cp != '}'))
       {
-        str = "RT-TIMING";
-        tbl = 0x0003;
-        vers = 0x0003;
+        return -1;              /* Not flat. */
       }
+    }
+
+    cp += strspn( cp, " \t\r\n");
+    if (*cp == '}')
+    {
+      return 0;
+    }
+    if (*cp != ',')
+    {
+      return -1;
+    }
+    cp++;
+    cp += strspn( cp, " \t\r\n");
+  }
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* http_open(): Create, bind (localhost only), and listen on the daemon
+ *              HTTP API socket.  Return -1, if error.
+ */
+
+int http_open( int port)
+{
+  int on = 1;
+  int sock;
+  struct sockaddr_in addr;
+
+  sock = socket( AF_INET, SOCK_STREAM, 0);
+  if (sock < 0)
+  {
+    fprintf( stderr, "%s: socket() (http) failed.\n", PROGRAM_NAME);
+    show_errno( PROGRAM_NAME);
+    return -1;
+  }
+
+  setsockopt( sock, SOL_SOCKET, SO_REUSEADDR, (void *)&on, sizeof( on));
+  memset( &addr, 0, sizeof( addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons( port);
+  addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK);
+  if ((bind( sock, (struct sockaddr *)&addr, sizeof( addr)) != 0) ||
+   (listen( sock, HTTP_CONN_MAX) != 0))
+  {
+    fprintf( stderr, "%s: bind()/listen() (http) failed: port %d\n",
+     PROGRAM_NAME, port);
+    show_errno( PROGRAM_NAME);
+    close( sock);
+    return -1;
+  }
+  set_socket_noblock( sock);
+  return sock;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* http_close(): Close an HTTP API connection (fd = -1: free). */
+
+void http_close( orv_http_t *conn_p)
+{
+  close( conn_p->fd);
+  conn_p->fd = -1;
+  free( conn_p->out.data);
+  conn_p->out.data = NULL;
+  conn_p->out.len = 0;
+  conn_p->out.size = 0;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* http_accept(): Accept an HTTP API connection.  (None free: Close it.) */
+
+void http_accept( void)
+{
+  int fd;
+  int i;
+
+  fd = accept( sock_http, NULL, NULL);
+  if (fd < 0)
+  {
+    return;
+  }
+  for (i = 0; i < HTTP_CONN_MAX; i++)
+  {
+    if (http_conn[ i].fd < 0)
+    {
+      set_socket_noblock( fd);
+      http_conn[ i].fd = fd;
+      http_conn[ i].busy = 0;
+      http_conn[ i].hangup = 0;
+      http_conn[ i].in_len = 0;
+      http_conn[ i].out_ofs = 0;
+      metrics.http_conn++;
+      return;
+    }
+  }
+  close( fd);
+}
 
-      *msg_out = malloc( sizeof( cmd_read_table));
-      if (*msg_out != NULL)
-      {
-        msg_out_len = sizeof( cmd_read_table);
-        memcpy( *msg_out, cmd_read_table, msg_out_len);
-        if (mac_addr != NULL)
-        {
-          memcpy( (*msg_out+ 6), mac_addr, MAC_ADDR_SIZE);      /* MAC addr. */
-        }
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* http_flush(): Send an HTTP API connection's replies, as far as the
+ *               connection takes them now (non-blocking).  Close the
+ *               connection, if it fails, or if it's finished (hang-up,
+ *               nothing pending).
+ */
 
-        tbl = 0x0004;
-        vers = 0x0000;
+void http_flush( orv_http_t *conn_p)
+{
+  ssize_t bc;
 
-        (*msg_out)[ READ_TABLE_TABLE] =      tbl% 256;
-        (*msg_out)[ READ_TABLE_VERSION] =    vers% 256;
+  while (conn_p->out_ofs < conn_p->out.len)
+  {
+    bc = write( conn_p->fd, (conn_p->out.data+ conn_p->out_ofs),
+     (conn_p->out.len- conn_p->out_ofs));
+    if (bc < 0)
+    {
+      if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))
+      {
+        conn_p->hangup = 1;
+        conn_p->out_ofs = conn_p->out.len;      /* (Discard.) */
+        conn_p->in_len = 0;
       }
+      break;
     }
-
-    /* Insert message length into message. */
-    if (msg_out_len > 0)
+    conn_p->out_ofs += bc;
+  }
+  if (conn_p->out_ofs >= conn_p->out.len)
+  {
+    conn_p->out_ofs = 0;
+    conn_p->out.len = 0;
+    if ((conn_p->hangup != 0) && (conn_p->busy == 0) &&
+     (conn_p->in_len == 0))
     {
-      (*msg_out)[ 2] = (unsigned short)msg_out_len/ 256;
-      (*msg_out)[ 3] = (unsigned short)msg_out_len% 256;
+      http_close( conn_p);
     }
+  }
+}
 
-    if ((debug& DBG_MSO) != 0)
-    {
-      fprintf( stderr, " >> %s\n", str);
-      fprintf( stderr, " msg_len = %ld.\n", msg_out_len);
-      fprintf( stderr, " [2], [3] = %02x %02x\n",
-       (*msg_out)[ 2], (*msg_out)[ 3]);
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-      /* Display message to be sent. */
-      if (msg_out_len >= 6)
-      {
-        fprintf( stderr, "   Snd (%3ld)  %c  %c\n",
-         msg_out_len, (*msg_out)[ 4], (*msg_out)[ 5]);
-      }
-      msg_dump( *msg_out, msg_out_len);
-    }
+/* http_respond(): Queue an HTTP response (JSON body) on a connection. */
+
+void http_respond( orv_http_t *conn_p, int code, orv_buf_t *body_p)
+{
+  char hdr[ 160];
+  const char *reason;
+
+  reason = ((code == 200) ? "OK" : ((code == 400) ? "Bad Request" :
+   ((code == 404) ? "Not Found" : ((code == 405) ? "Method Not Allowed" :
+   ((code == 409) ? "Conflict" : ((code == 413) ? "Payload Too Large" :
+   ((code == 501) ? "Not Implemented" : "Bad Gateway")))))));
+  sprintf( hdr,
+   "HTTP/1.1 %d %s\r\nContent-Type: application/json\r\n\
+Content-Length: %lu\r\n%s\r\n",
+   code, reason, (unsigned long)body_p->len,
+   ((conn_p->hangup == 0) ? "" : "Connection: close\r\n"));
+  if (buf_str( &conn_p->out, hdr) == 0)
+  {
+    buf_add( &conn_p->out, body_p->data, body_p->len);
   }
-  return msg_out_len;
 }
 
 /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-/* task(): Perform a task: Send message, receive and process results. */
+/* http_error(): Queue an HTTP error response: {"error": msg}. */
 
-int task( int task_nr,                  /* Task number. */
-          int *rsp_p,                   /* Response type bit mask. */
-          unsigned char **tbl_p,        /* Table data. */
-          orv_data_t *origin_p,         /* orv_data origin. */
-          orv_data_t *target_p)         /* orv_data target. */
+void http_error( orv_http_t *conn_p, int code, const char *msg)
 {
-  unsigned char mac_addr[ MAC_ADDR_SIZE];       /* Orvibo MAC address. */
-  SOCKET sock_orv = INVALID_SOCKET;     /* Orvibo device socket. */
+  orv_buf_t body = { NULL, 0, 0 };
 
-  ssize_t bc;                   /* Byte count (send or receive). */
-  int sts;                      /* Status. */
+  buf_str( &body, "{\"error\":");
+  json_str( &body, msg);
+  buf_str( &body, "}\n");
+  http_respond( conn_p, code, &body);
+  free( body.data);
+}
 
-  int bcast = 0;                /* Broadcast message flag. */
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-  int mac_addr_ndx;
-  unsigned char msg_inp[ 1024]; /* Receive message buffer. */
-  unsigned char *msg_out;       /* Send message pointer. */
-  RECVFROM_6 sock_addr_len_rec;
-  ssize_t msg_out_len = 0;
-  struct sockaddr_in sock_addr_rec;
-  struct sockaddr_in sock_addr_snd;
+/* http_reply(): Queue the HTTP response to a performed (or rejected)
+ *               device request (switch, set), and resume the
+ *               connection's requests.
+ */
 
-  fd_set fds_rec;
-  struct timeval timeout_rec;
+void http_reply( orv_ctl_req_t *req_p)
+{
+  orv_buf_t body = { NULL, 0, 0 };
+  orv_http_t *conn_p;
 
-  unsigned short countdown;
-  unsigned short countdown_sts;
-  short icon_code;
-  int record_len;
-  int record_nr;
-  int version_id;
-  int hw_version;
-  int fw_version;
-  int cc_version;
-  int server_port;
-  time_t time_dev;
-  unsigned int server_ip;
-  unsigned int local_ip;
-  unsigned int local_gw;
-  unsigned int local_nm;
-  int remote_port;
-  char remote_name[ 84];
-  unsigned short table_nr;
-  unsigned short unk_nr;
-
-  char mac_addr_str[ 16];
-  char uid_str[ 16];
-  char remote_password[ PASSWORD_LEN+ 1];
-  char device_name[ DEV_NAME_LEN+ 1];
-  char device_type[ 12];
-
-  int save_orv_data;
-  int state_new;
-  int state_old;
+  conn_p = req_p->http;
+  if (req_p->sts == CTL_OK)
+  {
+    json_device( &body, req_p->dev);
+    buf_str( &body, "\n");
+    http_respond( conn_p, 200, &body);
+    free( body.data);
+  }
+  else
+  {
+    http_error( conn_p,
+     ((req_p->sts == CTL_SUPERSEDED) ? 409 :
+     ((req_p->sts == CTL_BAD) ? 400 : 502)),
+     ((req_p->msg == NULL) ? "Failed." : req_p->msg));
+  }
+  conn_p->busy = 0;
+  http_flush( conn_p);
+}
 
-  orv_data_t *orv_data_p;
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-#ifdef VMS
-  int oper_priv_save = -1;
-#endif /* def VMS */
+/* http_handle(): Handle one HTTP API request.  A lookup is answered
+ *                now.  A device request (switch, set) is added to the
+ *                daemon's requests (req), and the connection waits for
+ *                its reply (busy).
+ *
+ *                GET /devices
+ *                GET /devices/{mac}
+ *                POST /devices/{mac}/on, POST /devices/{mac}/off
+ *                PATCH /devices/{mac}  {"name": "...", "password": "..."}
+ */
 
-  sts = 0;
+void http_handle( orv_http_t *conn_p, char *method, char *target,
+ char *body, orv_data_t *origin_p, orv_ctl_req_t *req, int *req_cnt_p)
+{
+  int opr = -1;
+  int sts;
+  char *act;
+  unsigned char mac_addr[ MAC_ADDR_SIZE];
+  orv_buf_t resp = { NULL, 0, 0 };
+  orv_ctl_req_t *req_p;
+  orv_data_t *orv_data_p = NULL;
+
+  metrics.http_req++;
+  if (strcmp( target, "/devices") == 0)
+  {
+    if (strcmp( method, "GET") != 0)
+    {
+      http_error( conn_p, 405, "Method not allowed.");
+      return;
+    }
+    buf_str( &resp, "[");
+    for (orv_data_p = origin_p->next; orv_data_p != origin_p;
+     orv_data_p = orv_data_p->next)
+    {
+      if (orv_data_p != origin_p->next)
+      {
+        buf_str( &resp, ",\n ");
+      }
+      json_device( &resp, orv_data_p);
+    }
+    buf_str( &resp, "]\n");
+    http_respond( conn_p, 200, &resp);
+    free( resp.data);
+    return;
+  }
 
-  if ((debug& DBG_MSI) != 0)
+  if (strncmp( target, "/devices/", 9) != 0)
   {
-    fprintf( stderr,
-     " task(beg).  task_nr = %d, tbl_p = %sNULL.\n",
-     task_nr, ((tbl_p == NULL) ? "" : "non-"));
+    http_error( conn_p, 404, "Not found.");
+    return;
+  }
+  target += 9;
+  act = strchr( target, '/');
+  if (act != NULL)
+  {
+    *(act++) = '\0';
+  }
+  if (parse_mac( target, mac_addr) == 0)
+  {
+    orv_data_p = orv_data_find_mac( origin_p, mac_addr);
+  }
+  if (orv_data_p == NULL)
+  {
+    http_error( conn_p, 404, "Device not found.");
+    return;
   }
 
-  /* Form command message according to task_nr. */
+  if (act == NULL)
+  {
+    if (strcmp( method, "GET") == 0)
+    {
+      json_device( &resp, orv_data_p);
+      buf_str( &resp, "\n");
+      http_respond( conn_p, 200, &resp);
+      free( resp.data);
+      return;
+    }
+    else if (strcmp( method, "PATCH") == 0)
+    {
+      opr = OPR_SET;
+    }
+  }
+  else if (((strcmp( act, "on") == 0) || (strcmp( act, "off") == 0)) &&
+   (strcmp( method, "POST") == 0))
+  {
+    opr = ((strcmp( act, "on") == 0) ? OPR_ON : OPR_OFF);
+  }
+  else if ((strcmp( act, "on") != 0) && (strcmp( act, "off") != 0))
+  {
+    http_error( conn_p, 404, "Not found.");
+    return;
+  }
+  if (opr < 0)
+  {
+    http_error( conn_p, 405, "Method not allowed.");
+    return;
+  }
 
-  if (sts == 0)
+  /* Device request.  Queue it (like a control request). */
+  req_p = &req[ *req_cnt_p];
+  req_p->set_flg = 0;
+  if (opr == OPR_SET)
   {
-    /* Broadcast IP, specific IP, or specific MAC address? */
-    if (task_nr == TSK_GLOB_DISC_B)
-    { /* Broadcast IP. */
-      bcast = 1;
+    sts = json_get_str( body, "name", req_p->set_name,
+     sizeof( req_p->set_name));
+    if (sts > 0)
+    {
+      req_p->set_flg |= CTL_SET_NAME;
+    }
+    if (sts >= 0)
+    {
+      sts = json_get_str( body, "password", req_p->set_passwd,
+       sizeof( req_p->set_passwd));
+    }
+    if (sts > 0)
+    {
+      req_p->set_flg |= CTL_SET_PASSWD;
     }
-    else if (task_nr != TSK_GLOB_DISC)
-    { /* Specific MAC address.  (Not TSK_GLOB_DISC[_B].) */
-      memcpy( mac_addr, target_p->mac_addr, MAC_ADDR_SIZE);
+    if ((sts < 0) || (req_p->set_flg == 0))
+    {
+      http_error( conn_p, 400,
+       "Need JSON \"name\" and/or \"password\" (string, not too long).");
+      return;
     }
+  }
 
-    /* Form the message for this task_nr, or point to an already
-     * existing message.
-     */
-    if ((task_nr == TSK_WT_SOCKET) || (task_nr == TSK_WT_TIMING))
+  (*req_cnt_p)++;
+  metrics.ctl_req++;
+  req_p->fd = conn_p->fd;
+  req_p->opr = opr;
+  req_p->flags = 0;
+  req_p->sts = CTL_OK;
+  req_p->msg = NULL;
+  req_p->cls = PRI_INTERACTIVE;
+  req_p->pos = 0;
+  req_p->queued = 1;
+  req_p->yielded = 0;
+  req_p->t_arr = ms_time();
+  req_p->dev = orv_data_p;
+  req_p->lead = NULL;
+  req_p->http = conn_p;
+  req_p->self = 0;
+  conn_p->busy = 1;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* http_parse(): Handle the complete HTTP API requests held for a
+ *               connection (if open), in order (pipelining), until one
+ *               waits for a device (busy), or the daemon's requests are
+ *               full.
+ *               HTTP/1.1 connections persist (keep-alive), unless the
+ *               client says "Connection: close".
+ */
+
+void http_parse( orv_http_t *conn_p, orv_data_t *origin_p,
+ orv_ctl_req_t *req, int *req_cnt_p)
+{
+  int bad;
+  int keep;
+  int minor;
+  size_t body_len;
+  size_t hdr_len;
+  size_t i;
+  char *cp;
+  char *line;
+  char method[ 16];
+  char target[ 128];
+  char hdr[ HTTP_IN_MAX+ 1];
+  char body[ HTTP_IN_MAX+ 1];
+
+  while ((conn_p->fd >= 0) && (conn_p->busy == 0) &&
+   (conn_p->in_len > 0) && (*req_cnt_p < CTL_REQ_MAX))
+  {
+    /* Find the end of the header. */
+    hdr_len = 0;
+    for (i = 0; i+ 4 <= conn_p->in_len; i++)
+    {
+      if (memcmp( (conn_p->in+ i), "\r\n\r\n", 4) == 0)
+      {
+        hdr_len = i+ 4;
+        break;
+      }
+    }
+    if (hdr_len == 0)
     {
-      if (*tbl_p != NULL)
-      { /* Use an existing (Write-Table) message. */
-        msg_out = *tbl_p;
-        msg_out_len = (unsigned short)msg_out[ 2]* 256+
-                      (unsigned short)msg_out[ 3];
+      if (conn_p->in_len >= HTTP_IN_MAX)
+      { /* Header too large. */
+        conn_p->in_len = 0;
+        conn_p->hangup = 1;
+        http_error( conn_p, 413, "Request too large.");
+      }
+      break;                    /* (Or wait for the rest.) */
+    }
 
-        if ((debug& DBG_MSO) != 0)
+    memcpy( hdr, conn_p->in, hdr_len);
+    hdr[ hdr_len] = '\0';
+    minor = 0;
+    method[ 0] = '\0';
+    target[ 0] = '\0';
+    sscanf( hdr, "%15s %127s HTTP/1.%d", method, target, &minor);
+
+    /* Header fields: Content-Length, Connection, Transfer-Encoding. */
+    bad = 0;
+    body_len = 0;
+    keep = ((minor >= 1) ? 1 : 0);
+    line = strstr( hdr, "\r\n");
+    while ((line != NULL) && (line[ 2] != '\r'))
+    {
+      line += 2;
+      cp = strchr( line, ':');
+      if (cp != NULL)
+      {
+        cp += 1+ strspn( (cp+ 1), " \t");
+        if (STRNCASECMP( line, "Content-Length:", 15) == 0)
+        { /* Digits only.  (Stop counting past HTTP_IN_MAX.) */
+          body_len = 0;
+          if (isdigit( (unsigned char)*cp) == 0)
+          {
+            bad = 1;
+          }
+          while (isdigit( (unsigned char)*cp) != 0)
+          {
+            if (body_len <= HTTP_IN_MAX)
+            {
+              body_len = body_len* 10+ (*cp- '0');
+            }
+            cp++;
+          }
+          cp += strspn( cp, " \t");
+          if (*cp != '\r')
+          {
+            bad = 1;
+          }
+        }
+        else if (STRNCASECMP( line, "Connection:", 11) == 0)
+        {
+          if (STRNCASECMP( cp, "close", 5) == 0)
+          {
+            keep = 0;
+          }
+          else if (STRNCASECMP( cp, "keep-alive", 10) == 0)
+          {
+            keep = 1;
+          }
+        }
+        else if (STRNCASECMP( line, "Transfer-Encoding:", 18) == 0)
         {
-          fprintf( stderr, " task(non-f_m_o).  m_o_l = %ld.\n",
-           msg_out_len);
+          body_len = HTTP_IN_MAX;       /* (Chunked: Not supported.) */
         }
       }
+      line = strstr( line, "\r\n");
     }
-    else
-    { /* Form a new message. */
-      msg_out_len = form_msg_out( task_nr, &msg_out, mac_addr);
 
-      if ((debug& DBG_MSO) != 0)
-      {
-        fprintf( stderr, " task(f_m_o).  m_o_l = %ld.\n",
-         msg_out_len);
-      }
+    if (bad != 0)
+    {
+      conn_p->in_len = 0;
+      conn_p->hangup = 1;
+      http_error( conn_p, 400, "Bad Content-Length.");
+      break;
+    }
+    if (body_len > HTTP_IN_MAX- hdr_len)
+    {
+      conn_p->in_len = 0;
+      conn_p->hangup = 1;
+      http_error( conn_p, 413, "Request too large.");
+      break;
+    }
+    if (conn_p->in_len < hdr_len+ body_len)
+    {
+      break;                    /* Wait for the rest of the body. */
+    }
 
-      if (msg_out_len <= 0)
-      {
-        errno = EINVAL;
-        sts = -1;
-      }
+    memcpy( body, (conn_p->in+ hdr_len), body_len);
+    body[ body_len] = '\0';
+    conn_p->in_len -= hdr_len+ body_len;
+    memmove( conn_p->in, (conn_p->in+ hdr_len+ body_len), conn_p->in_len);
+    if (keep == 0)
+    { /* Last request.  (Ignore any more.) */
+      conn_p->hangup = 1;
+      conn_p->in_len = 0;
+    }
+
+    if ((debug& DBG_ACT) != 0)
+    {
+      fprintf( stderr, " http_parse().  fd = %d, req: >%s %s<.\n",
+       conn_p->fd, method, target);
     }
+    http_handle( conn_p, method, target, body, origin_p, req, req_cnt_p);
   }
 
-#ifdef VMS
-# ifndef NO_OPER_PRIVILEGE
-  /* On VMS, broadcast may require BYPASS, OPER, or SYSPRV privilege,
-   * unless TCPIP SET PROTOCOL UDP /BROADCAST.  We try to enable only
-   * OPER, which may be relatively safe.
-   *
-   * As of TCPIP V5.7 - ECO 5 on Alpha, privilege must be adequate
-   * (elevated) when the socket is created.  If raised after socket(),
-   * then setsockopt( SO_BROADCAST) fails (EACCES).
-   */
+  if ((conn_p->hangup != 0) && (conn_p->busy == 0) &&
+   (*req_cnt_p < CTL_REQ_MAX))
+  { /* Client done.  Discard any incomplete request. */
+    conn_p->in_len = 0;
+  }
+}
 
-  if (sts == 0)
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* ctl_accept(): Accept one control connection, and read and parse its
+ *               request line: "[brief] [quiet] operation [identifier]",
+ *               or "subscribe [filter ...]".
+ *               A bad request gets a CTL_BAD result (reply pending).
+ *               Return -1, if no connection, 1, if it became a change
+ *               subscriber (no reply until the daemon stops).
+ */
+
+int ctl_accept( int sock_ctl, orv_ctl_req_t *req_p, orv_data_t *origin_p)
+{
+  int len;
+  int sts;
+  char *ident;
+  char *tkn;
+  char line[ CTL_LINE_MAX];
+  struct in_addr ip_addr;
+
+  req_p->fd = accept( sock_ctl, NULL, NULL);
+  if (req_p->fd < 0)
   {
-    if (bcast != 0)
+    return -1;
+  }
+
+  metrics.ctl_req++;
+  req_p->t_arr = ms_time();
+  req_p->opr = -1;
+  req_p->flags = 0;
+  req_p->pos = 0;
+  req_p->queued = 1;
+  req_p->yielded = 0;
+  req_p->sts = CTL_OK;
+  req_p->msg = NULL;
+  req_p->dev = NULL;
+  req_p->lead = NULL;
+  req_p->http = NULL;
+  req_p->self = 0;
+  req_p->set_flg = 0;
+
+  /* Read the request line (up to the first new-line, or EOF). */
+  len = 0;
+  while ((len < CTL_LINE_MAX- 1) && (memchr( line, '\n', len) == NULL) &&
+   (ctl_wait( req_p->fd, CTL_READ_WAIT) > 0))
+  {
+    sts = read( req_p->fd, (line+ len), (CTL_LINE_MAX- 1- len));
+    if (sts <= 0)
     {
-      sts = set_priv_oper( 1, &oper_priv_save);
+      break;
+    }
+    len += sts;
+  }
+  line[ len] = '\0';
 
-      if (sts != 0)
+  if ((debug& DBG_ACT) != 0)
+  {
+    fprintf( stderr, " ctl_accept().  fd = %d, req: >%.*s<.\n",
+     req_p->fd, (int)strcspn( line, "\r\n"), line);
+  }
+
+  ident = NULL;
+  tkn = strtok( line, " \t\r\n");
+  while ((tkn != NULL) && (req_p->sts == CTL_OK))
+  {
+    if ((req_p->opr < 0) && (strcmp( tkn, "brief") == 0))
+    {
+      req_p->flags |= FDL_BRIEF;
+    }
+    else if ((req_p->opr < 0) && (strcmp( tkn, "quiet") == 0))
+    {
+      req_p->flags |= FDL_QUIET;
+    }
+    else if ((req_p->opr < 0) && (strcmp( tkn, "subscribe") == 0))
+    { /* Change subscription.  (The rest of the line is its filter.) */
+      req_p->opr = OPR_WATCH;
+      req_p->msg = sub_open( req_p->fd);
+      if (req_p->msg == NULL)
       {
-        fprintf( stderr,
-         "%s: Set privilege (OPER) failed.  sts = %%x%08x .\n",
-         PROGRAM_NAME, sts);
-        show_errno( PROGRAM_NAME);
-        sts = 0;                        /* Try to continue. */
+        return 1;
       }
-      else if ((debug& DBG_VMS) != 0)
+      req_p->sts = CTL_BAD;
+    }
+    else if (req_p->opr < 0)
+    {
+      req_p->opr = keyword_match( tkn,
+       (sizeof( oprs)/ sizeof( *oprs)), oprs);
+      if ((req_p->opr != OPR_LIST) && (req_p->opr != OPR_QLIST) &&
+       (req_p->opr != OPR_OFF) && (req_p->opr != OPR_ON))
       {
-        fprintf( stderr,
-         " set_priv_oper(set).  sts = %%x%08x , oper_old = %d.\n",
-         sts, oper_priv_save);
+        req_p->sts = CTL_BAD;
+        req_p->msg = "Operation not list, qlist, off, on, or subscribe.";
       }
     }
+    else if (ident == NULL)
+    {
+      ident = tkn;
+    }
+    else
+    {
+      req_p->sts = CTL_BAD;
+      req_p->msg = "Extra request token.";
+    }
+    tkn = strtok( NULL, " \t\r\n");
   }
-# endif /* ndef NO_OPER_PRIVILEGE */
-#endif /* def VMS */
 
-  state_new = -1;                       /* Clear device states. */
-  state_old = -1;
-
-  if (sts == 0)
+  if ((req_p->sts == CTL_OK) && (req_p->opr < 0))
   {
-    /* Fill receive socket addr structure. */
-    memset( &sock_addr_rec, 0, sizeof( sock_addr_rec));
-    sock_addr_rec.sin_family      = AF_INET;
-    sock_addr_rec.sin_port        = htons( PORT_ORV);
-    sock_addr_rec.sin_addr.s_addr = htons( INADDR_ANY);
-
-    sock_orv = socket( AF_INET,                 /* Address family. */
-                       SOCK_DGRAM,              /* Type. */
-                       IPPROTO_UDP);            /* Protocol. */
-
-    if ((debug& DBG_SIO) != 0)
+    req_p->sts = CTL_BAD;
+    req_p->msg = "No operation.";
+  }
+  else if ((req_p->sts == CTL_OK) && (ident == NULL) &&
+   ((req_p->opr == OPR_OFF) || (req_p->opr == OPR_ON)))
+  {
+    req_p->sts = CTL_BAD;
+    req_p->msg = "Missing required device identifier.";
+  }
+  else if ((req_p->sts == CTL_OK) && (ident != NULL))
+  { /* Locate the device: name, then IP address (DNS name). */
+    req_p->dev = orv_data_find_name( origin_p, ident);
+    if ((req_p->dev == NULL) && (dns_resolve( ident, &ip_addr) == 0))
     {
-      fprintf( stderr, " sock_orv = %d.\n", sock_orv);
-    }
+      struct in_addr ip_addr_orig;
 
-    if (BAD_SOCKET( sock_orv))
-    {
-      fprintf( stderr, "%s: socket() failed.\n", PROGRAM_NAME);
-      show_errno( PROGRAM_NAME);
-      sts = -1;
+      ip_addr_orig.s_addr = origin_p->ip_addr.s_addr;
+      origin_p->ip_addr.s_addr = ip_addr.s_addr;
+      req_p->dev = orv_data_find_ip_addr( origin_p);
+      origin_p->ip_addr.s_addr = ip_addr_orig.s_addr;
     }
-    else
+    if (req_p->dev == NULL)
     {
-#ifdef _WIN32
-      char sock_opt_rec = 1;
-#else /* def _WIN32 */
-      unsigned int sock_opt_rec = 1;
-#endif /* def _WIN32 [else] */
+      req_p->sts = CTL_BAD;
+      req_p->msg = "Device name not matched.";
+    }
+  }
+
+  /* Priority class. */
+  req_p->cls = (((req_p->opr == OPR_OFF) || (req_p->opr == OPR_ON)) ?
+   PRI_INTERACTIVE : ((req_p->dev != NULL) ? PRI_CONTROL :
+   ((req_p->opr == OPR_LIST) ? PRI_REFRESH : PRI_BULK)));
+  return 0;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* ctl_self(): Form one of the daemon's own requests (no client), such
+ *             as a background revalidation.  (Like ctl_accept().)
+ */
 
-      sts = setsockopt( sock_orv,                       /* Socket. */
-                        SOL_SOCKET,                     /* Level. */
-                        SO_REUSEADDR,                   /* Option name. */
-                        &sock_opt_rec,                  /* Option value. */
-                        sizeof( sock_opt_rec));         /* Option length. */
+void ctl_self( orv_ctl_req_t *req_p, int sock_ctl, int opr, int cls,
+ orv_data_t *orv_data_p)
+{
+  metrics.ctl_req++;
+  req_p->fd = sock_ctl;                         /* (Not served yet.) */
+  req_p->t_arr = ms_time();
+  req_p->opr = opr;
+  req_p->flags = 0;
+  req_p->pos = 0;
+  req_p->queued = 1;
+  req_p->yielded = 0;
+  req_p->sts = CTL_OK;
+  req_p->msg = NULL;
+  req_p->cls = cls;
+  req_p->dev = orv_data_p;
+  req_p->lead = NULL;
+  req_p->http = NULL;
+  req_p->self = 1;
+  req_p->set_flg = 0;
+}
 
-      if (sts < 0)
-      {
-        fprintf( stderr, "%s: setsockopt(rec) failed.\n", PROGRAM_NAME);
-        show_errno( PROGRAM_NAME);
-      }
-      else if ((debug& DBG_SIO) != 0)
-      {
-        fprintf( stderr, " setsockopt(rec) sts = %d.\n", sts);
-      }
-    }
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-    if (sts == 0)
-    {
-      sts = set_socket_noblock( sock_orv);
-    }
+/* ctl_coalesce(): Coalesce a batch of control requests.  Of the writes
+ *                 (off, on) to one device, the last one wins: an
+ *                 earlier one of the same kind attaches to it (lead),
+ *                 and an earlier conflicting one is superseded.  A read
+ *                 (list, qlist) attaches to an earlier identical one,
+ *                 unless a (performed) write (off, on, set) to its
+ *                 target intervenes, or it is already under way (bulk).
+ *                 A "set" (HTTP API) is always performed.
+ *                 Return the count of requests to perform.
+ */
 
-    if (sts == 0)
-    {
-      sts = bind( sock_orv,
-                  (struct sockaddr *)
-                   &sock_addr_rec,              /* Socket address. */
-                  sizeof( sock_addr_rec));      /* Socket address length. */
+int ctl_coalesce( orv_ctl_req_t *req, int req_cnt)
+{
+  int cnt = 0;
+  int i;
+  int j;
+  int last;
 
-      if (sts < 0)
+  for (i = 0; i < req_cnt; i++)
+  { /* (Re-coalesce any requests deferred from an earlier batch.) */
+    req[ i].lead = NULL;
+  }
+
+  for (i = 0; i < req_cnt; i++)
+  { /* Writes. */
+    if ((req[ i].sts == CTL_OK) &&
+     ((req[ i].opr == OPR_OFF) || (req[ i].opr == OPR_ON)))
+    {
+      last = i;
+      for (j = i+ 1; j < req_cnt; j++)
       {
-        fprintf( stderr, "%s: bind(rec) failed.\n", PROGRAM_NAME);
-        show_errno( PROGRAM_NAME);
+        if ((req[ j].sts == CTL_OK) && (req[ j].dev == req[ i].dev) &&
+         ((req[ j].opr == OPR_OFF) || (req[ j].opr == OPR_ON)))
+        {
+          last = j;
+        }
       }
-      else if ((debug& DBG_SIO) != 0)
+      if (req[ last].opr != req[ i].opr)
       {
-        fprintf( stderr, " bind(rec) sts = %d.\n", sts);
+        req[ i].sts = CTL_SUPERSEDED;
+        req[ i].msg = "Superseded by a later command.";
       }
-
+      else if (last != i)
       {
-#ifdef EARLY_RECVFROM                           /* Useful or not? */
-        if ((debug& DBG_SIO) != 0)
-        {
-          fprintf( stderr,
-           " pre-recvfrom(e).  sock_orv = %d, siz = %ld.\n",
-           sock_orv, sizeof( msg_inp));
-        }
-
-        /* Read a response.  (Should be too soon.) */
-        sock_addr_len_rec = sizeof( sock_addr_rec);     /* Socket addr len. */
-        bc = recvfrom( sock_orv,
-                       msg_inp,
-                       sizeof( msg_inp),
-                       0,                       /* Flags (not OOB or PEEK). */
-                       (struct sockaddr *)
-                        &sock_addr_rec,         /* Socket address. */
-                       &sock_addr_len_rec);     /* Socket address length. */
+        req[ i].lead = &req[ last];
+      }
+    }
+  }
 
-        if (bc < 0)
+  for (i = 0; i < req_cnt; i++)
+  { /* Reads. */
+    if ((req[ i].sts == CTL_OK) && (req[ i].pos == 0) &&
+     ((req[ i].opr == OPR_LIST) || (req[ i].opr == OPR_QLIST)))
+    {
+      for (j = i- 1; j >= 0; j--)
+      {
+        if ((req[ j].sts == CTL_OK) && (req[ j].lead == NULL) &&
+         ((req[ j].opr == OPR_OFF) || (req[ j].opr == OPR_ON) ||
+         (req[ j].opr == OPR_SET)) &&
+         ((req[ i].dev == NULL) || (req[ j].dev == req[ i].dev)))
         {
-# ifdef _WIN32
-          if (WSAGetLastError() != WSAEWOULDBLOCK)
-# else /* def _WIN32 */
-          if (errno != EWOULDBLOCK)
-# endif /* def _WIN32 [else] */
-          {
-            fprintf( stderr, "%s: recvfrom(e) failed.\n", PROGRAM_NAME);
-            show_errno( PROGRAM_NAME);
-          }
+          break;                /* Write to the target.  Read again. */
         }
-        else if ((debug& DBG_SIO) != 0)
+        if ((req[ j].sts == CTL_OK) && (req[ j].lead == NULL) &&
+         (req[ j].opr == req[ i].opr) && (req[ j].dev == req[ i].dev))
         {
-          fprintf( stderr, " recvfrom(e) bc = %ld.\n", bc);
+          req[ i].lead = &req[ j];
+          break;
         }
-#endif /* def EARLY_RECVFROM */
       }
     }
   }
 
-  if (sts == 0)
+  for (i = 0; i < req_cnt; i++)
   {
-    bc = -1;
-    /* Fill send socket addr structure. */
-    memset( &sock_addr_snd, 0, sizeof( sock_addr_snd));
-    sock_addr_snd.sin_family = AF_INET;
-    sock_addr_snd.sin_port = htons( PORT_ORV);
-    sock_addr_snd.sin_addr.s_addr = target_p->ip_addr.s_addr;
-
-    if (bcast != 0)
+    if ((req[ i].sts == CTL_OK) && (req[ i].lead == NULL))
     {
-      /* Set socket broadcast flag. */
-
-#ifdef _WIN32
-      char sock_opt_snd = 1;
-#else /* def _WIN32 */
-      unsigned int sock_opt_snd = 1;
-#endif /* def _WIN32 [else] */
-
-      sts = setsockopt( sock_orv,                       /* Socket. */
-                        SOL_SOCKET,                     /* Level. */
-                        SO_BROADCAST,                   /* Option name. */
-                        &sock_opt_snd,                  /* Option value. */
-                        sizeof( sock_opt_snd));         /* Option length. */
+      cnt++;
+    }
+  }
+  return cnt;
+}
 
-      if ((debug& DBG_SIO) != 0)
-      {
-        fprintf( stderr, " setsockopt( snd-bc0) = %d .\n", sts);
-      }
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-      if (sts < 0)
-      {
-        fprintf( stderr, "%s: setsockopt( snd-bc1) failed.\n",
-         PROGRAM_NAME);
-        show_errno( PROGRAM_NAME);
-      }
-      else
-      {
-        /* Disable multicast loopback.  (Ineffective?) */
-        unsigned char sock_opt_snd = 0;
+/* ctl_perform(): Perform one (lead) control request.  Return CTL_xxx.
+ *                A bulk request ("qlist", all) is performed in slices
+ *                (PRI_BULK_SLICE devices per call, from req_p->pos),
+ *                so that other requests may be served in between.  It
+ *                is finished when req_p->pos is reset to zero.
+ */
 
-        sts = setsockopt( sock_orv,                     /* Socket. */
-                          IPPROTO_IP,                   /* Level. */
-                          IP_MULTICAST_LOOP,            /* Option name. */
-                          &sock_opt_snd,                /* Option value. */
-                          sizeof( sock_opt_snd));       /* Option length. */
+int ctl_perform( orv_ctl_req_t *req_p, orv_data_t *origin_p)
+{
+  int fresh;
+  int i;
+  int rsp;
+  int sts = 0;
+  int task_nr;
+  unsigned char nam_buf[ DEV_NAME_LEN];
+  unsigned char pw_buf[ PASSWORD_LEN];
+  orv_patch_t patch[ 2];
+  orv_data_t *orv_data_p;
 
-        if (sts < 0)
-        {
-          fprintf( stderr, "%s: setsockopt( snd-lb) failed.\n",
-           PROGRAM_NAME);
-          show_errno( PROGRAM_NAME);
-        }
-      }
+  if (req_p->pos == 0)
+  {
+    metrics.ctl_done++;
+  }
+  if ((req_p->cls == PRI_BULK) && (req_p->pos == 0))
+  { /* Bulk: Start with an inventory (discovery).  With a DDF, only its
+     * devices (Unit discovery), so that a device removed from the DDF
+     * stays removed.
+     */
+    if (ddf_base != NULL)
+    {
+      sts = discover_devices( 0, origin_p);
     }
-
-    if (sts == 0)
-    { /* Send the command. */
-      bc = sendto( sock_orv,                    /* Socket. */
-                   msg_out,                     /* Message. */
-                   msg_out_len,                 /* Message length. */
-                   0,                           /* Flags (not MSG_OOB). */
-                   (struct sockaddr *)
-                    &sock_addr_snd,             /* Socket address. */
-                   sizeof( sock_addr_snd));     /* Socket address length. */
-
-      if (bc < 0)
-      {
-        fprintf( stderr, "%s: sendto() failed.\n", PROGRAM_NAME);
-        show_errno( PROGRAM_NAME);
-        sts = -1;
-      }
-      else if ((debug& DBG_SIO) != 0)
-      {
-       fprintf( stderr, " sendto() = %ld.\n", bc);
-      }
+    else
+    {
+      sts = catalog_devices_disc( origin_p, NULL, 0);
     }
   }
 
-  if ((sts == 0) && (bc >= 0))
+  i = 0;
+  orv_data_p = origin_p->next;
+  while (orv_data_p != origin_p)
   {
-    /* Fill file-descriptor flags and time-out value for select(). */
-    memset( &fds_rec, 0, sizeof( fds_rec));
-    FD_SET( sock_orv, &fds_rec);
-    timeout_rec.tv_sec  = SOCKET_TIMEOUT/ 1000000;      /* Seconds. */
-    timeout_rec.tv_usec = SOCKET_TIMEOUT% 1000000;      /* Microseconds. */
-
-    if ((debug& DBG_SIO) != 0)
+    if (req_p->cls == PRI_BULK)
+    { /* This slice. */
+      orv_data_p->cnt_flg =
+       (((i >= req_p->pos) && (i < req_p->pos+ PRI_BULK_SLICE)) ? 1 : 0);
+    }
+    else
     {
-      fprintf( stderr, " sock_orv = %d, FD_SETSIZE = %d,\n",
-       sock_orv, FD_SETSIZE);
-
-      fprintf( stderr, " FD_ISSET( sock_orv, &fds_rec) = %d.\n",
-       FD_ISSET( sock_orv, &fds_rec));
+      orv_data_p->cnt_flg = ((orv_data_p == req_p->dev) ? 1 : 0);
     }
+    i++;
+    orv_data_p = orv_data_p->next;
   }
 
-  /* Read responses until recvfrom()/select() times out. */
-  while (bc >= 0)
+  if (req_p->opr == OPR_LIST)
   {
-    save_orv_data = 0;                  /* Clear good-data flag. */
-
-    if ((debug& DBG_SIO) != 0)
+    if ((req_p->dev == NULL) && (ddf_base == NULL))
+    { /* Broadcast Global discovery (with gap-fill). */
+      sts = catalog_devices_disc( origin_p, NULL, 0);
+    }
+    else
+    { /* Unit discovery (one device, or all DDF devices). */
+      sts = discover_devices( ((req_p->dev == NULL) ? 0 : 1), origin_p);
+    }
+  }
+  else if (req_p->opr == OPR_QLIST)
+  {
+    if (sts == 0)
     {
-      fprintf( stderr, " pre-select(1).  sock_orv = %d.\n", sock_orv);
+      sts = query_devices( 1, origin_p, QRY_INDEX);
     }
-
-    sts = select( FD_SETSIZE, &fds_rec, NULL, NULL, &timeout_rec);
-
-    if (sts <= 0)
+    if ((req_p->cls == PRI_BULK) && (sts == 0))
+    { /* Advance to the next slice.  Finished (0), if none left. */
+      req_p->pos += PRI_BULK_SLICE;
+      if (req_p->pos >= i)
+      {
+        req_p->pos = 0;
+      }
+    }
+    else
     {
-      if (sts < 0)
+      req_p->pos = 0;
+    }
+  }
+  else if (req_p->opr == OPR_SET)
+  { /* "set" (HTTP API).  Subscribe, then Write table 4 (ascending
+     * offsets: password, then name).
+     */
+    rsp = 0;
+    sts = task_retry( RSP_CL, TSK_SUBSCRIBE, &rsp, NULL,
+     origin_p, req_p->dev);
+    if (sts == 0)
+    {
+      i = 0;
+      if ((req_p->set_flg& CTL_SET_PASSWD) != 0)
       {
-        fprintf( stderr, "%s: select(1) failed.\n", PROGRAM_NAME);
-        show_errno( PROGRAM_NAME);
+        passwd_patch( req_p->set_passwd, pw_buf, &patch[ i++]);
       }
-      else if ((debug& DBG_SIO) != 0)
+      if ((req_p->set_flg& CTL_SET_NAME) != 0)
       {
-        fprintf( stderr, " select(1) sts = %d.\n", sts);
+        name_patch( req_p->set_name, nam_buf, &patch[ i++]);
       }
-      break;
+      sts = table4_write( origin_p, req_p->dev, patch, i);
     }
-    else
+  }
+  else
+  { /* "off", "on".  Subscribe (unless a subscription was confirmed
+     * within WATCH_RENEW), then Device control.  If that fails with
+     * the old subscription, then subscribe, and try again.
+     */
+    fresh = ((req_p->dev->sub_t > 0.0) &&
+     (wall_time()- req_p->dev->sub_t < (double)WATCH_RENEW));
+    task_nr = (req_p->opr == OPR_OFF) ? TSK_SW_OFF : TSK_SW_ON;
+    for (i = fresh; i >= 0; i--)
     {
-      if ((debug& DBG_SIO) != 0)
+      sts = 0;
+      if (i == 0)
       {
-        fprintf( stderr, " pre-recvfrom(n).  sock_orv = %d.\n",
-         sock_orv);
+        rsp = 0;
+        sts = task_retry( RSP_CL, TSK_SUBSCRIBE, &rsp, NULL,
+         origin_p, req_p->dev);
       }
-
-      /* Receive a response. */
-      sock_addr_len_rec = sizeof( sock_addr_rec);       /* Socket addr len. */
-      bc = recvfrom( sock_orv,
-                     msg_inp,
-                     sizeof( msg_inp),
-                     0,                         /* Flags (not OOB or PEEK). */
-                     (struct sockaddr *)
-                      &sock_addr_rec,           /* Socket address. */
-                     &sock_addr_len_rec);       /* Socket address length. */
-
-      if (bc < 0)
+      if (sts == 0)
       {
-        fprintf( stderr, "%s: recvfrom(n) failed.\n", PROGRAM_NAME);
-        show_errno( PROGRAM_NAME);
+        rsp = 0;
+        sts = task_retry( RSP_DC, task_nr, &rsp, NULL,
+         origin_p, req_p->dev);
       }
-      else
+      if (sts == 0)
       {
-        mac_addr_ndx = -1;
-
-        if ((debug& DBG_SIO) != 0)
-        {
-          if (sock_addr_rec.sin_family == AF_INET)
-          {
-            unsigned int ia4;
-
-            fprintf( stderr, " s_addr: %08x .\n",
-             sock_addr_rec.sin_addr.s_addr);
-
-            ia4 = ntohl( sock_addr_rec.sin_addr.s_addr);
-            fprintf( stderr, " recvfrom(n) addr: %u.%u.%u.%u\n",
-             ((ia4/ 0x100/ 0x100/ 0x100)& 0xff),
-             ((ia4/ 0x100/ 0x100)& 0xff),
-             ((ia4/ 0x100)& 0xff),
-             (ia4& 0xff));
-          }
-        }
-
-        if ((debug& DBG_MSI) != 0)
-        {
-          /* Display the response (hex, ASCII). */
-
-          if (bc >= 6)
-          {
-            fprintf( stderr, "   Rec (%3ld)  %c  %c\n",
-             bc, msg_inp[ 4], msg_inp[ 5]);
-          }
-
-          msg_dump( msg_inp, bc);
-        }
-
-        /* Find MAC.  Determine Off/On state, if known. */
-
-        if (bc >= 6)
-        {
-          if ((msg_inp[ 4] == 'c') && (msg_inp[ 5] == 'l'))
-          { /* Subscribe ("cl"). */
-            *rsp_p |= RSP_CL;
-            if (bc >= 12)
-            {
-              mac_addr_ndx = 6;
-            }
-            if (bc >= 24)
-            {
-              state_old = msg_inp[ 23];
-              save_orv_data = RSP_CL;           /* Found good data (cl). */
-            }
-          }
-          else if ((msg_inp[ 4] == 'd') && (msg_inp[ 5] == 'c'))
-          { /* Switch Off/On (message) ("dc").  (No useful data?) */
-            *rsp_p |= RSP_DC;
-          }
-          else if ((msg_inp[ 4] == 'h') && (msg_inp[ 5] == 'b'))
-          { /* Heartbeat Off/On ("hb").  (No useful data?) */
-            *rsp_p |= RSP_HB;
-          }
-          else if ((msg_inp[ 4] == 'q') && (msg_inp[ 5] == 'a'))
-          { /* Global Discovery ("qa"). */
-            /* We may see the original (short) request, if broadcast,
-             * so set the "qa" response bit only if the message is a
-             * real response, that is, if it's long enough to include
-             * a MAC address (which a "qa" request does not).
-             */
-            if (bc >= 13)
-            {
-              *rsp_p |= RSP_QA;
-              mac_addr_ndx = 7;
-            }
-            if (bc >= 41)
-            {
-              time_dev =                        /* Casts ensure that */
-               (((time_t)msg_inp[ 40]* 256+     /* arithmetic is done as */
-                 (time_t)msg_inp[ 39])* 256+    /* time_t, which may be */
-                 (time_t)msg_inp[ 38])* 256+    /* 32/64-bit, [un]signed */
-                 (time_t)msg_inp[ 37];          /* on different systems. */
-
-              if ((debug& DBG_MSI) != 0)
-              {
-                fprintf( stderr,
-                 " time_dev: %lu (0x%08lx)\n", time_dev, time_dev);
-
-                time_dev -= TIME_OFS;                   /* 1970 - 1900. */
-                fprintf( stderr, " ctime(adj) = %s",    /* No '\n'. */
-                 ctime( (time_t *)&time_dev));
-              }
-            }
-            if (bc >= 42)
-            {
-              state_old = msg_inp[ 41];
-              save_orv_data = RSP_QA;           /* Found good data (qa). */
-            }
-          }
-          else if ((msg_inp[ 4] == 'q') && (msg_inp[ 5] == 'g'))
-          { /* Unit Discovery ("qg"). */
-            *rsp_p |= RSP_QG;
-            if (bc >= 13)
-            {
-              mac_addr_ndx = 7;
-            }
-            if (bc >= 41)
-            {
-              time_dev =                        /* Casts ensure that */
-               (((time_t)msg_inp[ 40]* 256+     /* arithmetic is done as */
-                 (time_t)msg_inp[ 39])* 256+    /* time_t, which may be */
-                 (time_t)msg_inp[ 38])* 256+    /* 32/64-bit, [un]signed */
-                 (time_t)msg_inp[ 37];          /* on different systems. */
-
-              if ((debug& DBG_MSI) != 0)
-              {
-                fprintf( stderr,
-                 " time_dev: %lu (0x%08lx)\n", time_dev, time_dev);
-
-                time_dev -= TIME_OFS;                   /* 1970 - 1900. */
-                fprintf( stderr, " ctime(adj) = %s\n",
-                 ctime( (time_t *)&time_dev));
-              }
-            }
-            if (bc >= 42)
-            {
-              state_old = msg_inp[ 41];
-              save_orv_data = RSP_QG;           /* Found good data (qg). */
-            }
-          }
-          else if ((msg_inp[ 4] == 'r') && (msg_inp[ 5] == 't'))
-          { /* Read Table ("rt"). */
-            *rsp_p |= RSP_RT;
-
-            /* If caller wants them, then copy msg_inp data into user's
-             * new buffer, and tell caller where to find them.  (Size is
-             * stored in the data.)
-             */
-            if (tbl_p != NULL)
-            {
-              if (*tbl_p == NULL)              /* First time. */
-              {
-                unsigned short msg_len;        /* Embedded msg len. */
-
-                msg_len = (unsigned short)msg_inp[ 2]* 256+
-                          (unsigned short)msg_inp[ 3];
-
-                if (bc != msg_len)
-                {
-                  fprintf( stderr,
-                   "%s: Unexpected message length.  bc = %ld, m_l = %d.\n",
-                   PROGRAM_NAME, bc, msg_len);
-                }
-                else
-                {
-                  *tbl_p = malloc( bc);
-                  if (*tbl_p == NULL)
-                  {
-                    fprintf( stderr, "%s: malloc() failed [x].\n",
-                     PROGRAM_NAME);
-                  }
-                  else
-                  {
-                    memcpy( *tbl_p, msg_inp, bc);
-                  }
-                }
-              }
-            }
-
-            if (bc >= 12)
-            {
-              mac_addr_ndx = 6;
-            }
-#if 0
-            if (bc >= 20)
-            {
-              int record_id;
+        break;
+      }
+    }
+  }
 
-              record_id =                       /* Record ID. */
-               (unsigned int)msg_inp[ 19]* 256+
-               (unsigned int)msg_inp[ 18];
+  if (sts != 0)
+  {
+    req_p->msg = "Device operation failed.";
+  }
+  return ((sts == 0) ? CTL_OK : CTL_FAILED);
+}
 
-              if ((debug& DBG_MSI) != 0)
-              {
-                fprintf( stderr,
-                 " Record ID: %u (0x%04x)\n", record_id, record_id);
-              }
-            }
-#endif /* 0 */
-            if (bc >= 25)                       /* Unk: 18, 19, 20, 21, 22. */
-            {
-              table_nr =                        /* Table Nr. */
-               (unsigned int)msg_inp[ 24]* 256+
-               (unsigned int)msg_inp[ 23];
-
-              if ((debug& DBG_MSI) != 0)
-              {
-                fprintf( stderr,
-                 " Table Nr: %u (0x%04x)\n", table_nr, table_nr);
-              }
-            }
-            if (bc >= 27)
-            {
-              unk_nr =                          /* Unk Nr. */
-               (unsigned int)msg_inp[ 26]* 256+
-               (unsigned int)msg_inp[ 25];
-
-              if ((debug& DBG_MSI) != 0)
-              {
-                fprintf( stderr,
-                 " Unk Nr:   %u (0x%04x)\n", unk_nr, unk_nr);
-              }
-            }                                   /* Unk: 27. */
-            if (bc >= 30)
-            { /* (Record length is bytes to follow: total - 30.) */
-              record_len =                      /* Record length. */
-               (unsigned int)msg_inp[ 29]* 256+
-               (unsigned int)msg_inp[ 28];
-
-              if ((debug& DBG_MSI) != 0)
-              {
-                fprintf( stderr,
-                 " Record Len: %u (0x%04x)\n", record_len, record_len);
-              }
-            }
-            if (bc >= 32)
-            {
-              record_nr =                       /* Record number. */
-               (unsigned int)msg_inp[ 31]* 256+
-               (unsigned int)msg_inp[ 30];
-
-              if ((debug& DBG_MSI) != 0)
-              {
-                fprintf( stderr,
-                 " Record Nr: %u (0x%04x)\n", record_nr, record_nr);
-              }
-            }
-            if (bc >= 34)
-            {
-              version_id =                      /* Version ID. */
-               (unsigned int)msg_inp[ 33]* 256+
-               (unsigned int)msg_inp[ 32];
-
-              if ((debug& DBG_MSI) != 0)
-              {
-                fprintf( stderr,
-                 " Version ID: %u (0x%04x)\n", version_id, version_id);
-              }
-            }
-            if (table_nr == 4)
-            {
-              if (bc >= 46)
-              { /* 6-char UID (MAC address)+ 6* 0x20. */
-                memcpy( uid_str, &msg_inp[ 34], 12);
-                uid_str[ 12] = '\0';
-
-                if ((debug& DBG_MSI) != 0)
-                {
-                  fprintf( stderr,
-                   " MAC address (fwd): %02x:%02x:%02x:%02x:%02x:%02x\n",
-                   msg_inp[ 34], msg_inp[ 35], msg_inp[ 36],
-                   msg_inp[ 37], msg_inp[ 38], msg_inp[ 39]);
-                }
-              }
-              if (bc >= 58)
-              { /* 6-char MAC addr+ 6* 0x20. */
-                memcpy( mac_addr_str, &msg_inp[ 46], 12);
-                mac_addr_str[ 12] = '\0';
-
-                if ((debug& DBG_MSI) != 0)
-                {
-                  fprintf( stderr,
-                   " MAC address (rev): %02x:%02x:%02x:%02x:%02x:%02x\n",
-                   msg_inp[ 46], msg_inp[ 47], msg_inp[ 48],
-                   msg_inp[ 49], msg_inp[ 50], msg_inp[ 51]);
-                }
-              }
-              if (bc >= 70)
-              { /* 12-char remote password (0x20-padded). */
-                memcpy( remote_password, &msg_inp[ 58], PASSWORD_LEN);
-                remote_password[ PASSWORD_LEN] = '\0';
-
-                if ((debug& DBG_MSI) != 0)
-                {
-                  fprintf( stderr,
-                   " Remote password: >%s<\n", remote_password);
-                }
-              }
-              if (bc >= 86)
-              { /* 16-char device name (0x20 padded). */
-                memcpy( device_name, &msg_inp[ 70], DEV_NAME_LEN);
-                device_name[ DEV_NAME_LEN] = '\0';
-
-                if ((debug& DBG_MSI) != 0)
-                {
-                  fprintf( stderr, " Device name: >%s<\n", device_name);
-                }
-              }
-              if (bc >= 88)
-              { /* Device type ("icon_code"). */
-                icon_code =                     /* Icon code. */
-                 (unsigned int)msg_inp[ 87]* 256+
-                 (unsigned int)msg_inp[ 86];
-
-                if ((debug& DBG_MSI) != 0)
-                {
-                  type_name( icon_code, device_type);
-                  fprintf( stderr, " Device type: %d  (%s)\n",
-                   icon_code, device_type);
-                 }
-              }
-              if (bc >= 92)
-              {
-                hw_version =                    /* Hardware Version. */
-                 (unsigned int)msg_inp[ 91]* 256* 256* 256+
-                 (unsigned int)msg_inp[ 90]* 256* 256+
-                 (unsigned int)msg_inp[ 89]* 256+
-                 (unsigned int)msg_inp[ 88];
-
-                if ((debug& DBG_MSI) != 0)
-                {
-                  fprintf( stderr,
-                   " Hardware version:        0x%08x\n", hw_version);
-                }
-              }
-              if (bc >= 96)
-              {
-                fw_version =                    /* Firmware Version. */
-                 (unsigned int)msg_inp[ 95]* 256* 256* 256+
-                 (unsigned int)msg_inp[ 94]* 256* 256+
-                 (unsigned int)msg_inp[ 93]* 256+
-                 (unsigned int)msg_inp[ 92];
-
-                if ((debug& DBG_MSI) != 0)
-                {
-                  fprintf( stderr,
-                   " Firmware version:        0x%08x\n", fw_version);
-                }
-              }
-              if (bc >= 100)
-              {
-                cc_version =                    /* CC3300 Firmware Version. */
-                 (unsigned int)msg_inp[ 99]* 256* 256* 256+
-                 (unsigned int)msg_inp[ 98]* 256* 256+
-                 (unsigned int)msg_inp[ 97]* 256+
-                 (unsigned int)msg_inp[ 96];
-
-                if ((debug& DBG_MSI) != 0)
-                {
-                  fprintf( stderr,
-                   " CC3300 Firmware version: 0x%08x\n", cc_version);
-                }
-              }
-              if (bc >= 102)
-              {
-                server_port =                   /* Server port. */
-                 (unsigned int)msg_inp[ 101]* 256+
-                 (unsigned int)msg_inp[ 100];
-
-                if ((debug& DBG_MSI) != 0)
-                {
-                  fprintf( stderr, " Server port: code: %d (0x%04x)\n",
-                   server_port, server_port);
-                }
-              }
-              if (bc >= 106)
-              {
-                server_ip =                     /* Server IP address. */
-                 (unsigned int)msg_inp[ 102]* 256* 256* 256+
-                 (unsigned int)msg_inp[ 103]* 256* 256+
-                 (unsigned int)msg_inp[ 104]* 256+
-                 (unsigned int)msg_inp[ 105];
-
-                if ((debug& DBG_MSI) != 0)
-                {
-                  fprintf( stderr,
-                   " Server IP address: 0x%08x %u.%u.%u.%u\n",
-                   server_ip, msg_inp[ 102], msg_inp[ 103],
-                   msg_inp[ 104], msg_inp[ 105]);
-                }
-              }
-              if (bc >= 108)
-              {
-                remote_port =                   /* Remote port. */
-                 (unsigned int)msg_inp[ 107]* 256+
-                 (unsigned int)msg_inp[ 106];
-
-                if ((debug& DBG_MSI) != 0)
-                {
-                  fprintf( stderr, " Remote port: %d (0x%04x)\n",
-                   remote_port, remote_port);
-                }
-              }
-              if (bc >= 148)
-              {
-                memcpy( remote_name, &msg_inp[ 108], 40);
-                remote_name[ 40] = '\0';
-
-                if ((debug& DBG_MSI) != 0)
-                {
-                  fprintf( stderr, " Remote name: >%s<\n", remote_name);
-                }
-              }
-              if (bc >= 152)
-              {
-                local_ip =                      /* Local IP address. */
-                 (unsigned int)msg_inp[ 148]* 256* 256* 256+
-                 (unsigned int)msg_inp[ 149]* 256* 256+
-                 (unsigned int)msg_inp[ 150]* 256+
-                 (unsigned int)msg_inp[ 151];
-
-                if ((debug& DBG_MSI) != 0)
-                {
-                  fprintf( stderr,
-                   " Local IP address: 0x%08x %u.%u.%u.%u\n",
-                   local_ip, msg_inp[ 148], msg_inp[ 149],
-                   msg_inp[ 150], msg_inp[ 151]);
-                }
-              }
-              if (bc >= 156)
-              {
-                local_gw =                      /* Local gateway address. */
-                 (unsigned int)msg_inp[ 152]* 256* 256* 256+
-                 (unsigned int)msg_inp[ 153]* 256* 256+
-                 (unsigned int)msg_inp[ 154]* 256+
-                 (unsigned int)msg_inp[ 155];
-
-                if ((debug& DBG_MSI) != 0)
-                {
-                  fprintf( stderr,
-                   " Local GW address: 0x%08x %u.%u.%u.%u\n",
-                   local_gw, msg_inp[ 152], msg_inp[ 153],
-                   msg_inp[ 154], msg_inp[ 155]);
-                }
-              }
-              if (bc >= 160)
-              {
-                local_nm =                      /* Local netmask. */
-                 (unsigned int)msg_inp[ 156]* 256* 256* 256+
-                 (unsigned int)msg_inp[ 157]* 256* 256+
-                 (unsigned int)msg_inp[ 158]* 256+
-                 (unsigned int)msg_inp[ 159];
-
-                if ((debug& DBG_MSI) != 0)
-                {
-                  fprintf( stderr,
-                   " Local Netmask:    0x%08x %u.%u.%u.%u\n",
-                   local_nm, msg_inp[ 156], msg_inp[ 157],
-                   msg_inp[ 158], msg_inp[ 159]);
-                }
-              }
-              if (bc >= 161)
-              {
-                if ((debug& DBG_MSI) != 0)
-                {
-                  fprintf( stderr, " DHCP: %d (0x%02x)\n",
-                    msg_inp[ 160], msg_inp[ 160]);
-                }
-              }
-              if (bc >= 162)
-              {
-                if ((debug& DBG_MSI) != 0)
-                {
-                  fprintf( stderr, " Discoverable: %d (0x%02x)\n",
-                   msg_inp[ 161], msg_inp[ 161]);
-                }
-              }
-              if (bc >= 163)
-              {
-                if ((debug& DBG_MSI) != 0)
-                {
-                  fprintf( stderr, " Time zone set: %d (0x%02x)\n",
-                   msg_inp[ 162], msg_inp[ 162]);
-                }
-              }
-              if (bc >= 164)
-              {
-                if ((debug& DBG_MSI) != 0)
-                {
-                  fprintf( stderr, " Time zone: %d (0x%02x)\n",
-                   (char)msg_inp[ 163], msg_inp[ 163]);
-                }
-              }
-              if (bc >= 166)
-              {
-                countdown_sts =                 /* Countdown status. */
-                 (unsigned short)msg_inp[ 165]* 256+
-                 (unsigned short)msg_inp[ 164];
-                if ((debug& DBG_MSI) != 0)
-                {
-                  fprintf( stderr, " Countdown status: %d (0x%04x)\n",
-                   countdown_sts, countdown_sts);
-                }
-              }
-              if (bc >= 168)
-              {
-                countdown =                     /* Countdown (s). */
-                 (unsigned short)msg_inp[ 167]* 256+
-                 (unsigned short)msg_inp[ 166];
-                if ((debug& DBG_MSI) != 0)
-                {
-                  fprintf( stderr, " Countdown: %d (0x%04x)\n",
-                   countdown, countdown);
-                }
-                save_orv_data = RSP_RT;         /* Found good data (rt). */
-              }
-            } /* table_nr == 4 */
-          }
-          else if ((msg_inp[ 4] == 's') && (msg_inp[ 5] == 'f'))
-          { /* Device control (Switch Off/On) ("sf"). */
-            *rsp_p |= RSP_SF;
-            if (bc >= 12)
-            {
-              mac_addr_ndx = 6;
-            }
-            if (bc >= 23)
-            {
-              state_new = msg_inp[ 22];
-              save_orv_data = RSP_SF;           /* Found good data (sf). */
-            }
-          }
-          else if ((msg_inp[ 4] == 't') && (msg_inp[ 5] == 'm'))
-          { /* Write Table ("tm"). */
-            *rsp_p |= RSP_TM;
-            if (bc >= 12)
-            {
-              mac_addr_ndx = 6;
-            }
-            if (bc >= 23)
-            { /* We expect 23 bytes.  Can't really tell good from bad. */
-#if 0
-              save_orv_data = RSP_TM;           /* Found good data (tm). */
-#endif /* 0 */
-            }
-          }
-          else
-          { /* Unknown. */
-            *rsp_p |= RSP___;
-            if ((debug& DBG_MSI) != 0)
-            {
-              fprintf( stderr,
-               " Unexpected response: \"%c%c\" (%.1x%.1x).\n",
-               msg_inp[ 4], msg_inp[ 5], msg_inp[ 4], msg_inp[ 5]);
-            }
-          }
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-          if ((debug& DBG_MSI) != 0)
-          {
-             if ((state_old >= 0) || (state_new >= 0))
-             {
-              char state_new_str[ 16];
-              char state_old_str[ 16];
+/* ctl_reply(): Send a control request's report and result, then close
+ *              the connection (fd = -1: served).  The last reply line
+ *              is the result: "= sts name state".  (An HTTP API
+ *              request gets an HTTP response instead.)
+ */
 
-              sprintf( state_new_str, "%2.2x", state_new);
-              sprintf( state_old_str, "%2.2x", state_old);
+void ctl_reply( orv_ctl_req_t *req_p, orv_data_t *origin_p)
+{
+  FILE *fp;
+  orv_data_t *orv_data_p;
 
-              fprintf( stderr, "   States: old = %s, new = %s.\n",
-               ((state_old < 0) ? "??" : state_old_str),
-               ((state_new < 0) ? "??" : state_new_str));
-            }
+  if (req_p->self != 0)
+  { /* Daemon's own request.  No one to tell. */
+    req_p->fd = -1;
+    return;
+  }
+  if (req_p->http != NULL)
+  { /* HTTP API request.  (The connection persists.) */
+    http_reply( req_p);
+    req_p->fd = -1;
+    return;
+  }
 
-            if (mac_addr_ndx >= 0)
-            {
-              int i;
-
-              fprintf( stderr, "   MAC addr: ");
-              for (i = mac_addr_ndx; i < mac_addr_ndx+ MAC_ADDR_SIZE; i++)
-              {
-                fprintf( stderr, "%02x", msg_inp[ i]);
-                if (i < mac_addr_ndx+ MAC_ADDR_SIZE- 1)
-                {
-                  fprintf( stderr, ":");
-                }
-                if (i == mac_addr_ndx+ MAC_ADDR_SIZE- 1)
-                {
-                  fprintf( stderr, "\n");
-                }
-              }
-            }
-          }
-        }
+  fp = fdopen( req_p->fd, "w");
+  if (fp == NULL)
+  {
+    close( req_p->fd);
+  }
+  else
+  {
+    if (req_p->sts == CTL_OK)
+    {
+      orv_data_p = origin_p->next;
+      while (orv_data_p != origin_p)
+      {
+        orv_data_p->cnt_flg = ((orv_data_p == req_p->dev) ? 1 : 0);
+        orv_data_p = orv_data_p->next;
       }
+      fprintf_device_list( fp,
+       (req_p->flags| ((req_p->dev == NULL) ? 0 : FDL_SINGLE)), origin_p);
     }
-    if ((save_orv_data > 0) && (mac_addr_ndx >= 0))
+    if (req_p->msg != NULL)
     {
-      orv_data_p = orv_data_find_mac( origin_p,
-                                      &msg_inp[ mac_addr_ndx]);
+      fprintf( fp, "! %s\n", req_p->msg);
+    }
+    fprintf( fp, "= %d %s %d\n", req_p->sts, ctl_sts_name[ req_p->sts],
+     (((req_p->sts == CTL_OK) && (req_p->dev != NULL)) ?
+     req_p->dev->state : -1));
+    fclose( fp);
+  }
+  req_p->fd = -1;
+}
 
-      if ((debug& DBG_MSI) != 0)
-      {
-        fprintf( stderr, " s_o_d = %d, o_f_d_m() = %sNULL.\n",
-         save_orv_data, ((orv_data_p == NULL)  ? "" : "non-"));
-      }
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-      if (orv_data_p == NULL)
-      {
-        orv_data_p = orv_data_new( origin_p,
-         ((origin_p->sort_key == SRT_IP) ?
-         (void *)&sock_addr_rec.sin_addr :              /* IP address. */
-         (void *)&msg_inp[ mac_addr_ndx]));             /* MAC address. */
+/* ctl_serve(): Perform one (lead) control request (or one slice of
+ *              it), then, if finished, reply to it, and to the requests
+ *              coalesced with it.  Count their queueing delays (arrival
+ *              to start, by priority class).
+ */
 
-        if (orv_data_p == NULL)
-        {
-          fprintf( stderr, "%s: malloc() failed [1].\n", PROGRAM_NAME);
-        }
-        else
-        {
-          memcpy( orv_data_p->mac_addr, &msg_inp[ mac_addr_ndx],
-           MAC_ADDR_SIZE);
-          orv_data_p->ip_addr.s_addr = sock_addr_rec.sin_addr.s_addr;
-        }
-      }
-      else if (save_orv_data == RSP_RT)
-      { /* Have Read Table (detailed) data. */
-        memcpy( orv_data_p->passwd, remote_password, PASSWORD_LEN);
-        memcpy( orv_data_p->name, device_name, DEV_NAME_LEN);
-        orv_data_p->type = icon_code;
-        orv_data_p->port = server_port;
-      }
-      if (state_new >= 0)
-      {
-        orv_data_p->state = state_new;
-      }
-      else if (state_old >= 0)
-      {
-        orv_data_p->state = state_old;
-      }
+void ctl_serve( orv_ctl_req_t *req, int req_cnt, int lead,
+ orv_data_t *origin_p)
+{
+  int cls;
+  int i;
+  unsigned long delay;
+  unsigned long t_beg;
+
+  t_beg = ms_time();
+  for (i = 0; i < req_cnt; i++)
+  {
+    if ((req[ i].fd >= 0) && (req[ i].queued != 0) &&
+     ((i == lead) || (req[ i].lead == &req[ lead])))
+    {
+      req[ i].queued = 0;
+      cls = req[ i].cls;
+      delay = t_beg- req[ i].t_arr;
+      metrics.pri_cnt[ cls]++;
+      metrics.pri_wait[ cls] += delay;
+      metrics.pri_wait_max[ cls] = OMAX( metrics.pri_wait_max[ cls], delay);
     }
   }
 
-#ifdef VMS
-# ifndef NO_OPER_PRIVILEGE
-  /* Restore original OPER privilege state, if elevated. */
-  if (oper_priv_save == 0)      /* Was set (not -1), and initial was zero. */
+  req[ lead].sts = ctl_perform( &req[ lead], origin_p);
+
+  for (i = 0; (i < req_cnt) && (req[ lead].pos == 0); i++)
   {
-    sts = set_priv_oper( 0, &oper_priv_save);
+    if ((req[ i].fd >= 0) && ((i == lead) || (req[ i].lead == &req[ lead])))
+    {
+      req[ i].sts = req[ lead].sts;             /* Share the result. */
+      req[ i].msg = req[ lead].msg;
+      ctl_reply( &req[ i], origin_p);
+    }
+  }
+}
 
-    if (sts != 0)
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* shm_create(): Create and map a daemon's shared state table (file).
+ *               Any old file is removed first (not truncated), so that
+ *               a reader which still maps it is not hurt.
+ */
+
+orvl_shm_hdr_t *shm_create( char *shm_name)
+{
+  int fd;
+  size_t siz;
+  void *map_p = MAP_FAILED;
+  orvl_shm_hdr_t *hdr_p = NULL;
+
+  siz = ORVL_SHM_HDR_SIZE+ SHM_REC_MAX* sizeof( orvl_shm_rec_t);
+  unlink( shm_name);
+  fd = open( shm_name, (O_RDWR| O_CREAT| O_EXCL), 0644);
+  if (fd < 0)
+  {
+    fprintf( stderr, "%s: Create shared table (%s) failed.\n",
+     PROGRAM_NAME, shm_name);
+    show_errno( PROGRAM_NAME);
+  }
+  else
+  {
+    if (ftruncate( fd, siz) == 0)
     {
-      fprintf( stderr,
-       "%s: Remove privilege (OPER) failed.  sts = %%x%08x .\n",
-       PROGRAM_NAME, sts);
-      show_errno( PROGRAM_NAME);
+      map_p = mmap( NULL, siz, (PROT_READ| PROT_WRITE), MAP_SHARED, fd, 0);
     }
-    else if ((debug& DBG_VMS) != 0)
+    if (map_p == MAP_FAILED)
     {
-      fprintf( stderr,
-       " set_priv_oper(restore).  sts = %%x%08x , oper_old = %d.\n",
-       sts, oper_priv_save);
+      fprintf( stderr, "%s: Map shared table (%s) failed.\n",
+       PROGRAM_NAME, shm_name);
+      show_errno( PROGRAM_NAME);
+      unlink( shm_name);
+    }
+    else
+    { /* (New file is all zero.) */
+      hdr_p = map_p;
+      hdr_p->version = ORVL_SHM_VERSION;
+      hdr_p->hdr_size = ORVL_SHM_HDR_SIZE;
+      hdr_p->rec_size = sizeof( orvl_shm_rec_t);
+      hdr_p->rec_max = SHM_REC_MAX;
+      hdr_p->pid = getpid();
+      ORVL_SHM_BARRIER();
+      hdr_p->magic = ORVL_SHM_MAGIC;    /* Valid, now. */
     }
+    close( fd);
   }
-# endif /* ndef NO_OPER_PRIVILEGE */
-#endif /* def VMS */
+  return hdr_p;
+}
 
-  if (!BAD_SOCKET( sock_orv))
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* shm_publish(): Copy the LL device data into the shared state table.
+ *                A new device gets the next free slot, which it keeps.
+ *                Only a changed record is rewritten (sequence lock:
+ *                odd while changing).  Returns the changed record count.
+ */
+
+int shm_publish( orvl_shm_hdr_t *hdr_p, orv_data_t *origin_p)
+{
+  int chg = 0;
+  int nam_len;
+  orvl_shm_rec_t rec;
+  orvl_shm_rec_t *rec_p;
+  orv_data_t *orv_data_p;
+
+  for (orv_data_p = origin_p->next; orv_data_p != origin_p;
+   orv_data_p = orv_data_p->next)
   {
-    CLOSE_SOCKET( sock_orv);
+    if (orv_data_p->shm_slot == 0)
+    { /* New device.  Assign a slot, if any is free. */
+      if (hdr_p->rec_cnt >= hdr_p->rec_max)
+      {
+        continue;
+      }
+      orv_data_p->shm_slot = hdr_p->rec_cnt+ 1;
+    }
+    rec_p = (orvl_shm_rec_t *)((char *)hdr_p+ hdr_p->hdr_size)+
+     (orv_data_p->shm_slot- 1);
+
+    /* Form the new record, and compare it with the old one. */
+    memset( &rec, 0, sizeof( rec));
+    rec.seq = rec_p->seq;
+    rec.ip_addr = orv_data_p->ip_addr.s_addr;
+    memcpy( rec.mac_addr, orv_data_p->mac_addr, MAC_ADDR_SIZE);
+    rec.type = (signed char)orv_data_p->type;
+    rec.state = (signed char)orv_data_p->state;
+    dev_name( orv_data_p, rec.name, &nam_len);
+    rec.rtt_ms = orv_data_p->rtt_ms;
+    rec.seen = orv_data_p->state_t;
+
+    if (memcmp( &rec, rec_p, sizeof( rec)) != 0)
+    {
+      rec_p->seq = rec.seq+ 1;                  /* Odd: Changing. */
+      ORVL_SHM_BARRIER();
+      memcpy( ((char *)rec_p)+ sizeof( rec.seq),
+       ((char *)&rec)+ sizeof( rec.seq), sizeof( rec)- sizeof( rec.seq));
+      ORVL_SHM_BARRIER();
+      rec_p->seq = rec.seq+ 2;                  /* Even: Stable. */
+      chg++;
+    }
+    if (orv_data_p->shm_slot > hdr_p->rec_cnt)
+    { /* (New record complete.)  Make it visible. */
+      hdr_p->rec_cnt = orv_data_p->shm_slot;
+    }
   }
-
-  if ((debug& DBG_MSI) != 0)
+  if (chg > 0)
   {
-    fprintf( stderr, " task(end).  sts = %d.\n", sts);
+    ORVL_SHM_BARRIER();
+    hdr_p->gen++;
   }
-  return sts;
+  return chg;
 }
 
 /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-/* msleep(): Suspend process for <arg> milliseconds.
- * <arg> < 1000 if using usleep().
+/* shm_remove(): Clear the shared table record of a device which the
+ *               daemon dropped (all-zero MAC address, state and type
+ *               -1), under its sequence lock.  The slot is not reused.
  */
 
-#ifdef _WIN32                   /* Windows: Use msleep(). */
+void shm_remove( orvl_shm_hdr_t *hdr_p, orv_data_t *orv_data_p)
+{
+  unsigned int seq;
+  orvl_shm_rec_t *rec_p;
 
-int msleep( int msec)
+  if (orv_data_p->shm_slot != 0)
+  {
+    rec_p = (orvl_shm_rec_t *)((char *)hdr_p+ hdr_p->hdr_size)+
+     (orv_data_p->shm_slot- 1);
+    seq = rec_p->seq;
+    rec_p->seq = seq+ 1;                        /* Odd: Changing. */
+    ORVL_SHM_BARRIER();
+    memset( ((char *)rec_p)+ sizeof( rec_p->seq), 0,
+     sizeof( *rec_p)- sizeof( rec_p->seq));
+    rec_p->type = -1;
+    rec_p->state = -1;
+    ORVL_SHM_BARRIER();
+    rec_p->seq = seq+ 2;                        /* Even: Stable. */
+    hdr_p->gen++;
+    orv_data_p->shm_slot = 0;
+  }
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* sub_watch(): Open the daemon's watch socket (subscribe to all the
+ *              devices, and schedule the renewals on a timing wheel)
+ *              when there are change subscribers, and close it when
+ *              there are none.  Return the watch socket.
+ */
+
+SOCKET sub_watch( SOCKET sock_wch, orv_wheel_t *wheel_p,
+ orv_data_t *origin_p)
 {
-  Sleep( msec);
-  return 0;
+  int cnt = 0;
+  int i;
+  orv_data_t *orv_data_p;
+
+  for (i = 0; i < SUB_MAX; i++)
+  {
+    cnt += ((subs[ i].fd >= 0) ? 1 : 0);
+  }
+
+  if ((cnt > 0) && BAD_SOCKET( sock_wch))
+  {
+    sock_wch = task_sock_open( 0, origin_p->cnt_flg);
+    if (!BAD_SOCKET( sock_wch))
+    {
+      for (orv_data_p = origin_p->next; orv_data_p != origin_p;
+       orv_data_p = orv_data_p->next)
+      {
+        orv_data_p->cnt_flg = 1;
+        orv_data_p->pend = 1;
+      }
+      task_send_burst( sock_wch, TSK_SUBSCRIBE, origin_p, 0, NULL);
+      wheel_init( wheel_p, origin_p);
+      for (orv_data_p = origin_p->next; orv_data_p != origin_p;
+       orv_data_p = orv_data_p->next)
+      {
+        orv_data_p->pend = 0;
+      }
+    }
+  }
+  else if ((cnt == 0) && !BAD_SOCKET( sock_wch))
+  {
+    CLOSE_SOCKET( sock_wch);
+    sock_wch = INVALID_SOCKET;
+  }
+  return sock_wch;
 }
 
-#else /* def _WIN32 */          /* Non-Windows: Use usleep(). */
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-int msleep( int msec)
+/* snap_read(): Populate the orv_data LL from a daemon snapshot (an
+ *              inventory cache, written when a daemon stopped).  A bad
+ *              snapshot is discarded.  Return the device count (0: cold
+ *              start).
+ */
+
+int snap_read( char *snap_name, orv_data_t *origin_p)
 {
+  int line_nr;
   int sts;
+  char err_tkn[ CLG_LINE_MAX];
+  FILE *fp;
 
-  if (msec >= 1000)
+  fp = fopen( snap_name, "r");
+  if (fp == NULL)
   {
-    errno = EINVAL;
-    sts = -1;
+    return 0;                   /* (None yet.) */
   }
-  else
+
+  sts = catalog_devices_ddf( fp, &line_nr, err_tkn, origin_p);
+  fclose( fp);
+  if (sts != 0)
   {
-    sts = usleep( msec* 1000);
+    fprintf( stderr, "%s: Bad snapshot (%d) at line %d (ignored): %s\n",
+     PROGRAM_NAME, sts, line_nr, snap_name);
+    while (origin_p->next != origin_p)
+    {
+      orv_data_unlink( origin_p, origin_p->next);
+    }
   }
-  return sts;
+
+  if ((debug& DBG_DEV) != 0)
+  {
+    fprintf( stderr, " snap_read().  devices = %d.\n", origin_p->cnt_flg);
+  }
+  return origin_p->cnt_flg;
 }
 
-#endif /* def _WIN32 [else] */
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* ddf_watch(): Start watching a daemon's DDF for changes: with
+ *              inotify, watch its directory (so that a replacement,
+ *              like an editor's rename, is seen, too).  Otherwise,
+ *              (or if inotify fails), ddf_check() uses stat().
+ *              Return the inotify descriptor, or -1.
+ */
+
+int ddf_watch( char *ddf_name)
+{
+  int fd = -1;
+  char *cp;
+#ifdef USE_INOTIFY
+  char dir[ CLG_LINE_MAX];
+#endif /* def USE_INOTIFY */
+
+  cp = strrchr( ddf_name, '/');
+  ddf_base = ((cp == NULL) ? ddf_name : (cp+ 1));
+#ifdef USE_INOTIFY
+  if (cp == NULL)
+  {
+    strcpy( dir, ".");
+  }
+  else if (cp- ddf_name < (int)sizeof( dir)- 1)
+  {
+    sprintf( dir, "%.*s", (int)((cp == ddf_name) ? 1 : (cp- ddf_name)),
+     ddf_name);
+  }
+  else
+  {
+    return -1;
+  }
+
+  fd = inotify_init1( IN_NONBLOCK| IN_CLOEXEC);
+  if ((fd >= 0) && (inotify_add_watch( fd, dir,
+   (IN_CLOSE_WRITE| IN_MOVED_TO)) < 0))
+  {
+    close( fd);
+    fd = -1;
+  }
+  if ((debug& DBG_ACT) != 0)
+  {
+    fprintf( stderr, " ddf_watch().  dir = >%s<, fd = %d.\n", dir, fd);
+  }
+#endif /* def USE_INOTIFY */
+
+  if (stat( ddf_name, &ddf_st) != 0)
+  {
+    memset( &ddf_st, 0, sizeof( ddf_st));
+  }
+  return fd;
+}
 
 /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-/* task_retry(): Execute task() with retries.
- *               Retry until rsp_req condition is met, or retry limit is
- *               reached.
+/* ddf_event(): Read the (readable) DDF watch (inotify) events, and note
+ *              (ddf_changed) any for the DDF.
  */
 
-int task_retry( int rsp_req,            /* Response requirement bit mask. */
-                int task_nr,            /* Task number. */
-                int *rsp_p,             /* Response type bit mask. */
-                unsigned char **tbl_p,  /* Table data. */
-                orv_data_t *origin_p,   /* orv_data origin. */
-                orv_data_t *target_p)   /* orv_data target. */
+void ddf_event( void)
 {
-  int retry_count = 0;
-  int sts = 0;
+#ifdef USE_INOTIFY
+  char *cp;
+  ssize_t bc;
+  struct inotify_event *ev_p;
+  long buf[ 1024];              /* Events.  (Aligned.) */
 
-  while ((sts == 0) &&
-   ((*rsp_p& rsp_req) == 0) &&
-   (retry_count < TASK_RETRY_MAX))
+  while ((bc = read( ddf_ino, buf, sizeof( buf))) > 0)
   {
-    if (retry_count > 0)
+    for (cp = (char *)buf; cp < (char *)buf+ bc;
+     cp += sizeof( *ev_p)+ ev_p->len)
     {
-      if (((debug& DBG_MSI) != 0) || ((debug& DBG_MSO) != 0))
+      ev_p = (struct inotify_event *)cp;
+      if ((ev_p->len > 0) && (strcmp( ev_p->name, ddf_base) == 0))
       {
-        fprintf( stderr,
-         " TASK RETRY (%d).  N = %d, rsp = %08x , rsp_req = %08x .\n",
-         task_nr, retry_count, *rsp_p, rsp_req);
+        ddf_changed = 1;
       }
-      msleep( TASK_RETRY_WAIT);         /* Delay (ms) between retries. */
     }
-    sts = task( task_nr, rsp_p, tbl_p, origin_p, target_p);
-    retry_count++;
   }
-  return sts;
+#endif /* def USE_INOTIFY */
 }
 
 /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
+/* ddf_check(): Has a daemon's DDF changed since it was last read?
+ *              (inotify: an event was seen.  Otherwise: a different
+ *              file, size, or modification time.)
+ */
 
-/* catalog_devices_ddf(): Use file data to populate the orv_data LL. */
+int ddf_check( char *ddf_name)
+{
+  int chg;
+  struct stat st;
 
-#define CLG_LINE_MAX 256
+  if (ddf_ino >= 0)
+  {
+    chg = ddf_changed;
+  }
+  else
+  {
+    chg = ((stat( ddf_name, &st) == 0) &&
+     ((st.st_ino != ddf_st.st_ino) || (st.st_size != ddf_st.st_size) ||
+     (st.st_mtime != ddf_st.st_mtime)));
+  }
+  if (chg != 0)
+  {
+    ddf_changed = 0;
+    if (stat( ddf_name, &ddf_st) != 0)
+    {
+      memset( &ddf_st, 0, sizeof( ddf_st));
+    }
+  }
+  return chg;
+}
 
-int catalog_devices_ddf( FILE *fp,              /* File pointer. */
-                         int *clg_line_nr,      /* File line number. */
-                         char *err_tkn,         /* Bad token. */
-                         orv_data_t *origin_p)  /* LL origin. */
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* ddf_reload(): Read a (changed) DDF again, and apply only the
+ *               differences to the orv_data LL: add the new devices
+ *               (cnt_flg = 1, others 0), remove the devices no longer
+ *               listed, and change the IP address and name of the
+ *               others, which keep everything else (state,
+ *               subscription, RTT, ...).  Devices are matched by MAC
+ *               address.  A removed device's shared table record
+ *               (shm_p, if not NULL) is cleared.  A bad DDF is ignored
+ *               (with a message).  Return the count of devices
+ *               added, removed, or changed, or -1, if error.
+ */
+
+int ddf_reload( char *ddf_name, orv_data_t *origin_p,
+ orvl_shm_hdr_t *shm_p)
 {
-  int sts = 0;
-  char clg_line[ CLG_LINE_MAX+ 1];              /* fgets() buffer. */
-  char *cp;                                     /* fgets() result, ... */
-  char *ipa;                                    /* IP address string. */
-  char *mac;                                    /* MAC address string. */
-  char *nam;                                    /* Device name string. */
-  int fl;                                       /* file line length, ... */
-  struct in_addr ip_addr;                       /* IP address. */
-  unsigned char mac_b[ 6];                      /* MAC address. */
+  int add = 0;
+  int chg = 0;
+  int del = 0;
+  int line_nr;
+  int sts;
+  char err_tkn[ CLG_LINE_MAX];
+  FILE *fp;
+  orv_data_t ddf_origin;        /* The new DDF data (LL origin). */
+  orv_data_t *new_p;
   orv_data_t *orv_data_p;
+  orv_data_t *orv_data_next_p;
 
-  *clg_line_nr = 0;                             /* File line number. */
-  while ((cp = fgets( clg_line, CLG_LINE_MAX, fp)) != NULL)
+  memset( &ddf_origin, 0, sizeof( ddf_origin));
+  ddf_origin.next = &ddf_origin;
+  ddf_origin.prev = &ddf_origin;
+  ddf_origin.sort_key = origin_p->sort_key;
+
+  fp = fopen( ddf_name, "r");
+  if (fp == NULL)
   {
-    (*clg_line_nr)++;                   /* Count this line. */
-    ipa = NULL;                         /* Clear token pointers. */
-    mac = NULL;
-    nam = NULL;
+    fprintf( stderr, "%s: Open (read) failed: %s\n", PROGRAM_NAME, ddf_name);
+    show_errno( PROGRAM_NAME);
+    return -1;
+  }
+  sts = catalog_devices_ddf( fp, &line_nr, err_tkn, &ddf_origin);
+  fclose( fp);
+  if (sts != 0)
+  {
+    fprintf( stderr, "%s: Bad DDF (%d) at line %d (not reloaded): %s\n",
+     PROGRAM_NAME, sts, line_nr, ddf_name);
+  }
+
+  /* Removed and changed devices.  (A changed IP address may change the
+   * device's place in the LL (sort_key).  Flag it (pend) for later.)
+   */
+  orv_data_p = origin_p->next;
+  while ((sts == 0) && (orv_data_p != origin_p))
+  {
+    orv_data_next_p = orv_data_p->next;
+    orv_data_p->cnt_flg = 0;
+    new_p = orv_data_find_mac( &ddf_origin, orv_data_p->mac_addr);
+    if (new_p == NULL)
+    { /* Removed.  (Its storage may still be in use.  Not recycled.) */
+      orv_data_unlink( origin_p, orv_data_p);
+      if (shm_p != NULL)
+      {
+        shm_remove( shm_p, orv_data_p);
+      }
+      del++;
+    }
+    else
+    {
+      if ((new_p->ip_addr.s_addr != orv_data_p->ip_addr.s_addr) ||
+       (memcmp( new_p->name, orv_data_p->name, DEV_NAME_LEN) != 0))
+      { /* Changed. */
+        if (new_p->ip_addr.s_addr != orv_data_p->ip_addr.s_addr)
+        {
+          orv_data_p->ip_addr.s_addr = new_p->ip_addr.s_addr;
+          orv_data_p->t_sent = 0;
+          orv_data_p->pend = 1;
+        }
+        memcpy( orv_data_p->name, new_p->name, DEV_NAME_LEN);
+        chg++;
+      }
+      orv_data_unlink( &ddf_origin, new_p);
+      orv_data_recycle( new_p);
+    }
+    orv_data_p = orv_data_next_p;
+  }
+
+  orv_data_p = origin_p->next;
+  while ((sts == 0) && (origin_p->sort_key == SRT_IP) &&
+   (orv_data_p != origin_p))
+  { /* Re-sort any device with a new IP address. */
+    orv_data_next_p = orv_data_p->next;
+    if (orv_data_p->pend != 0)
+    {
+      orv_data_p->pend = 0;
+      orv_data_unlink( origin_p, orv_data_p);
+      orv_data_link( origin_p, orv_data_p);
+    }
+    orv_data_p = orv_data_next_p;
+  }
+
+  /* Added devices (the rest of the new DDF data), or (error) discards. */
+  while (ddf_origin.next != &ddf_origin)
+  {
+    new_p = ddf_origin.next;
+    orv_data_unlink( &ddf_origin, new_p);
+    if (sts == 0)
+    {
+      new_p->cnt_flg = 1;
+      orv_data_link( origin_p, new_p);
+      add++;
+    }
+    else
+    {
+      orv_data_recycle( new_p);
+    }
+  }
+
+  if (sts == 0)
+  {
+    metrics.ddf_reload++;
+    metrics.ddf_add += add;
+    metrics.ddf_del += del;
+    metrics.ddf_chg += chg;
+  }
+  if ((debug& DBG_ACT) != 0)
+  {
+    fprintf( stderr,
+     " ddf_reload().  sts = %d, added = %d, removed = %d, changed = %d.\n",
+     sts, add, del, chg);
+  }
+  return ((sts == 0) ? (add+ del+ chg) : -1);
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-    clg_line[ CLG_LINE_MAX] = '\0';     /* Make buffer-end tidy. */
-    fl = strlen( clg_line);
-    if ((fl > 0) && (clg_line[ fl- 1] == '\n'))
-    {
-      clg_line[ fl- 1] = '\0';          /* Strip off a new-line. */
-    }
+/* daemon_wait(): Wait (up to tmo_ms) for a control connection.
+ *                Meanwhile, serve the change subscribers: process
+ *                device messages on the watch socket (if open), send
+ *                the renewals due, send queued change records, and
+ *                close the connections of subscribers which hang up.
+ *                Also serve the HTTP API connections (if any): answer
+ *                lookups, and add device requests to the daemon's
+ *                requests (req, *req_cnt_p).
+ *                Return 1, if a control connection is waiting, 2, if
+ *                HTTP API requests were added, else 0 (time-out,
+ *                signal, or DDF changed).
+ */
 
-    if ((cp = strchr( clg_line, '#')) != NULL)  /* Trim comment. */
-    {
-      *cp = '\0';
+int daemon_wait( int sock_ctl, SOCKET sock_wch, orv_wheel_t *wheel_p,
+ orv_data_t *origin_p, orv_ctl_req_t *req, int *req_cnt_p, long tmo_ms)
+{
+  int fd_max;
+  int i;
+  int req_cnt0;
+  int rsp;
+  int sts;
+  int wait_ms = WHEEL_TICK;
+  long tmo;
+  ssize_t bc;
+  unsigned long t_end;
+  char buf[ 64];
+  fd_set fds_rd;
+  fd_set fds_wr;
+  struct timeval tv;
+
+  req_cnt0 = *req_cnt_p;
+  t_end = ms_time()+ tmo_ms;
+  while (1)
+  {
+    if (!BAD_SOCKET( sock_wch))
+    { /* Send any renewals due. */
+      wheel_advance( sock_wch, wheel_p, origin_p, &wait_ms);
     }
 
-    if (strlen( clg_line) > 0)          /* Trim leading white space. */
-    {
-      cp = clg_line;
-      while (isspace( *cp))
+    for (i = 0; i < HTTP_CONN_MAX; i++)
+    { /* Handle the HTTP API requests held (not waiting for a device). */
+      http_parse( &http_conn[ i], origin_p, req, req_cnt_p);
+      if (http_conn[ i].fd >= 0)
       {
-        cp++;
+        http_flush( &http_conn[ i]);
       }
     }
-
-    if (strlen( cp) == 0)               /* No data on line. */
+    if (*req_cnt_p > req_cnt0)
     {
-      continue;
+      return 2;
     }
 
-    if (strlen( cp) > 0)
+    FD_ZERO( &fds_rd);
+    FD_ZERO( &fds_wr);
+    FD_SET( sock_ctl, &fds_rd);
+    fd_max = sock_ctl;
+    if (!BAD_SOCKET( sock_wch))
     {
-      ipa = cp;                         /* IP address. */
-      while (!isspace( *cp))
-      {
-        cp++;
-      }
-      *cp++ = '\0';                     /* NUL-terminate at first space. */
+      FD_SET( sock_wch, &fds_rd);
+      fd_max = OMAX( fd_max, sock_wch);
     }
-
-    if (strlen( cp) > 0)                /* Skip white space. */
+    for (i = 0; i < SUB_MAX; i++)
     {
-      while (isspace( *cp))
-      {
-        cp++;
-      }
-
-      mac = cp;                         /* MAC address. */
-      while (!isspace( *cp))
-      {
-        cp++;
+      if (subs[ i].fd >= 0)
+      { /* (Readable: Hang-up, or junk.) */
+        FD_SET( subs[ i].fd, &fds_rd);
+        if (subs[ i].q_cnt > 0)
+        {
+          FD_SET( subs[ i].fd, &fds_wr);
+        }
+        fd_max = OMAX( fd_max, subs[ i].fd);
       }
-      *cp++ = '\0';                     /* NUL-terminate at first space. */
     }
-
-    if (strlen( cp) > 0)
+    if (sock_http >= 0)
     {
-      while (isspace( *cp))             /* Skip white space. */
-      {
-        cp++;
-      }
-
-      nam = cp;                         /* Device name. */
-      if (*cp == '>')                   /* Apparently, ">name<". */
+      FD_SET( sock_http, &fds_rd);
+      fd_max = OMAX( fd_max, sock_http);
+    }
+    if (ddf_ino >= 0)
+    {
+      FD_SET( ddf_ino, &fds_rd);
+      fd_max = OMAX( fd_max, ddf_ino);
+    }
+    for (i = 0; i < HTTP_CONN_MAX; i++)
+    {
+      if (http_conn[ i].fd >= 0)
       {
-        nam++;
-        while ((*cp != '\0') && (*cp != '<'))
+        if ((http_conn[ i].hangup == 0) &&
+         (http_conn[ i].in_len < HTTP_IN_MAX))
         {
-          cp++;
+          FD_SET( http_conn[ i].fd, &fds_rd);
         }
-        *cp++ = '\0';                   /* NUL-terminate at "<". */
-      }
-      else
-      {
-        while (!isspace( *cp))
+        if (http_conn[ i].out.len > 0)
         {
-          cp++;
+          FD_SET( http_conn[ i].fd, &fds_wr);
         }
-        *cp++ = '\0';                   /* NUL-terminate at first space. */
+        fd_max = OMAX( fd_max, http_conn[ i].fd);
       }
     }
 
-    if (ipa == NULL)
-    {
-      sts = -2;
-      break;
-    }
-
-    if (mac == NULL)
-    {
-      sts = -3;
-      break;
-    }
-    if (nam == NULL)
+    tmo = OMAX( 0, (long)(t_end- ms_time()));
+    if (!BAD_SOCKET( sock_wch))
     {
-      sts = -4;
-      break;
+      tmo = OMIN( tmo, OMAX( 1, wait_ms));
     }
-
-    if ((debug& DBG_FIL) != 0)
+    tv.tv_sec = tmo/ 1000;
+    tv.tv_usec = (tmo% 1000)* 1000;
+    sts = select( (fd_max+ 1), &fds_rd, &fds_wr, NULL, &tv);
+    if (sts < 0)
     {
-      fprintf( stderr, " ipa: >%s<, mac: >%s<, nam: >%s<\n", ipa, mac, nam);
+      return 0;                                 /* Signal. */
     }
 
-    sts = dns_resolve( ipa, &ip_addr);
-    if (sts != 0)
-    {
-      sts = -5;
-      fprintf( stderr, "%s: Bad IP address on line %d: >%s<.\n",
-       PROGRAM_NAME, *clg_line_nr, ipa);
-      break;
+    if ((sts > 0) && !BAD_SOCKET( sock_wch) && FD_ISSET( sock_wch, &fds_rd))
+    { /* Device messages ("sf", "cl", ...).  Report any changes. */
+      rsp = 0;
+      task_recv( sock_wch, 0, &rsp, NULL, origin_p, NULL, 0,
+       &wheel_p->drops);
+      sub_notify( origin_p);
     }
 
-    sts = parse_mac( mac, mac_b);
-    if (sts != 0)
+    for (i = 0; (sts > 0) && (i < SUB_MAX); i++)
     {
-      sts = -6;
-      fprintf( stderr, "%s: Bad MAC address on line %d: >%s<.\n",
-       PROGRAM_NAME, *clg_line_nr, mac);
-      break;
+      if ((subs[ i].fd >= 0) && FD_ISSET( subs[ i].fd, &fds_rd))
+      {
+        bc = read( subs[ i].fd, buf, sizeof( buf));
+        if ((bc == 0) || ((bc < 0) &&
+         (errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)))
+        { /* Subscriber gone. */
+          sub_close( &subs[ i]);
+        }
+      }
+      if ((subs[ i].fd >= 0) && FD_ISSET( subs[ i].fd, &fds_wr))
+      {
+        sub_flush( &subs[ i]);
+      }
     }
 
-    fl = strlen( nam);
-    if (fl > DEV_NAME_LEN)
-    {
-      sts = -7;
-      fprintf( stderr,
-       "%s: Name too long (len = %d > %d) on line %d: >%s<.\n",
-       PROGRAM_NAME, fl, DEV_NAME_LEN, *clg_line_nr, nam);
-      break;
+    if ((sts > 0) && (ddf_ino >= 0) && FD_ISSET( ddf_ino, &fds_rd))
+    { /* DDF watch events.  (DDF changed: Return, to reload it.) */
+      ddf_event();
+      if (ddf_changed != 0)
+      {
+        return 0;
+      }
     }
-    /* (Check name for invalid characters?  What's valid?) */
 
-    orv_data_p = orv_data_new( origin_p,
-     ((origin_p->sort_key == SRT_IP) ? (void *)&ip_addr : (void *)mac_b));
-
-    if (orv_data_p == NULL)
+    if ((sts > 0) && (sock_http >= 0) && FD_ISSET( sock_http, &fds_rd))
     {
-      fprintf( stderr, "%s: malloc() failed [2].\n", PROGRAM_NAME);
-      break;
+      http_accept();
     }
-    else
+    for (i = 0; (sts > 0) && (i < HTTP_CONN_MAX); i++)
     {
-      memcpy( orv_data_p->mac_addr, mac_b, MAC_ADDR_SIZE);      /* MAC addr. */
-      orv_data_p->ip_addr.s_addr = ip_addr.s_addr;              /* IP addr. */
-      if ((fl == strlen( UNSET_NAME)) &&
-       (memcmp( nam, UNSET_NAME, strlen( UNSET_NAME)) == 0))
+      if ((http_conn[ i].fd >= 0) && FD_ISSET( http_conn[ i].fd, &fds_rd))
       {
-        memset( orv_data_p->name, 0xff, DEV_NAME_LEN);  /* Unset name. */
+        bc = read( http_conn[ i].fd, (http_conn[ i].in+ http_conn[ i].in_len),
+         (HTTP_IN_MAX- http_conn[ i].in_len));
+        if (bc > 0)
+        {
+          http_conn[ i].in_len += bc;
+        }
+        else if ((bc == 0) || ((errno != EAGAIN) &&
+         (errno != EWOULDBLOCK) && (errno != EINTR)))
+        { /* Client done (or gone).  Finish its complete requests. */
+          http_conn[ i].hangup = 1;
+        }
       }
-      else
+      if ((http_conn[ i].fd >= 0) && FD_ISSET( http_conn[ i].fd, &fds_wr))
       {
-        memcpy( orv_data_p->name, nam, fl);             /* Device name. */
-        memset( orv_data_p->name+ fl, 0x20,             /* Blank fill. */
-         (DEV_NAME_LEN- fl));
+        http_flush( &http_conn[ i]);
       }
     }
-  } /* while */
 
-  if ((debug& DBG_FIL) != 0)
-  {
-    fprintf( stderr, " catalog_devices_ddf(end).  sts = %d.\n", sts);
-    fprintf_device_list( stdout, FDL_DDF, origin_p);
+    if ((sts > 0) && FD_ISSET( sock_ctl, &fds_rd))
+    {
+      return 1;
+    }
+    if ((long)(t_end- ms_time()) <= 0)
+    {
+      return 0;
+    }
   }
-  return sts;
 }
 
 /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-/* discover_devices(): Use Unit Discovery to populate the orv_data LL. */
+/* daemon_run(): Serve control requests on a Unix-domain socket until
+ *               interrupted.  Requests which arrive together (within
+ *               COALESCE_WAIT of the first, or queued while a batch is
+ *               performed) form a batch, which is coalesced, so that
+ *               identical requests share one device exchange.  A
+ *               batch is performed by priority class (PRI_xxx), within
+ *               the class limits (pri_limit[]).  Before a background
+ *               (refresh, bulk) request, any new requests are gathered
+ *               first.  Requests not performed are kept for the next
+ *               batch.  With a shared state table (shm_name), the
+ *               device data are published after every batch.  Change
+ *               subscribers are served while the daemon waits, and get
+ *               the changes seen in every batch.  So are the HTTP API
+ *               connections (http_port), whose device requests join the
+ *               batches like control requests.  Inherited sockets
+ *               (listen_fds()) replace the ones it would open.  After a
+ *               warm start (device data from a snapshot), the daemon
+ *               revalidates the devices with its own background
+ *               (bulk) "qlist" request.  When it stops, it writes the
+ *               snapshot (snap_name).  With a DDF (ddf_name), the
+ *               daemon applies any changes to the DDF between batches
+ *               (ddf_reload()).
+ */
 
-int discover_devices( int single, orv_data_t *origin_p)
+int daemon_run( orv_data_t *origin_p, char *ctl_name, char *cache_name,
+ char *shm_name, int http_port, char *snap_name, int warm, char *ddf_name)
 {
-  int rsp;
-  int sts;
+  int cls;
+  int done;
+  int i;
+  int j;
+  int lim;
+  int req_cnt = 0;
+  int sock_ctl;
+  int sts = 0;
+  int w;
+  int yield;
+  unsigned long t_end;
+  SOCKET sock_wch = INVALID_SOCKET;     /* Watch socket (subscribers). */
+  orvl_shm_hdr_t *shm_p = NULL;
   orv_data_t *orv_data_p;
+  static orv_ctl_req_t req[ CTL_REQ_MAX];
+  static orv_wheel_t wheel;     /* Renewal timing wheel (subscribers). */
 
-  if ((debug& DBG_DEV) != 0)
+  if (shm_name != NULL)
   {
-    fprintf( stderr, " disc_devs(0).  single = %08x .\n", single);
+    shm_p = shm_create( shm_name);
+    if (shm_p == NULL)
+    {
+      return -1;
+    }
+    shm_publish( shm_p, origin_p);      /* Initial inventory. */
   }
 
-  orv_data_p = origin_p->next;      /* Start with first (real?) LL mmbr. */
-  while (orv_data_p != origin_p)    /* Quit when back to the origin. */
+  sock_ctl = ((sock_ctl_inh >= 0) ? sock_ctl_inh : ctl_open( ctl_name));
+  if (sock_ctl < 0)
   {
-    if ((debug& DBG_DEV) != 0)
-    {
-      fprintf( stderr, " disc_devs(1).  cnt_flg = %d.\n", orv_data_p->cnt_flg);
-      fprintf_device( stderr, orv_data_p);
-    }
+    return -1;
+  }
 
-    if ((single == 0) || (orv_data_p->cnt_flg != 0))
+  for (i = 0; i < HTTP_CONN_MAX; i++)
+  {
+    http_conn[ i].fd = -1;
+    http_conn[ i].out.data = NULL;
+  }
+  if ((http_port > 0) && (sock_http < 0))
+  {
+    sock_http = http_open( http_port);
+    if (sock_http < 0)
     {
-      /* Send Unit Discovery message.  Expect some "qg" response. */
-      rsp = 0;
-      sts = task_retry( RSP_QG, TSK_UNIT_DISC, &rsp, NULL,
-       origin_p, orv_data_p);
-      if (sts != 0)
+      close( sock_ctl);
+      if (sock_ctl_inh < 0)
       {
-        fprintf( stderr, "%s: Unit discovery.  sts = %d.\n",
-         PROGRAM_NAME, sts);
-        break;
+        unlink( ctl_name);
       }
+      return -1;
     }
-    orv_data_p = orv_data_p->next;  /* Advance to the next member. */
-  } /* while */
+  }
 
-  if ((debug& DBG_DEV) != 0)
+  if (warm != 0)
+  { /* Warm start.  Revalidate the snapshot data in the background. */
+    ctl_self( &req[ req_cnt++], sock_ctl, OPR_QLIST, PRI_BULK, NULL);
+  }
+  if (ddf_name != NULL)
   {
-    fprintf( stderr, " disc_devs(end).  sts = %d.\n", sts);
+    ddf_ino = ddf_watch( ddf_name);
   }
-  return sts;
-}
-
-/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-/* query_devices(): Query devices to populate the orv_data LL. */
 
-int query_devices( int single, orv_data_t *origin_p)
-{
-  int rsp;
-  int sts;
-  orv_data_t *orv_data_p;
+  /* Stop on SIGINT or SIGTERM (like "watch").  Survive a client which
+   * disconnects before its reply.
+   */
+  watch_stop = 0;
+  signal( SIGINT, watch_sig);
+  signal( SIGTERM, watch_sig);
+  signal( SIGPIPE, SIG_IGN);
 
-  if ((debug& DBG_DEV) != 0)
+  for (i = 0; i < SUB_MAX; i++)
   {
-    fprintf( stderr, " query_devs(0).  single = %08x .\n", single);
+    subs[ i].fd = -1;
   }
+  sub_notify( origin_p);                /* Initial change snapshots. */
 
-  orv_data_p = origin_p->next;      /* Start with first (real?) LL mmbr. */
-  while (orv_data_p != origin_p)    /* Quit when back to the origin. */
+  while (watch_stop == 0)
   {
-    if ((debug& DBG_DEV) != 0)
-    {
-      fprintf( stderr, " query_devs(1).  cnt_flg = %d.\n", orv_data_p->cnt_flg);
-      fprintf_device( stderr, orv_data_p);
-    }
-
-    if ((single == 0) || (orv_data_p->cnt_flg != 0))
-    {
-      /* Send Subscribe message.  Expect some "cl" response. */
-      rsp = 0;
-      sts = task_retry( RSP_CL, TSK_SUBSCRIBE, &rsp, NULL,
-       origin_p, orv_data_p);
-      if (sts != 0)
+    if ((ddf_name != NULL) && (ddf_check( ddf_name) != 0) &&
+     (ddf_reload( ddf_name, origin_p, shm_p) > 0))
+    { /* DDF changed.  Fail the requests for removed devices. */
+      for (i = 0; i < req_cnt; i++)
       {
-        fprintf( stderr, "%s: Read table: socket.  sts = %d.\n",
-         PROGRAM_NAME, sts);
-        break;
+        if ((req[ i].sts == CTL_OK) && (req[ i].dev != NULL) &&
+         (orv_data_find_mac( origin_p, req[ i].dev->mac_addr) !=
+         req[ i].dev))
+        {
+          req[ i].sts = CTL_BAD;
+          req[ i].msg = "Device removed (DDF).";
+        }
       }
 
-      if (sts == 0)
+      /* Look up (Unit discovery) the added devices, in the background. */
+      for (orv_data_p = origin_p->next;
+       (orv_data_p != origin_p) && (req_cnt < CTL_REQ_MAX);
+       orv_data_p = orv_data_p->next)
       {
-        /* Send Read table: socket message.  Expect some "rt" response. */
-        rsp = 0;
-        sts = task_retry( RSP_RT, TSK_RT_SOCKET, &rsp, NULL,
-         origin_p, orv_data_p);
-        if (sts != 0)
+        if (orv_data_p->cnt_flg != 0)
         {
-          fprintf( stderr, "%s: Read table: socket.  sts = %d.\n",
-           PROGRAM_NAME, sts);
-          break;
+          ctl_self( &req[ req_cnt++], sock_ctl, OPR_LIST, PRI_CONTROL,
+           orv_data_p);
+        }
+      }
+
+      if (!BAD_SOCKET( sock_wch))
+      { /* Watching.  Drop the removed devices from the timing wheel,
+         * and subscribe to (and add) only the added devices.  (The
+         * others keep their subscriptions and wheel slots.)
+         */
+        wheel_prune( &wheel, origin_p);
+        for (orv_data_p = origin_p->next; orv_data_p != origin_p;
+         orv_data_p = orv_data_p->next)
+        {
+          orv_data_p->pend = orv_data_p->cnt_flg;
+        }
+        task_send_burst( sock_wch, TSK_SUBSCRIBE, origin_p, 0, NULL);
+        for (orv_data_p = origin_p->next; orv_data_p != origin_p;
+         orv_data_p = orv_data_p->next)
+        {
+          if (orv_data_p->cnt_flg != 0)
+          {
+            wheel_add( &wheel, orv_data_p);
+          }
+          orv_data_p->pend = 0;
         }
       }
+      if (shm_p != NULL)
+      {
+        shm_publish( shm_p, origin_p);
+      }
+      sub_notify( origin_p);            /* (Names, IP addresses.) */
     }
-    orv_data_p = orv_data_p->next;  /* Advance to the next member. */
-  } /* while */
 
-  if ((debug& DBG_DEV) != 0)
-  {
-    fprintf( stderr, " query_devs(end).  sts = %d.\n", sts);
-  }
-  return sts;
-}
+    sock_wch = sub_watch( sock_wch, &wheel, origin_p);
+    if (req_cnt == 0)
+    { /* Idle.  Wait for a first request, then gather for COALESCE_WAIT. */
+      if (daemon_wait( sock_ctl, sock_wch, &wheel, origin_p,
+       req, &req_cnt, 1000) <= 0)
+      {
+        continue;                       /* Time-out, or signal. */
+      }
+      t_end = ms_time()+ COALESCE_WAIT;
+    }
+    else
+    { /* Deferred requests.  Gather only the requests already queued. */
+      t_end = ms_time();
+    }
 
-/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+    while ((req_cnt < CTL_REQ_MAX) && (watch_stop == 0) &&
+     ((w = daemon_wait( sock_ctl, sock_wch, &wheel, origin_p, req,
+     &req_cnt, OMAX( 0, (long)(t_end- ms_time())))) > 0))
+    {
+      if ((w == 1) && (req_cnt < CTL_REQ_MAX) &&
+       (ctl_accept( sock_ctl, &req[ req_cnt], origin_p) == 0))
+      {
+        req_cnt++;
+      }
+    }
 
-/* catalog_devices_live(): Use Global Discovery to populate the orv_data LL. */
+    i = ctl_coalesce( req, req_cnt);
+    if ((debug& DBG_ACT) != 0)
+    {
+      fprintf( stderr, " daemon_run().  requests = %d, perform = %d.\n",
+       req_cnt, i);
+    }
 
-int catalog_devices_live( orv_data_t *origin_p)
-{
-  int rsp;
-  int sts;
+    /* Reply now to the bad and superseded requests. */
+    for (i = 0; i < req_cnt; i++)
+    {
+      if (req[ i].sts != CTL_OK)
+      {
+        ctl_reply( &req[ i], origin_p);
+      }
+    }
 
-  /* Broadcast query (Global discovery).  Expect some "qa" response. */
-  rsp = 0;
-  sts = task_retry( RSP_QA, TSK_GLOB_DISC_B, &rsp, NULL,
-   origin_p, origin_p);
-  if (sts == 0)
-  {
-    if (origin_p->cnt_flg == 0)
+    /* Perform (and reply to) the lead requests, by priority class. */
+    done = 0;
+    yield = 0;
+    for (cls = 0; (cls < PRI_CNT) && (yield == 0); cls++)
     {
-      fprintf( stderr, "%s: No devices found (loc=cdl).\n", PROGRAM_NAME);
-      errno = ENXIO;
-      sts = -1;
+      lim = pri_limit[ cls];
+      for (i = 0; (i < req_cnt) && (lim > 0); i++)
+      {
+        if ((req[ i].fd >= 0) && (req[ i].lead == NULL) &&
+         (req[ i].cls == cls))
+        {
+          if ((cls >= PRI_REFRESH) && (req[ i].yielded == 0) &&
+           (req_cnt < CTL_REQ_MAX) && (ctl_wait( sock_ctl, 0) > 0))
+          { /* New request(s) waiting.  Gather them before this one.
+             * (Only once per request (slice), so that a steady stream
+             * of new requests can't starve it.)
+             */
+            req[ i].yielded = 1;
+            yield = 1;
+            break;
+          }
+          req[ i].yielded = 0;
+          ctl_serve( req, req_cnt, i, origin_p);
+          done++;
+          lim--;
+        }
+      }
     }
-    else
+
+    /* Keep (in arrival order) the requests not yet served. */
+    j = 0;
+    for (i = 0; i < req_cnt; i++)
     {
-      if ((debug& DBG_DEV) != 0)
+      if (req[ i].fd >= 0)
       {
-        fprintf( stderr, " Devices found: %d.\n", origin_p->cnt_flg);
+        req[ j++] = req[ i];
       }
+    }
+    req_cnt = j;
 
-      sts = query_devices( 0, origin_p);        /* Query all devs in the LL. */
+    if ((done > 0) && (cache_name != NULL))
+    { /* Share the device states (and table data) through the cache. */
+      cache_write( cache_name, origin_p);
+    }
+    if ((done > 0) && (shm_p != NULL))
+    { /* Publish the device states in the shared table. */
+      shm_publish( shm_p, origin_p);
+    }
+    if (done > 0)
+    { /* Tell the subscribers what changed. */
+      sub_notify( origin_p);
     }
   }
 
-  if ((debug& DBG_DEV) != 0)
+  for (i = 0; i < req_cnt; i++)
+  { /* Stopped.  Release any deferred requests. */
+    if ((req[ i].http == NULL) && (req[ i].self == 0))
+    {
+      close( req[ i].fd);
+    }
+  }
+  if ((snap_name != NULL) && (origin_p->cnt_flg > 0))
+  { /* Save the device data for the next (warm) start. */
+    cache_write( snap_name, origin_p);
+  }
+  for (i = 0; i < HTTP_CONN_MAX; i++)
   {
-    fprintf( stderr, " catalog_devices_live(end).  sts = %d.\n", sts);
+    if (http_conn[ i].fd >= 0)
+    {
+      http_close( &http_conn[ i]);
+    }
+  }
+  if (sock_http >= 0)
+  {
+    close( sock_http);
+    sock_http = -1;
+  }
+  for (i = 0; i < SUB_MAX; i++)
+  { /* End the subscriptions (normally). */
+    if (subs[ i].fd >= 0)
+    {
+      sub_flush( &subs[ i]);
+    }
+    if (subs[ i].fd >= 0)
+    {
+      sub_queue( &subs[ i], "= 0 ok -1\n");
+      sub_flush( &subs[ i]);
+      sub_close( &subs[ i]);
+    }
+  }
+  if (!BAD_SOCKET( sock_wch))
+  {
+    CLOSE_SOCKET( sock_wch);
+  }
+  if (ddf_ino >= 0)
+  {
+    close( ddf_ino);
+    ddf_ino = -1;
+  }
+  signal( SIGINT, SIG_DFL);
+  signal( SIGTERM, SIG_DFL);
+  signal( SIGPIPE, SIG_DFL);
+  close( sock_ctl);
+  if (sock_ctl_inh < 0)
+  { /* (An inherited socket belongs to the service manager.) */
+    unlink( ctl_name);
+  }
+  if (shm_p != NULL)
+  { /* Keep the table (for its readers), but mark the daemon stopped. */
+    shm_p->pid = 0;
+    munmap( (void *)shm_p,
+     shm_p->hdr_size+ (size_t)shm_p->rec_max* shm_p->rec_size);
   }
   return sts;
 }
 
 /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-/* keyword_match(): Match abbreviated keyword against keyword array. */
+/* ctl_request(): Client: Send one request to a daemon (control socket),
+ *                and display its reply.  Store a single-device state
+ *                (at the LL origin, for the exit status).  A
+ *                "subscribe" reply (change records) lasts until the
+ *                daemon stops, or the client is interrupted.
+ */
 
-int keyword_match( char *arg, int kw_cnt, char **kw_array)
+int ctl_request( char *ctl_name, char *opr, char *ident, int flags,
+ orv_data_t *origin_p)
 {
-  int cmp_len;
-  int kw_ndx;
-  int match = -1;
+  int got = 0;
+  int result = CTL_FAILED;
+  int sock_ctl;
+  int state = -1;
+  int sts = 0;
+  FILE *fp;
+  char line[ CLG_LINE_MAX];
+  struct sockaddr_un addr;
 
-  cmp_len = strlen( arg);
-  for (kw_ndx = 0; kw_ndx < kw_cnt; kw_ndx++)
+  if (strlen( ctl_name) >= sizeof( addr.sun_path))
   {
-    if (STRNCASECMP( arg, kw_array[ kw_ndx], cmp_len) == 0)
+    fprintf( stderr, "%s: Control socket name too long: %s\n",
+     PROGRAM_NAME, ctl_name);
+    errno = ENAMETOOLONG;
+    return EXIT_FAILURE;
+  }
+
+  memset( &addr, 0, sizeof( addr));
+  addr.sun_family = AF_UNIX;
+  strcpy( addr.sun_path, ctl_name);
+
+  sock_ctl = socket( AF_UNIX, SOCK_STREAM, 0);
+  if (sock_ctl < 0)
+  {
+    fprintf( stderr, "%s: socket() (ctl) failed.\n", PROGRAM_NAME);
+    show_errno( PROGRAM_NAME);
+    return EXIT_FAILURE;
+  }
+  if (connect( sock_ctl, (struct sockaddr *)&addr, sizeof( addr)) != 0)
+  {
+    fprintf( stderr, "%s: connect() (ctl) failed: %s\n",
+     PROGRAM_NAME, ctl_name);
+    show_errno( PROGRAM_NAME);
+    close( sock_ctl);
+    return EXIT_FAILURE;
+  }
+
+  sprintf( line, "%s%s%s%s%s\n",
+   (((flags& FDL_BRIEF) != 0) ? "brief " : ""),
+   (((flags& FDL_QUIET) != 0) ? "quiet " : ""),
+   opr, ((ident == NULL) ? "" : " "), ((ident == NULL) ? "" : ident));
+  if (write( sock_ctl, line, strlen( line)) != (ssize_t)strlen( line))
+  {
+    fprintf( stderr, "%s: write() (ctl) failed.\n", PROGRAM_NAME);
+    show_errno( PROGRAM_NAME);
+    close( sock_ctl);
+    return EXIT_FAILURE;
+  }
+
+  fp = fdopen( sock_ctl, "r");
+  if (fp == NULL)
+  {
+    close( sock_ctl);
+  }
+  else
+  {
+    while (fgets( line, sizeof( line), fp) != NULL)
     {
-      if (match < 0)
-      {
-        match = kw_ndx;         /* Record first match. */
+      if (line[ 0] == '=')
+      { /* Result. */
+        got = (sscanf( line, "= %d %*s %d", &result, &state) == 2);
+      }
+      else if (line[ 0] == '!')
+      { /* Message. */
+        fprintf( stderr, "%s: %s", PROGRAM_NAME, (line+ 2));
       }
       else
-      {
-        match = -2;             /* Record multiple match, */
-        break;                  /* and quit early. */
+      { /* Report (or change record). */
+        fputs( line, stdout);
+        fflush( stdout);
       }
     }
+    fclose( fp);
   }
-  return match;
+
+  if (got == 0)
+  {
+    fprintf( stderr, "%s: No result from daemon: %s\n",
+     PROGRAM_NAME, ctl_name);
+    errno = ECONNRESET;
+    sts = EXIT_FAILURE;
+  }
+  else if (result != CTL_OK)
+  {
+    errno = ((result == CTL_SUPERSEDED) ? ECANCELED :
+     ((result == CTL_BAD) ? EINVAL : EIO));
+    sts = EXIT_FAILURE;
+  }
+  else
+  {
+    origin_p->state = state;
+  }
+  return sts;
 }
 
+#endif /* def USE_DAEMON */
+
 /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 /* main(): Main program. */
@@ -2921,7 +10427,9 @@ int keyword_match( char *arg, int kw_cnt, char **kw_array)
 int main( int argc, char **argv)
 {
   int brief;
+  int expect_n = 0;
   int expect_set = 0;
+  int http_port = 0;
   int match_opr;
   int opts_ndx;
   int quiet;
@@ -2931,16 +10439,35 @@ int main( int argc, char **argv)
   int sts;
   int task_nr;
   size_t cmp_len;
+  char *cache_file_name = NULL;
+  char *ctl_name = NULL;
+  char *shm_file_name = NULL;
+  char *snap_file_name = NULL;
   char *orv_data_file_name = NULL;
   FILE *fp;
   char *new_dev_name = NULL;
   char *new_password = NULL;
   size_t new_dev_name_len;
   size_t new_password_len;
-  unsigned short msg_len;
-
-  unsigned char *msg_tmp1_p;
-  unsigned char *msg_tmp2_p;
+  int refresh = 0;              /* Re-query cached table data. */
+  int qry_flg;                  /* Query flags (cached table data). */
+  int expect_timers = 0;        /* Expect "timers" op. */
+  int tmr_add = 0;              /* Add timer (tmr_new). */
+  int tmr_del = -1;             /* Delete timer (record number). */
+  int tmr_cnt = 0;              /* Timer record count. */
+  int sched_fail = 0;           /* Schedule: failed device count. */
+  char *sched_file_name = NULL; /* Schedule file ("schedule="). */
+  int want_fail = 0;            /* Reconcile: failed device count. */
+  char *want_file_name = NULL;  /* Desired-state file ("state="). */
+  int group_fail = 0;           /* Group: failed device count. */
+  char *group_sel = NULL;       /* Group selectors ("group="). */
+  orv_timer_t tmr_new;          /* New timer ("timer="). */
+  orv_timer_t tmr[ TIMER_MAX];  /* Timer records ("timers"). */
+
+  int countdown = -1;           /* Countdown (s) ("countdown="). */
+  unsigned char countdown_buf[ COUNTDOWN_LEN];
+  unsigned char new_dev_name_buf[ DEV_NAME_LEN];
+  unsigned char new_password_buf[ PASSWORD_LEN];
 
   orv_data_t *orv_data_p;
 
@@ -2957,6 +10484,26 @@ int main( int argc, char **argv)
      { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },    /* passwd. */
      { 0, 0, 0, 0, 0, 0 },                      /* mac_addr */
      -1,                                        /* state. */
+     0,                                         /* seen. */
+     0,                                         /* pend. */
+     0,                                         /* fresh. */
+     0,                                         /* state_src. */
+     0.0,                                       /* state_t. */
+     0,                                         /* t_sent. */
+     0,                                         /* rtt_ms. */
+     0.0,                                       /* sub_t. */
+     0,                                         /* ivers. */
+     0,                                         /* shm_slot. */
+     0,                                         /* noted. */
+     -1,                                        /* note_state. */
+     { 0 },                                     /* note_ip. */
+     { 0 },                                     /* note_name. */
+     { { 0 }, { 0 }, { 0 }, { 0 }, { 0 }, { 0 }, { 0 }, { 0 }, 0 }, /* tpl. */
+     { 0 },                                     /* rt4. */
+     NULL,                                      /* rt3. */
+     NULL,                                      /* sched. */
+     NULL,                                      /* want. */
+     NULL                                       /* wheel_next. */
    };
 
   brief = 0;
@@ -3045,6 +10592,176 @@ int main( int argc, char **argv)
           match_opt = -1;                       /* Consumed. */
           orv_data_file_name = argv[ 1]+ cmp_len+ 1;
         }
+        else if (match_opt == OPT_CACHE)        /* "cache". */
+        { /* No "=file_spec".  Use environment variable. */
+          match_opt = -1;                       /* Consumed. */
+          cache_file_name = getenv( ORVL_CACHE);
+          if (cache_file_name == NULL)
+          {
+            cache_file_name = ORVL_CACHE;
+          }
+        }
+        else if (match_opt == OPT_CACHE_EQ)     /* "cache=file_spec". */
+        {
+          match_opt = -1;                       /* Consumed. */
+          cache_file_name = argv[ 1]+ cmp_len+ 1;
+        }
+        else if (match_opt == OPT_CTL)          /* "ctl". */
+        { /* No "=file_spec".  Use environment variable. */
+          match_opt = -1;                       /* Consumed. */
+          ctl_name = getenv( ORVL_CTL);
+          if (ctl_name == NULL)
+          {
+            ctl_name = ORVL_CTL;
+          }
+        }
+        else if (match_opt == OPT_CTL_EQ)       /* "ctl=file_spec". */
+        {
+          match_opt = -1;                       /* Consumed. */
+          ctl_name = argv[ 1]+ cmp_len+ 1;
+        }
+        else if (match_opt == OPT_SHM_EQ)       /* "shm=file_spec". */
+        {
+          match_opt = -1;                       /* Consumed. */
+          shm_file_name = argv[ 1]+ cmp_len+ 1;
+        }
+        else if (match_opt == OPT_SNAP_EQ)      /* "snap=file_spec". */
+        {
+          match_opt = -1;                       /* Consumed. */
+          snap_file_name = argv[ 1]+ cmp_len+ 1;
+        }
+        else if (match_opt == OPT_HTTP_EQ)      /* "http=port". */
+        {
+          match_opt = -1;                       /* Consumed. */
+          http_port = atoi( argv[ 1]+ cmp_len+ 1);
+          if ((http_port <= 0) || (http_port > 65535))
+          {
+            fprintf( stderr, "%s: Invalid port: %s\n",
+             PROGRAM_NAME, argv[ 1]);
+            errno = EINVAL;
+            sts = EXIT_FAILURE;
+            break; /* while */
+          }
+        }
+        else if (match_opt == OPT_EXPECT_EQ)    /* "expect=". */
+        {
+          match_opt = -1;                       /* Consumed. */
+          expect_n = strtol( (argv[ 1]+ cmp_len+ 1), NULL, 10);
+          if (expect_n < 0)
+          {
+            fprintf( stderr, "%s: Invalid device count: %s\n",
+             PROGRAM_NAME, argv[ 1]);
+            errno = EINVAL;
+            sts = EXIT_FAILURE;
+            break; /* while */
+          }
+        }
+        else if (match_opt == OPT_COLUMNS_EQ)   /* "columns=". */
+        {
+          match_opt = -1;                       /* Consumed. */
+          if (col_select( argv[ 1]+ cmp_len+ 1) != 0)
+          {
+            sts = EXIT_FAILURE;
+            break; /* while */
+          }
+        }
+        else if (match_opt == OPT_REFRESH)      /* "refresh". */
+        {
+          match_opt = -1;                       /* Consumed. */
+          refresh = 1;
+        }
+        else if (match_opt == OPT_TIMER_EQ)     /* "timer=". */
+        {
+          match_opt = -1;                       /* Consumed. */
+          expect_timers = 1;                    /* Expect "timers" op. */
+          tmr_add = 1;
+          if (timer_parse( (argv[ 1]+ cmp_len+ 1), &tmr_new) != 0)
+          {
+            sts = EXIT_FAILURE;
+            break; /* while */
+          }
+        }
+        else if (match_opt == OPT_SCHEDULE_EQ)  /* "schedule=". */
+        {
+          match_opt = -1;                       /* Consumed. */
+          expect_timers = 1;                    /* Expect "timers" op. */
+          sched_file_name = argv[ 1]+ cmp_len+ 1;
+        }
+        else if (match_opt == OPT_GROUP_EQ)     /* "group=". */
+        {
+          match_opt = -1;                       /* Consumed. */
+          group_sel = argv[ 1]+ cmp_len+ 1;
+        }
+        else if (match_opt == OPT_PACE_EQ)      /* "pace=count[/ms]". */
+        {
+          char *cp;
+
+          match_opt = -1;                       /* Consumed. */
+          pace.cnt = strtol( (argv[ 1]+ cmp_len+ 1), &cp, 10);
+          pace.ms = 1000;
+          if (*cp == '/')
+          {
+            pace.ms = strtol( (cp+ 1), &cp, 10);
+          }
+          if ((*cp != '\0') || (pace.cnt <= 0) || (pace.ms <= 0))
+          {
+            fprintf( stderr, "%s: Invalid pace (count[/ms]): %s\n",
+             PROGRAM_NAME, argv[ 1]);
+            errno = EINVAL;
+            sts = EXIT_FAILURE;
+            break; /* while */
+          }
+        }
+        else if (match_opt == OPT_MAXAGE_EQ)    /* "maxage=ms". */
+        {
+          char *cp;
+
+          match_opt = -1;                       /* Consumed. */
+          max_age = strtol( (argv[ 1]+ cmp_len+ 1), &cp, 10);
+          if ((*cp != '\0') || (cp == argv[ 1]+ cmp_len+ 1) || (max_age < 0))
+          {
+            fprintf( stderr, "%s: Invalid max age (ms): %s\n",
+             PROGRAM_NAME, argv[ 1]);
+            errno = EINVAL;
+            sts = EXIT_FAILURE;
+            break; /* while */
+          }
+        }
+        else if (match_opt == OPT_STATE_EQ)     /* "state=". */
+        {
+          match_opt = -1;                       /* Consumed. */
+          want_file_name = argv[ 1]+ cmp_len+ 1;
+        }
+        else if (match_opt == OPT_UNTIMER_EQ)   /* "untimer=". */
+        {
+          match_opt = -1;                       /* Consumed. */
+          expect_timers = 1;                    /* Expect "timers" op. */
+          tmr_del = strtol( (argv[ 1]+ cmp_len+ 1), NULL, 10);
+          if (tmr_del < 0)
+          {
+            fprintf( stderr, "%s: Invalid timer record number: %s\n",
+             PROGRAM_NAME, argv[ 1]);
+            errno = EINVAL;
+            sts = EXIT_FAILURE;
+            break; /* while */
+          }
+        }
+        else if (match_opt == OPT_COUNTDOWN_EQ) /* "countdown=". */
+        {
+          char *cp;
+
+          match_opt = -1;                       /* Consumed. */
+          countdown = strtol( (argv[ 1]+ cmp_len+ 1), &cp, 10);
+          if ((*cp != '\0') || (cp == argv[ 1]+ cmp_len+ 1) ||
+           (countdown < 0) || (countdown > COUNTDOWN_MAX))
+          {
+            fprintf( stderr, "%s: Invalid countdown (0-%d): %s\n",
+             PROGRAM_NAME, COUNTDOWN_MAX, argv[ 1]);
+            errno = EINVAL;
+            sts = EXIT_FAILURE;
+            break; /* while */
+          }
+        }
         else if (match_opt == OPT_DEBUG)        /* "debug". */
         {
           match_opt = -1;                       /* Consumed. */
@@ -3175,27 +10892,136 @@ int main( int argc, char **argv)
         errno = EINVAL;
         sts = EXIT_FAILURE;
       }
-      else if (match_opr < 0)           /* Not a known option.  Arg? */
-      { /* No match. */
-        fprintf( stderr, "%s: Invalid option/operation: >%s<.\n",
-         PROGRAM_NAME, argv[ 1]);
+      else if (match_opr < 0)           /* Not a known option.  Arg? */
+      { /* No match. */
+        fprintf( stderr, "%s: Invalid option/operation: >%s<.\n",
+         PROGRAM_NAME, argv[ 1]);
+        usage();
+        errno = EINVAL;
+        sts = EXIT_FAILURE;
+      }
+      else if ((expect_set != 0) && (match_opr != OPR_SET))
+      {
+        fprintf( stderr,
+"%s: \"name=\" or \"password=\" option, but operation not \"set\": %s\n",
+         PROGRAM_NAME, oprs[ match_opr]);
+        usage();
+        errno = EINVAL;
+        sts = EXIT_FAILURE;
+      }
+      else if ((countdown >= 0) && (match_opr != OPR_SET) &&
+       (match_opr != OPR_OFF) && (match_opr != OPR_ON))
+      {
+        fprintf( stderr,
+"%s: \"countdown=\" option, but op. not \"off\", \"on\", or \"set\": %s\n",
+         PROGRAM_NAME, oprs[ match_opr]);
+        usage();
+        errno = EINVAL;
+        sts = EXIT_FAILURE;
+      }
+      else if ((expect_set == 0) && (countdown < 0) && (match_opr == OPR_SET))
+      {
+        fprintf( stderr,
+"%s: Operation \"set\", but no \"name=\", \"password=\", or \"countdown=\".\n",
+         PROGRAM_NAME);
+        usage();
+        errno = EINVAL;
+        sts = EXIT_FAILURE;
+      }
+      else if ((expect_timers != 0) && (match_opr != OPR_TIMERS))
+      {
+        fprintf( stderr,
+"%s: \"[un]timer=\" or \"schedule=\" option, but op. not \"timers\": %s\n",
+         PROGRAM_NAME, oprs[ match_opr]);
+        usage();
+        errno = EINVAL;
+        sts = EXIT_FAILURE;
+      }
+      else if (((want_file_name == NULL) && (match_opr == OPR_RECONCILE)) ||
+       ((want_file_name != NULL) && (match_opr != OPR_RECONCILE)))
+      {
+        fprintf( stderr,
+         "%s: Option \"state=\" goes with (only) operation \"reconcile\".\n",
+         PROGRAM_NAME);
+        usage();
+        errno = EINVAL;
+        sts = EXIT_FAILURE;
+      }
+      else if ((max_age >= 0) &&
+       (((match_opr != OPR_LIST) && (match_opr != OPR_QLIST)) ||
+       (orv_data_file_name != NULL)))
+      {
+        fprintf( stderr,
+ "%s: Option \"maxage=\" needs operation \"list\" or \"qlist\", no DDF.\n",
+         PROGRAM_NAME);
+        usage();
+        errno = EINVAL;
+        sts = EXIT_FAILURE;
+      }
+      else if ((ctl_name != NULL) && (match_opr != OPR_DAEMON) &&
+       (((match_opr != OPR_LIST) && (match_opr != OPR_QLIST) &&
+       (match_opr != OPR_OFF) && (match_opr != OPR_ON) &&
+       (match_opr != OPR_WATCH)) ||
+       (countdown >= 0) || (group_sel != NULL) || (col_sel_cnt > 0) ||
+       (max_age >= 0)))
+      {
+        fprintf( stderr,
+ "%s: Option \"ctl\" needs op. [q]list, off, on, or watch (plain): %s\n",
+         PROGRAM_NAME, oprs[ match_opr]);
+        usage();
+        errno = EINVAL;
+        sts = EXIT_FAILURE;
+      }
+      else if ((shm_file_name != NULL) && (match_opr != OPR_DAEMON))
+      {
+        fprintf( stderr,
+         "%s: Option \"shm=\" needs operation \"daemon\".\n",
+         PROGRAM_NAME);
+        usage();
+        errno = EINVAL;
+        sts = EXIT_FAILURE;
+      }
+      else if ((http_port > 0) && (match_opr != OPR_DAEMON))
+      {
+        fprintf( stderr,
+         "%s: Option \"http=\" needs operation \"daemon\".\n",
+         PROGRAM_NAME);
+        usage();
+        errno = EINVAL;
+        sts = EXIT_FAILURE;
+      }
+      else if ((snap_file_name != NULL) && (match_opr != OPR_DAEMON))
+      {
+        fprintf( stderr,
+         "%s: Option \"snap=\" needs operation \"daemon\".\n",
+         PROGRAM_NAME);
+        usage();
+        errno = EINVAL;
+        sts = EXIT_FAILURE;
+      }
+      else if ((match_opr == OPR_DAEMON) && (argc > 2))
+      {
+        fprintf( stderr,
+         "%s: Operation \"daemon\" takes no identifier.\n",
+         PROGRAM_NAME);
         usage();
         errno = EINVAL;
         sts = EXIT_FAILURE;
       }
-      else if ((expect_set != 0) && (match_opr != OPR_SET))
+      else if ((group_sel != NULL) &&
+       (((match_opr != OPR_OFF) && (match_opr != OPR_ON)) || (argc > 2)))
       {
         fprintf( stderr,
-"%s: \"name=\" or \"password=\" option, but operation not \"set\": %s\n",
-         PROGRAM_NAME, oprs[ match_opr]);
+ "%s: Option \"group=\" needs operation \"off\" or \"on\", no identifier.\n",
+         PROGRAM_NAME);
         usage();
         errno = EINVAL;
         sts = EXIT_FAILURE;
       }
-      else if ((expect_set == 0) && (match_opr == OPR_SET))
+      else if ((sched_file_name != NULL) && ((tmr_add != 0) || (tmr_del >= 0)))
       {
         fprintf( stderr,
-"%s: Operation \"set\", but no \"name=\" or \"password=\" option.\n",
+         "%s: \"schedule=\" option, with \"timer=\" or \"untimer=\".\n",
          PROGRAM_NAME);
         usage();
         errno = EINVAL;
@@ -3204,9 +11030,10 @@ int main( int argc, char **argv)
       else if (argc < 3)
       {
         if ((match_opr == OPR_HEARTBEAT) ||
-         (match_opr == OPR_OFF) ||
-         (match_opr == OPR_ON) ||
-         (match_opr == OPR_SET))
+         (((match_opr == OPR_OFF) || (match_opr == OPR_ON)) &&
+          (group_sel == NULL)) ||
+         (match_opr == OPR_SET) ||
+         ((match_opr == OPR_TIMERS) && (sched_file_name == NULL)))
         {
           fprintf( stderr,
            "%s: Missing required device identifier for operation: %s\n",
@@ -3219,6 +11046,26 @@ int main( int argc, char **argv)
     }
   }
 
+  /* "daemon" needs a control socket.  Use the default, if none. */
+  if ((sts == 0) && (match_opr == OPR_DAEMON) && (ctl_name == NULL))
+  {
+    ctl_name = getenv( ORVL_CTL);
+    if (ctl_name == NULL)
+    {
+      ctl_name = ORVL_CTL;
+    }
+  }
+
+  /* "maxage=" needs the state cache.  Use the default cache, if none. */
+  if ((sts == 0) && (max_age >= 0) && (cache_file_name == NULL))
+  {
+    cache_file_name = getenv( ORVL_CACHE);
+    if (cache_file_name == NULL)
+    {
+      cache_file_name = ORVL_CACHE;
+    }
+  }
+
   /* Prepare for device communication. */
 
 #ifdef _WIN32
@@ -3337,15 +11184,46 @@ int main( int argc, char **argv)
     }
   }
 
+  /* Cached table data need only a table 1 (index) check, and a column
+   * report may be answered from cached table data with no query.
+   */
+  qry_flg = 0;
+  if ((sts == 0) && (cache_file_name != NULL) && (refresh == 0))
+  {
+    qry_flg = QRY_INDEX;
+    if ((col_sel_cnt > 0) || (match_opr == OPR_RECONCILE) ||
+     (group_sel != NULL))
+    {
+      qry_flg |= QRY_CACHED;
+    }
+  }
+
   if (sts == 0)
   {
-    if (match_opr == OPR_HEARTBEAT)
+    if ((ctl_name != NULL) && (match_opr != OPR_DAEMON))
+    { /* "ctl".  Send the request to a daemon, and show its reply. */
+#ifdef USE_DAEMON
+      sts = ctl_request( ctl_name,
+       ((match_opr == OPR_WATCH) ? "subscribe" : oprs[ match_opr]),
+       ((argc >= 3) ? argv[ 2] : NULL),
+       (((brief == 0) ? 0 : FDL_BRIEF) | ((quiet == 0) ? 0 : FDL_QUIET)),
+       &orv_data);
+#else /* def USE_DAEMON */
+      fprintf( stderr, "%s: Option \"ctl\" not supported.\n",
+       PROGRAM_NAME);
+      errno = EINVAL;
+      sts = EXIT_FAILURE;
+#endif /* def USE_DAEMON [else] */
+      quiet = 1;                        /* (Daemon reported.) */
+    }
+    else if (match_opr == OPR_HEARTBEAT)
     { /* "Heartbeat". */
       if (specific_ip == 0)
       { /* Unknown IP address.  Use broadcast query. */
         if (orv_data_file_name == NULL)
         {
-          sts = catalog_devices_live( &orv_data);
+          sts = catalog_devices_live( &orv_data, cache_file_name, expect_n,
+           qry_flg);
         }
       }
       else
@@ -3397,17 +11275,23 @@ int main( int argc, char **argv)
       { /* No DDF data available. */
         if ((single != 0) && (specific_ip == 0))
         { /* Have a device name (if anything valid).  Need full inventory. */
-          sts = catalog_devices_live( &orv_data);
+          sts = catalog_devices_live( &orv_data, cache_file_name, expect_n,
+           qry_flg);
         }
         else
         { /* General or specific IP address.  Discovery is enough. */
-          task_nr = (specific_ip == 0) ? TSK_GLOB_DISC_B : TSK_GLOB_DISC;
-          /* Send the appropriate (Global or Unit) discovery message.
-           * Expect some "qa" response.
-           */
-          rsp = 0;
-          sts = task_retry( RSP_QA, task_nr, &rsp, NULL,
-           &orv_data, &orv_data);
+          if (specific_ip == 0)
+          { /* Broadcast Global discovery (with gap-fill). */
+            sts = catalog_devices_disc( &orv_data, cache_file_name, expect_n);
+          }
+          else
+          { /* Send specific Global discovery message.
+             * Expect some "qa" response.
+             */
+            rsp = 0;
+            sts = task_retry( RSP_QA, TSK_GLOB_DISC, &rsp, NULL,
+             &orv_data, &orv_data);
+          }
 
           if ((specific_ip == 0) && (orv_data.cnt_flg == 0))
           {
@@ -3435,6 +11319,12 @@ int main( int argc, char **argv)
       { /* DDF data available.  Use Unit discovery to sense. */
         sts = discover_devices( single, &orv_data);
       }
+
+      if ((sts == 0) && (col_need_rt4() != 0))
+      { /* Selected columns need table data.  Query, if not cached. */
+        sts = query_devices( single, &orv_data,
+         ((refresh == 0) ? QRY_CACHED : 0));
+      }
     }
     else if (match_opr == OPR_QLIST)
     { /* "qlist".  List device(s), with query. */
@@ -3442,7 +11332,8 @@ int main( int argc, char **argv)
       { /* No DDF data available.  Must query devices.*/
         if (specific_ip == 0)
         { /* Do all, or could have a device name.  Need full inventory. */
-          sts = catalog_devices_live( &orv_data);
+          sts = catalog_devices_live( &orv_data, cache_file_name, expect_n,
+           qry_flg);
           if ((sts == 0) && (single != 0))
           { /* Match device name. */
             sts = orv_data_find_dev( &orv_data, specific_ip, argv[ 2], 1);
@@ -3458,7 +11349,7 @@ int main( int argc, char **argv)
             sts = orv_data_find_dev( &orv_data, specific_ip, argv[ 2], 1);
             if (sts == 0)
             { /* Query the single device. */
-              sts = query_devices( single, &orv_data);
+              sts = query_devices( single, &orv_data, qry_flg);
             }
           }
         }
@@ -3471,9 +11362,38 @@ int main( int argc, char **argv)
         }
         if (sts == 0)
         {
-          sts = query_devices( single, &orv_data);
+          sts = query_devices( single, &orv_data, qry_flg);
+        }
+      }
+    }
+    else if (((match_opr == OPR_OFF) || (match_opr == OPR_ON)) &&
+     (group_sel != NULL))
+    { /* "Off", "On" with "group=".  Switch a group (low skew). */
+      if (orv_data_file_name == NULL)
+      { /* Need full inventory (device names). */
+        sts = catalog_devices_live( &orv_data, cache_file_name, expect_n,
+         qry_flg);
+      }
+      if (sts == 0)
+      {
+        single = 1;
+        if (group_mark( &orv_data, group_sel) == 0)
+        {
+          fprintf( stderr, "%s: No device matched group: >%s<.\n",
+           PROGRAM_NAME, group_sel);
+          errno = ENXIO;
+          sts = EXIT_FAILURE;
         }
       }
+      if ((sts == 0) && (orv_data_file_name != NULL))
+      { /* DDF data available.  Use Unit discovery to sense. */
+        sts = discover_devices( single, &orv_data);
+      }
+      if (sts == 0)
+      {
+        task_nr = (match_opr == OPR_OFF) ? TSK_SW_OFF : TSK_SW_ON;
+        group_fail = sw_group( &orv_data, task_nr);
+      }
     }
     else if ((match_opr == OPR_OFF) || (match_opr == OPR_ON))
     { /* "Off", "On".  Device control: Switch Off/On. */
@@ -3481,7 +11401,8 @@ int main( int argc, char **argv)
       { /* Unknown IP address.  Use broadcast query. */
         if (orv_data_file_name == NULL)
         {
-          sts = catalog_devices_live( &orv_data);
+          sts = catalog_devices_live( &orv_data, cache_file_name, expect_n,
+           qry_flg);
         }
       }
       else
@@ -3532,6 +11453,15 @@ int main( int argc, char **argv)
           sts = task_retry( RSP_DC, task_nr, &rsp, NULL,
            &orv_data, orv_data_p);
         }
+        if ((sts == 0) && (countdown >= 0))
+        { /* Start (or cancel) a countdown (table 4).  The device
+           * toggles its switch state when the countdown expires.
+           */
+          orv_patch_t patch;
+
+          countdown_patch( countdown, countdown_buf, &patch);
+          sts = table4_write( &orv_data, orv_data_p, &patch, 1);
+        }
       }
     }
     else if (match_opr == OPR_SET)
@@ -3540,7 +11470,8 @@ int main( int argc, char **argv)
       { /* Unknown IP address.  Use broadcast query. */
         if (orv_data_file_name == NULL)
         {
-          sts = catalog_devices_live( &orv_data);
+          sts = catalog_devices_live( &orv_data, cache_file_name, expect_n,
+           qry_flg);
         }
       }
       else
@@ -3584,179 +11515,254 @@ int main( int argc, char **argv)
          &orv_data, orv_data_p);
         if (sts == 0)
         {
-          /* Send Read table: socket message.  Expect some "rt" response.
-           * Save the "rt" response for use (after modification) as the
-           * "tm" message. 
+          orv_patch_t patch[ 3];
+          int patch_cnt = 0;
+
+          /* Form a new "tm" message from the saved "rt" response, as a
+           * gather list over the "rt" data, with patches for the new
+           * password, device name, and countdown ("rt" offsets 58, 70,
+           * 164; "tm" 55, 67, 161).  (Patches must be in ascending
+           * offset order.)
            */
-          rsp = 0;
-          msg_tmp1_p = NULL;
-          msg_tmp2_p = NULL;
 
-          sts = task_retry( RSP_RT, TSK_RT_SOCKET, &rsp, &msg_tmp1_p,
-           &orv_data, orv_data_p);
-          if (sts != 0)
+          /* Patch "password=" option value into the message. */
+          if (new_password != NULL)
           {
-            fprintf( stderr, "%s: Read table: socket.  sts = %d.\n",
-             PROGRAM_NAME, sts);
+            passwd_patch( new_password, new_password_buf, &patch[ patch_cnt]);
+            patch_cnt++;
           }
-          else if (msg_tmp1_p == NULL)
+
+          /* Patch "name=" option value into the message. */
+          if (new_dev_name != NULL)
           {
-            fprintf( stderr, "%s: Read table: socket.  NULL ptr.\n",
-             PROGRAM_NAME);
-            sts = -1;
+            name_patch( new_dev_name, new_dev_name_buf, &patch[ patch_cnt]);
+            patch_cnt++;
           }
-          else
-          { /* Extract response message length. */
-            msg_len = (unsigned short)msg_tmp1_p[ 2]* 256+
-                      (unsigned short)msg_tmp1_p[ 3];
 
-            if ((debug& DBG_MSI) != 0)
-            {
-              /* Display the response (hex, ASCII). */
-              fprintf( stderr, "   %c  %c  msg_len = %d\n",
-               (msg_tmp1_p)[ 4], (msg_tmp1_p)[ 5], msg_len);
-
-              msg_dump( msg_tmp1_p, msg_len);
-            }
+          /* Patch "countdown=" option value into the message. */
+          if (countdown >= 0)
+          {
+            countdown_patch( countdown, countdown_buf, &patch[ patch_cnt]);
+            patch_cnt++;
           }
+
+          sts = table4_write( &orv_data, orv_data_p, patch, patch_cnt);
+        }
+      }
+    }
+    else if ((match_opr == OPR_TIMERS) && (sched_file_name != NULL))
+    { /* "timers" with "schedule=".  Deploy a schedule (all devices). */
+      if (orv_data_file_name == NULL)
+      { /* Need full inventory (device names). */
+        sts = catalog_devices_live( &orv_data, cache_file_name, expect_n,
+         qry_flg);
+      }
+      if ((sts == 0) && (single != 0))
+      { /* Locate the specific device in the orv_data LL. */
+        sts = orv_data_find_dev( &orv_data, specific_ip, argv[ 2], 1);
+      }
+      if ((sts == 0) && (orv_data_file_name != NULL))
+      { /* DDF data available.  Use Unit discovery to sense. */
+        sts = discover_devices( single, &orv_data);
+      }
+      if (sts == 0)
+      {
+        sts = sched_read( sched_file_name, &orv_data, single);
+      }
+      if (sts == 0)
+      {
+        sched_fail = sched_apply( &orv_data);
+      }
+    }
+    else if (match_opr == OPR_WATCH)
+    { /* "watch".  Report device state changes as they occur. */
+      if (orv_data_file_name == NULL)
+      { /* Need full inventory (device names, states). */
+        sts = catalog_devices_live( &orv_data, cache_file_name, expect_n,
+         qry_flg);
+      }
+      if ((sts == 0) && (single != 0))
+      { /* Locate the specific device in the orv_data LL. */
+        sts = orv_data_find_dev( &orv_data, specific_ip, argv[ 2], 1);
+      }
+      else if (sts == 0)
+      { /* Watch all devices. */
+        orv_data_p = orv_data.next;
+        while (orv_data_p != &orv_data)
+        {
+          orv_data_p->cnt_flg = 1;
+          orv_data_p = orv_data_p->next;
+        }
+      }
+      if ((sts == 0) && (orv_data_file_name != NULL))
+      { /* DDF data available.  Use Unit discovery to sense. */
+        sts = discover_devices( single, &orv_data);
+      }
+      if (sts == 0)
+      { /* Display the starting states, then watch. */
+        fprintf_device_list( stdout,
+         (((orv_data_file_name == NULL) ? 0 : FDL_DDF) |
+         ((brief == 0) ? 0 : FDL_BRIEF) |
+         ((quiet == 0) ? 0 : FDL_QUIET) |
+         ((single == 0) ? 0 : FDL_SINGLE)),
+         &orv_data);
+        fflush( stdout);
+        sts = watch_devices( &orv_data);
+        quiet = 1;                      /* (States already displayed.) */
+      }
+    }
+    else if (match_opr == OPR_DAEMON)
+    { /* "daemon".  Serve (coalesced) control requests. */
+#ifdef USE_DAEMON
+      int warm = 0;
+
+      listen_fds();                     /* Inherited sockets, if any. */
+      if (orv_data_file_name != NULL)
+      { /* DDF data available.  Use Unit discovery to sense.  (A device
+         * which does not respond stays listed, state unknown.)
+         */
+        discover_devices( 0, &orv_data);
+      }
+      else if (snap_file_name != NULL)
+      { /* Warm start (serve now, revalidate later), if a snapshot. */
+        warm = snap_read( snap_file_name, &orv_data);
+      }
+      if ((orv_data_file_name == NULL) && (warm == 0))
+      {
+        sts = catalog_devices_live( &orv_data, cache_file_name, expect_n,
+         qry_flg);
+      }
+      if (sts == 0)
+      {
+        sts = daemon_run( &orv_data, ctl_name, cache_file_name,
+         shm_file_name, http_port, snap_file_name, warm,
+         orv_data_file_name);
+        quiet = 1;
+      }
+#else /* def USE_DAEMON */
+      fprintf( stderr, "%s: Operation \"daemon\" not supported.\n",
+       PROGRAM_NAME);
+      errno = EINVAL;
+      sts = EXIT_FAILURE;
+#endif /* def USE_DAEMON [else] */
+    }
+    else if (match_opr == OPR_RECONCILE)
+    { /* "reconcile".  Bring devices into a desired state. */
+      if (orv_data_file_name == NULL)
+      { /* Need full inventory (device names, states). */
+        sts = catalog_devices_live( &orv_data, cache_file_name, expect_n,
+         qry_flg);
+      }
+      if ((sts == 0) && (single != 0))
+      { /* Locate the specific device in the orv_data LL. */
+        sts = orv_data_find_dev( &orv_data, specific_ip, argv[ 2], 1);
+      }
+      if ((sts == 0) && (orv_data_file_name != NULL))
+      { /* DDF data available.  Use Unit discovery to sense. */
+        sts = discover_devices( single, &orv_data);
+      }
+      if (sts == 0)
+      {
+        sts = want_read( want_file_name, &orv_data, single);
+      }
+      if (sts == 0)
+      {
+        want_fail = want_apply( &orv_data);
+      }
+    }
+    else if (match_opr == OPR_TIMERS)
+    { /* "timers".  List (and add/delete) device timers (table 3). */
+      if (specific_ip == 0)
+      { /* Unknown IP address.  Use broadcast query. */
+        if (orv_data_file_name == NULL)
+        {
+          sts = catalog_devices_live( &orv_data, cache_file_name, expect_n,
+           qry_flg);
         }
+      }
+      else
+      { /* Specific IP address.  Use specific query. */
+        /* Send Global discovery message.  Expect some "qa" response. */
+        rsp = 0;
+        sts = task_retry( RSP_QA, TSK_GLOB_DISC, &rsp, NULL,
+         &orv_data, &orv_data);
+      }
 
+      if (sts == 0)
+      {
+        if (specific_ip == 0)
+        { /* Compare device names (name arg v. real LL data). */
+          orv_data_p = orv_data_find_name( &orv_data, argv[ 2]);
+        }
+        else
+        { /* Compare IP addresses (LL origin v. real LL data). */
+          orv_data_p = orv_data_find_ip_addr( &orv_data);
+        }
+        if (orv_data_p == NULL)
+        {
+          fprintf( stderr,
+           "%s: Device name not matched (loc=%d): >%s<.\n",
+           PROGRAM_NAME, 2, argv[ 2]);
+          errno = ENXIO;
+          sts = EXIT_FAILURE;
+        }
+        else
+        {
+          orv_data_p->cnt_flg = 1;    /* Mark this member for reportng. */
+        }
+      }
+      if (sts == 0)
+      {
+        /* Send Subscribe message.  Expect some "cl" response. */
+        rsp = 0;
+        single = 1;
+        sts = task_retry( RSP_CL, TSK_SUBSCRIBE, &rsp, NULL,
+         &orv_data, orv_data_p);
         if (sts == 0)
         {
-          /* Form a new "tm" message from the saved "rt" response.
-           * Overlay reduced message length and "tm" op-code onto the
-           * saved "rt" response.  Leave the initial "hd" (2 bytes) and
-           * the MAC address and 0x20 padding (12 bytes).
-           */
-          msg_tmp1_p[ 2] = (unsigned short)(msg_len- 3)/ 256;
-          msg_tmp1_p[ 3] = (unsigned short)(msg_len- 3)% 256;
-          memcpy( (msg_tmp1_p+ 4), (cmd_write_table+ 4), 2);
-
-          /* Discard byte 18.  Shift bytes 19:25 (including the table
-           * and version numbers) left one byte (18:24).
-           */
-          memmove( (msg_tmp1_p+ 18), (msg_tmp1_p+ 19), 7);
-
-          /* Discard bytes 26, 27.  Shift the remaining bytes (28:end)
-           * left three bytes (25:(end-3)).
-           */
-          memmove( (msg_tmp1_p+ 25), (msg_tmp1_p+ 28), (msg_len- 28));
-
-          /* Overlay "name=" option value onto the message. */
-          if (new_dev_name != NULL)
-          { /* Option value plus blank fill. */
-            if (new_dev_name_len == 0)
-            { /* No name specified.  Reset to factory: 16* 0xff. */
-              memset( (msg_tmp1_p+ 67), 0xff, DEV_NAME_LEN);
-            }
-            else
-            { /* Normal name. */
-              memcpy( (msg_tmp1_p+ 67), new_dev_name, new_dev_name_len);
-              memset( (msg_tmp1_p+ 67+ new_dev_name_len), 0x20,
-               (DEV_NAME_LEN- new_dev_name_len));
-            }
-          }
+          sts = timers_read( &orv_data, orv_data_p, tmr, &tmr_cnt);
+        }
+      }
 
-          /* Overlay "password=" option value onto the message. */
-          if (new_password != NULL)
-          { /* Option value plus blank fill. */
-            if (new_password_len == 0)
-            { /* No password specified.  Reset to factory: "888888". */
-              new_password = "888888";
-              new_password_len = strlen( new_password);
-            }
-            memcpy( (msg_tmp1_p+ 55), new_password, new_password_len);
-            memset( (msg_tmp1_p+ 55+ new_password_len), 0x20,
-             (PASSWORD_LEN- new_password_len));
-          }
+      if ((sts == 0) && (tmr_del >= 0))
+      { /* Delete an existing timer record. */
+        int i;
 
-          if ((debug& DBG_MSI) != 0)
+        for (i = 0; i < tmr_cnt; i++)
+        {
+          if (tmr[ i].rec_nr == (unsigned int)tmr_del)
           {
-            if (msg_tmp1_p != NULL)
-            {
-              fprintf( stderr, "   %c  %c  msg_len-3 = %d\n",
-               (msg_tmp1_p)[ 4], (msg_tmp1_p)[ 5], (msg_len-3));
-
-              msg_dump( msg_tmp1_p, (msg_len-3));
-            }
+            break;
           }
+        }
+        if (i >= tmr_cnt)
+        {
+          fprintf( stderr, "%s: Timer record not found: %d.\n",
+           PROGRAM_NAME, tmr_del);
+          errno = ENOENT;
+          sts = EXIT_FAILURE;
+        }
+        else
+        {
+          sts = timer_write( &orv_data, orv_data_p, TMA_DELETE, &tmr[ i]);
+        }
+      }
 
-          /* Send Write table: socket message.  Expect some "tm" response. */
-          rsp = 0;
-          sts = task_retry( RSP_TM, TSK_WT_SOCKET, &rsp, &msg_tmp1_p,
-           &orv_data, orv_data_p);
-          if (sts != 0)
-          {
-            fprintf( stderr, "%s: Write table: socket.  sts = %d.\n",
-             PROGRAM_NAME, sts);
-          }
-          else if ((rsp& RSP_TM) == 0)
-          {
-            fprintf( stderr,
-             "%s: No Write table: socket response received.\n",
-             PROGRAM_NAME);
-            errno = ENOMSG;
-            sts = -1;
-          }
-          else
-          { /* Got "tm" response.  Re-query device to update data. */
-            /* Send Read table: socket message.  Expect some "rt" response.
-             * Save the "rt" response to check against requested data.
-             */
-            rsp = 0;
-            sts = task_retry( RSP_RT, TSK_RT_SOCKET, &rsp, &msg_tmp2_p,
-             &orv_data, orv_data_p);
-            if (sts != 0)
-            {
-              fprintf( stderr, "%s: Read table: socket.  sts = %d.\n",
-               PROGRAM_NAME, sts);
-            }
-            else
-            {
-              int cmp;
-
-              /* If used, check requested device name against new "rt" data. */
-              if (new_dev_name != NULL)
-              {
-                cmp = memcmp( (msg_tmp1_p+ 67), (msg_tmp2_p+ 70),
-                 DEV_NAME_LEN);
-
-                if (cmp != 0)
-                {
-                  fprintf( stderr, "%s: Device name NOT set.\n",
-                   PROGRAM_NAME);
-                  errno = EINVAL;
-                  sts = -1;
-                }
-                else if ((debug& DBG_ACT) != 0)
-                {
-                  fprintf( stderr, " New device name: >%*s<\n",
-                   DEV_NAME_LEN, (msg_tmp2_p+ 70));
-                }
-              }
-
-              /* If used, check requested password against new "rt" data. */
-              if (new_password != NULL)
-              {
-                cmp = memcmp( (msg_tmp1_p+ 55), (msg_tmp2_p+ 58),
-                 DEV_NAME_LEN);
-
-                if (cmp != 0)
-                {
-                  fprintf( stderr, "%s: Password NOT set.\n",
-                   PROGRAM_NAME);
-                  errno = EINVAL;
-                  sts = -1;
-                }
-                else if ((debug& DBG_ACT) != 0)
-                {
-                  fprintf( stderr, " New password: >%*s<\n",
-                   PASSWORD_LEN, (msg_tmp2_p+ 58));
-                }
-              }
-            }
-          }
+      if ((sts == 0) && (tmr_add != 0))
+      { /* Add a new timer record (next record number). */
+        int i;
+
+        tmr_new.rec_nr = 1;
+        for (i = 0; i < tmr_cnt; i++)
+        {
+          tmr_new.rec_nr = OMAX( tmr_new.rec_nr, (tmr[ i].rec_nr+ 1));
         }
+        sts = timer_write( &orv_data, orv_data_p, TMA_ADD, &tmr_new);
+      }
+
+      if ((sts == 0) && ((tmr_add != 0) || (tmr_del >= 0)))
+      { /* Re-read the timers to show the result. */
+        sts = timers_read( &orv_data, orv_data_p, tmr, &tmr_cnt);
       }
     }
     else if ((match_opr == OPR_HELP) || (match_opr == OPR_USAGE))
@@ -3778,6 +11784,12 @@ int main( int argc, char **argv)
     }
   }
 
+  /* Update the inventory cache, if a live inventory was taken. */
+  if ((sts == 0) && (cache_file_name != NULL) && (orv_data.seen != 0))
+  {
+    cache_write( cache_file_name, &orv_data);
+  }
+
   if ((debug& DBG_SEL) != 0)
   {
     fprintf( stderr,
@@ -3794,6 +11806,44 @@ int main( int argc, char **argv)
      ((quiet == 0) ? 0 : FDL_QUIET) |                   /*        quiet */
      ((single == 0) ? 0 : FDL_SINGLE)),                 /*        one dev. */
      &orv_data);
+
+    if ((match_opr == OPR_TIMERS) && (quiet == 0))
+    {
+      if (sched_file_name != NULL)
+      {
+        fprintf_sched( stdout, ((brief == 0) ? 0 : FDL_BRIEF), &orv_data);
+      }
+      else
+      {
+        fprintf_timers( stdout, ((brief == 0) ? 0 : FDL_BRIEF), tmr,
+         tmr_cnt);
+      }
+    }
+    if ((match_opr == OPR_RECONCILE) && (quiet == 0))
+    {
+      fprintf_want( stdout, ((brief == 0) ? 0 : FDL_BRIEF), &orv_data);
+    }
+    if (group_fail > 0)
+    {
+      fprintf( stderr, "%s: Group switch failed for %d device(s).\n",
+       PROGRAM_NAME, group_fail);
+      errno = EIO;
+      sts = EXIT_FAILURE;
+    }
+    if (want_fail > 0)
+    {
+      fprintf( stderr, "%s: Reconcile failed for %d device(s).\n",
+       PROGRAM_NAME, want_fail);
+      errno = EIO;
+      sts = EXIT_FAILURE;
+    }
+    if (sched_fail > 0)
+    {
+      fprintf( stderr, "%s: Schedule failed for %d device(s).\n",
+       PROGRAM_NAME, sched_fail);
+      errno = EIO;
+      sts = EXIT_FAILURE;
+    }
   }
 
 #ifndef NO_STATE_IN_EXIT_STATUS
@@ -3810,9 +11860,13 @@ int main( int argc, char **argv)
   }
 #endif /* ndef NO_STATE_IN_EXIT_STATUS */
 
-  /* We could free the orv_data LL, output message, getaddrinfo(), and
-   * various other malloc()'d  storage, but why bother?
-   */
+  if ((debug& DBG_MET) != 0)
+  {
+    fprintf_metrics( stderr);
+  }
+
+  /* Release the arena (orv_data LL, table messages). */
+  arena_release( &arena);
 
   exit( sts);
 }
@@ -0,0 +1,219 @@
+/*
+ * ORVL: Orvibo (S20) Control program.  Shared device state table.
+ *
+ *----------------------------------------------------------------------
+ * Copyright 2017 Steven M. Schweda
+ *
+ * This file is part of ORVL.
+ *
+ * ORVL is subject to the terms of the Perl Foundation Artistic License
+ * 2.0.  A copy of the License is included in the ORVL kit file
+ * "artistic_license_2_0.txt", and on the Web at:
+ * http://www.perlfoundation.org/artistic_license_2_0
+ *----------------------------------------------------------------------
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ *
+ *    An ORVL daemon ("daemon" operation, with "shm=file_spec") keeps
+ * its device inventory in a memory-mapped file, a header followed by
+ * one fixed-size record per device.  Another program may map the file
+ * (read-only), and read the device states with no system call, and no
+ * lock, and no help from the daemon.
+ *
+ *    Each record is protected by its own sequence lock.  The daemon
+ * (the only writer) makes the record's sequence number odd before it
+ * changes the record, and even again after.  A reader copies the
+ * record, and tries again if the sequence number was odd, or changed
+ * during the copy.  A device keeps its record (slot) for the life of
+ * the daemon, so a reader may remember a slot number.  When the daemon
+ * drops a device (removed from its DDF), it clears the device's record
+ * (all-zero MAC address, and state and type -1), and does not reuse the
+ * slot.  The header generation number ("gen") changes after every
+ * daemon update pass.
+ *
+ *    Example (reader):
+ *
+ *      #include "orvl_shm.h"
+ *
+ *      orvl_shm_hdr_t *hdr_p;
+ *      orvl_shm_rec_t rec;
+ *      unsigned int i;
+ *
+ *      hdr_p = orvl_shm_open( "/var/run/orvl_shm");
+ *      if (hdr_p != NULL)
+ *      {
+ *        for (i = 0; i < hdr_p->rec_cnt; i++)
+ *        {
+ *          if (orvl_shm_read( hdr_p, i, &rec) == 0)
+ *          {
+ *            printf( "%-16s %d\n", rec.name, rec.state);
+ *          }
+ *        }
+ *        orvl_shm_close( hdr_p);
+ *      }
+ *
+ *    C macros for customization by the user:
+ *
+ * ORVL_SHM_BARRIER()   Full memory barrier.
+ *                      Default: __sync_synchronize() (GCC, Clang).
+ *
+ * ORVL_SHM_SPIN        Number of times orvl_shm_read() tries to get a
+ *                      consistent copy of a record which is being
+ *                      changed, before it gives up.
+ *                      Default: 1000.
+ *
+ * ORVL_SHM_WRITER      Define ORVL_SHM_WRITER to get only the table
+ *                      layout (no reader functions).  (Used by orvl.c.)
+ */
+
+#ifndef ORVL_SHM_H
+#define ORVL_SHM_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define ORVL_SHM_MAGIC  0x4f52564c      /* "ORVL". */
+#define ORVL_SHM_VERSION        1       /* Table layout version. */
+#define ORVL_SHM_HDR_SIZE      64       /* Header size (bytes) (padded). */
+
+#ifndef ORVL_SHM_BARRIER
+# define ORVL_SHM_BARRIER() __sync_synchronize()
+#endif /* ndef ORVL_SHM_BARRIER */
+
+#ifndef ORVL_SHM_SPIN
+# define ORVL_SHM_SPIN       1000       /* Reader retry limit. */
+#endif /* ndef ORVL_SHM_SPIN */
+
+#define ORVL_SHM_NAME_LEN      17       /* Device name (16), NUL. */
+
+typedef struct orvl_shm_hdr_t                   /* Table header. */
+{
+  unsigned int magic;                           /* ORVL_SHM_MAGIC. */
+  unsigned int version;                         /* ORVL_SHM_VERSION. */
+  unsigned int hdr_size;                        /* Header size (bytes). */
+  unsigned int rec_size;                        /* Record size (bytes). */
+  unsigned int rec_max;                         /* Record capacity. */
+  volatile unsigned int rec_cnt;                /* Records in use. */
+  volatile unsigned int gen;                    /* Update generation. */
+  volatile unsigned int pid;                    /* Daemon PID (0: stopped). */
+} orvl_shm_hdr_t;
+
+typedef struct orvl_shm_rec_t                   /* Device record. */
+{
+  volatile unsigned int seq;                    /* Sequence (odd: busy). */
+  unsigned int ip_addr;                         /* IP address (net order). */
+  unsigned char mac_addr[ 6];                   /* MAC address. */
+  signed char type;                             /* Dev type (icon), -1: unk. */
+  signed char state;                            /* 0: off, 1: on, -1: unk. */
+  char name[ ORVL_SHM_NAME_LEN];                /* Device name. */
+  unsigned char spare[ 3];                      /* (Alignment.) */
+  unsigned int rtt_ms;                          /* Round-trip time (ms). */
+  double seen;                                  /* State seen (s, Epoch). */
+} orvl_shm_rec_t;
+
+#ifndef ORVL_SHM_WRITER
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* orvl_shm_open(): Map a daemon's table file (read-only).
+ *                  NULL (errno set), if the file is not a valid table.
+ */
+
+static orvl_shm_hdr_t *orvl_shm_open( const char *file_spec)
+{
+  int fd;
+  struct stat st;
+  void *map_p;
+  orvl_shm_hdr_t *hdr_p = NULL;
+
+  fd = open( file_spec, O_RDONLY);
+  if (fd >= 0)
+  {
+    if (fstat( fd, &st) != 0)
+    {
+      /* errno set by fstat(). */
+    }
+    else if (st.st_size < ORVL_SHM_HDR_SIZE)
+    {
+      errno = EINVAL;
+    }
+    else
+    {
+      map_p = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+      if (map_p != MAP_FAILED)
+      {
+        hdr_p = map_p;
+        if ((hdr_p->magic != ORVL_SHM_MAGIC) ||
+         (hdr_p->version != ORVL_SHM_VERSION) ||
+         (hdr_p->rec_size < sizeof( orvl_shm_rec_t)) ||
+         ((off_t)hdr_p->hdr_size+
+         (off_t)hdr_p->rec_max* hdr_p->rec_size > st.st_size))
+        { /* Not ours, or not our version. */
+          munmap( map_p, st.st_size);
+          hdr_p = NULL;
+          errno = EINVAL;
+        }
+      }
+    }
+    close( fd);
+  }
+  return hdr_p;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* orvl_shm_read(): Copy a consistent device record (slot ndx).
+ *                  0: ok.  -1: bad slot, or record kept busy (errno
+ *                  EINVAL, EAGAIN).
+ */
+
+static int orvl_shm_read( const orvl_shm_hdr_t *hdr_p, unsigned int ndx,
+ orvl_shm_rec_t *rec_p)
+{
+  int i;
+  unsigned int seq;
+  const volatile orvl_shm_rec_t *src_p;
+
+  if (ndx >= hdr_p->rec_max)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+
+  src_p = (const volatile orvl_shm_rec_t *)((const char *)hdr_p+
+   hdr_p->hdr_size+ (size_t)ndx* hdr_p->rec_size);
+
+  for (i = 0; i < ORVL_SHM_SPIN; i++)
+  {
+    seq = src_p->seq;
+    ORVL_SHM_BARRIER();
+    if ((seq& 1) == 0)
+    { /* Not being changed.  Copy it, and verify that it didn't change. */
+      memcpy( rec_p, (const void *)src_p, sizeof( *rec_p));
+      ORVL_SHM_BARRIER();
+      if (src_p->seq == seq)
+      {
+        return 0;
+      }
+    }
+  }
+  errno = EAGAIN;
+  return -1;
+}
+
+/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* orvl_shm_close(): Unmap a table. */
+
+static void orvl_shm_close( orvl_shm_hdr_t *hdr_p)
+{
+  munmap( (void *)hdr_p,
+   hdr_p->hdr_size+ (size_t)hdr_p->rec_max* hdr_p->rec_size);
+}
+
+#endif /* ndef ORVL_SHM_WRITER */
+
+#endif /* ndef ORVL_SHM_H */